@@ -9,7 +9,7 @@ namespace Halley
 	class AudioBuffersRef;
 	class AudioBufferPool;
 	class ResourceLoader;
-	class VorbisData;
+	class AudioStreamDecoder;
 
 	class IAudioClip
 	{
@@ -21,6 +21,8 @@ namespace Halley
 		virtual size_t getLength() const = 0; // in samples
 		virtual size_t getLoopPoint() const { return 0; } // in samples
 		virtual bool isLoaded() const { return true; }
+		virtual bool isStreaming() const { return false; } // Streaming clips decode on demand, so they can't be read from several threads at once
+		virtual bool prefetch(size_t pos) const { return true; } // Hints that playback is going to jump to pos. Returns whether it can already be read from there
 	};
 
 	class AudioClip final : public AsyncResource, public IAudioClip
@@ -39,9 +41,13 @@ namespace Halley
 		size_t getLength() const override; // in samples
 		size_t getLoopPoint() const override; // in samples
 		bool isLoaded() const override;
+		bool isStreaming() const override;
+		bool prefetch(size_t pos) const override;
 
 		ResourceMemoryUsage getMemoryUsage() const override;
 
+		static void setDefaultReadAhead(size_t samples); // How far ahead streaming clips decode, unless their metadata sets "readAhead"
+
 		static std::shared_ptr<AudioClip> loadResource(ResourceLoader& loader);
 		constexpr static AssetType getAssetType() { return AssetType::AudioClip; }
 		void reload(Resource&& resource) override;
@@ -49,15 +55,10 @@ namespace Halley
 	private:
 		size_t sampleLength = 0;
 		size_t loopPoint = 0;
-		mutable size_t streamPos = 0;
 		uint8_t numChannels = 0;
 		bool streaming = false;
 
-		std::array<std::unique_ptr<VorbisData>, 2> vorbisData;
-
+		std::shared_ptr<AudioStreamDecoder> decoder;
 		mutable Vector<Vector<AudioSample>> samples;
-		mutable Vector<Vector<AudioSample>> buffer;
-
-		VorbisData& getVorbisData(size_t targetPos) const;
 	};
 }
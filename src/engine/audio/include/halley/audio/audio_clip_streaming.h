@@ -19,6 +19,7 @@ namespace Halley
 		size_t getLength() const override;
 		size_t getSamplesLeft() const;
 		bool isLoaded() const override;
+		bool isStreaming() const override;
 
 		void setLatencyTarget(size_t samples);
 		size_t getLatencyTarget() const;
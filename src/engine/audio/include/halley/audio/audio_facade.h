@@ -57,6 +57,8 @@ namespace Halley {
 		void setBusVolume(const String& busName, float volume = 1.0f) override;
 
 	    void setOutputChannels(Vector<AudioChannelData> audioChannelData) override;
+	    void setMaxVoices(size_t maxVoices) override;
+	    void setMixThreads(size_t nThreads) override;
 	    void setListener(AudioListenerData listener) override;
 
 		void onAudioException(std::exception& e);
@@ -78,6 +80,7 @@ namespace Halley {
 		std::atomic<bool> started;
 	    AudioSpec audioSpec;
 		int lastDeviceNumber = 0;
+		size_t mixThreads = 0;
 
 		RingBuffer<Vector<std::function<void()>>> commandQueue;
 		Vector<std::function<void()>> outbox;
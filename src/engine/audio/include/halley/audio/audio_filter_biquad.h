@@ -5,16 +5,42 @@
 namespace Halley {
     class AudioFilterBiquad final : public AudioSource {
     public:
+		struct Coefficients {
+			float a0 = 1;
+			float a1 = 0;
+			float a2 = 0;
+			float b1 = 0;
+			float b2 = 0;
+
+			static Coefficients makeLowPass(float cutoffHz, float q = 0.7071f);
+			static Coefficients makeHighPass(float cutoffHz, float q = 0.7071f);
+		};
+
+		// Filter memory for a single channel
+		struct State {
+			float x1 = 0;
+			float x2 = 0;
+			float y1 = 0;
+			float y2 = 0;
+		};
+
 		AudioFilterBiquad(std::shared_ptr<AudioSource> src);
 		void setParameters(float a0, float a1, float a2, float b1, float b2);
+		void setParameters(const Coefficients& coefficients);
     	
 	    uint8_t getNumberOfChannels() const override;
 	    bool isReady() const override;
+	    bool isStreaming() const override;
 	    bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		size_t getSamplesLeft() const override;
 		void restart() override;
 
+		static void process(AudioSamples samples, const Coefficients& coefficients, State& state);
+
     private:
 		std::shared_ptr<AudioSource> src;
+		Coefficients coefficients;
+		std::array<State, AudioConfig::maxChannels> states;
     };
 }
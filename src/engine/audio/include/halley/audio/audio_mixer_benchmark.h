@@ -0,0 +1,24 @@
+#pragma once
+
+#include "halley/data_structures/vector.h"
+#include "halley/text/halleystring.h"
+
+namespace Halley {
+	// Times every set of mixer kernels (scalar, SSE2, AVX, NEON) this CPU can run on the same buffers
+	class AudioMixerBenchmark {
+	public:
+		struct Timing {
+			String operation;
+			Vector<double> nanosecondsPerSample; // One per kernel set
+		};
+
+		struct Result {
+			Vector<String> kernels; // Scalar first, the one the mixer uses last
+			Vector<Timing> timings;
+
+			String toString() const;
+		};
+
+		static Result run(size_t samplesPerBuffer = 1024, int iterations = 10000);
+	};
+}
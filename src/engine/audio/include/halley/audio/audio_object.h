@@ -25,6 +25,8 @@ namespace Halley {
 		Range<float>& getPitch();
 		Range<float>& getGain();
         void setBus(String bus);
+		int getPriority() const; // Higher priority voices are the last to be virtualised when over the voice limit
+		void setPriority(int priority);
 
 		gsl::span<AudioSubObjectHandle> getSubObjects();
 
@@ -56,6 +58,7 @@ namespace Halley {
 		String bus;
 		Range<float> pitch;
 		Range<float> gain;
+		int priority = 0;
 
 		void generateId();
     };
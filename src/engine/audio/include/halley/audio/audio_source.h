@@ -13,7 +13,9 @@ namespace Halley
 		virtual uint8_t getNumberOfChannels() const = 0;
 		virtual size_t getSamplesLeft() const = 0;
 		virtual bool isReady() const { return true; }
+		virtual bool isStreaming() const { return false; }
 		virtual bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) = 0;
+		virtual bool skipSamples(size_t numSamples) = 0; // Advances playback as getAudioData would, without producing any audio
 		virtual void restart() = 0;
 	};
 }
@@ -60,6 +60,7 @@ namespace Halley {
 		virtual void load(const ConfigNode& node) = 0;
 
 		virtual std::unique_ptr<AudioSource> makeSource(AudioEngine& engine, AudioEmitter& emitter) const = 0;
+		virtual bool isStreaming() const = 0; // Whether sources made from this might end up reading a streaming clip
 		virtual void loadDependencies(Resources& resources) = 0;
 
 		virtual void serialize(Serializer& s) const = 0;
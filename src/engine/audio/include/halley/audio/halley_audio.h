@@ -6,5 +6,6 @@ namespace Halley {}
 #include "audio_clip_streaming.h"
 #include "audio_event.h"
 #include "audio_filter_biquad.h"
+#include "audio_mixer_benchmark.h"
 #include "audio_position.h"
 #include "audio_source.h"
@@ -18,6 +18,8 @@ namespace Halley {
 		bool canCollapseToClip() const override;
 
 		std::unique_ptr<AudioSource> makeSource(AudioEngine& engine, AudioEmitter& emitter) const override;
+
+		bool isStreaming() const override;
 		void loadDependencies(Resources& resources) override;
 
 		void serialize(Serializer& s) const override;
@@ -39,6 +39,8 @@ namespace Halley {
 		AudioSubObjectHandle removeObject(const IAudioObject* object) override;
 
 		std::unique_ptr<AudioSource> makeSource(AudioEngine& engine, AudioEmitter& emitter) const override;
+
+		bool isStreaming() const override;
 		void loadDependencies(Resources& resources) override;
 
 		void serialize(Serializer& s) const override;
@@ -42,6 +42,7 @@ namespace Halley {
 
         AudioSubObjectType getType() const override { return AudioSubObjectType::Sequence; }
 	    std::unique_ptr<AudioSource> makeSource(AudioEngine& engine, AudioEmitter& emitter) const override;
+	    bool isStreaming() const override;
 
         String getName() const override;
 		const String& getRawName() const;
@@ -13,6 +13,7 @@ namespace Halley {
 
         AudioSubObjectType getType() const override { return AudioSubObjectType::Switch; }
 	    std::unique_ptr<AudioSource> makeSource(AudioEngine& engine, AudioEmitter& emitter) const override;
+	    bool isStreaming() const override;
 
         String getName() const override;
         size_t getNumSubObjects() const override;
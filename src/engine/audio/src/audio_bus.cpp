@@ -0,0 +1,128 @@
+#include "audio_bus.h"
+#include "audio_mixer.h"
+#include "halley/core/properties/audio_properties.h"
+
+using namespace Halley;
+
+AudioBus::AudioBus(String name, OptionalLite<uint8_t> parent)
+	: name(std::move(name))
+	, parent(parent)
+{
+}
+
+AudioBus::AudioBus(const AudioBusProperties& properties, OptionalLite<uint8_t> parent)
+	: name(properties.getId())
+	, parent(parent)
+{
+	if (properties.getHighPassCutoff() > 0) {
+		filters.push_back(Filter{ AudioFilterBiquad::Coefficients::makeHighPass(properties.getHighPassCutoff()), {} });
+	}
+	if (properties.getLowPassCutoff() > 0) {
+		filters.push_back(Filter{ AudioFilterBiquad::Coefficients::makeLowPass(properties.getLowPassCutoff()), {} });
+	}
+	compressor.setParameters(properties.getCompressor());
+	if (compressor.isEnabled()) {
+		sidechainName = properties.getCompressor().getSidechain();
+	}
+}
+
+const String& AudioBus::getName() const
+{
+	return name;
+}
+
+OptionalLite<uint8_t> AudioBus::getParent() const
+{
+	return parent;
+}
+
+void AudioBus::setGain(float gain)
+{
+	this->gain = gain;
+}
+
+float AudioBus::getGain() const
+{
+	return gain;
+}
+
+float AudioBus::getPrevGain() const
+{
+	return prevGain;
+}
+
+void AudioBus::setCompositeGain(float gain)
+{
+	compositeGain = gain;
+}
+
+float AudioBus::getCompositeGain() const
+{
+	return compositeGain;
+}
+
+Vector<AudioBus::Send>& AudioBus::getSends()
+{
+	return sends;
+}
+
+const String& AudioBus::getSidechainName() const
+{
+	return sidechainName;
+}
+
+void AudioBus::setSidechain(OptionalLite<uint8_t> bus)
+{
+	sidechain = bus;
+}
+
+OptionalLite<uint8_t> AudioBus::getSidechain() const
+{
+	return sidechain;
+}
+
+gsl::span<AudioBuffer*> AudioBus::getBuffers(AudioBufferPool& pool, size_t nChannels, size_t numSamples)
+{
+	if (!active) {
+		buffers = pool.getBuffers(nChannels, numSamples);
+		AudioMixer::zero(buffers.getSpans(), nChannels);
+		active = true;
+	}
+	return buffers.getBuffers();
+}
+
+bool AudioBus::isActive() const
+{
+	return active;
+}
+
+void AudioBus::process(size_t numSamples, gsl::span<AudioBuffer* const> sidechainBuffers)
+{
+	const auto channels = buffers.getBuffers();
+	for (auto& filter: filters) {
+		for (size_t ch = 0; ch < channels.size(); ++ch) {
+			AudioFilterBiquad::process(AudioSamples(channels[ch]->samples).subspan(0, numSamples), filter.coefficients, filter.states[ch]);
+		}
+	}
+
+	if (compressor.isEnabled()) {
+		compressor.process(channels, sidechain ? sidechainBuffers : gsl::span<AudioBuffer* const>(channels), numSamples);
+	}
+}
+
+void AudioBus::mixTo(gsl::span<AudioBuffer*> dst, size_t numSamples, float gain0, float gain1) const
+{
+	const auto src = buffers.getSpans();
+	for (size_t ch = 0; ch < dst.size(); ++ch) {
+		AudioMixer::mixAudio(src[ch].subspan(0, numSamples), AudioSamples(dst[ch]->samples).subspan(0, numSamples), gain0, gain1);
+	}
+}
+
+void AudioBus::endMix()
+{
+	if (active) {
+		buffers.clear();
+		active = false;
+	}
+	prevGain = gain;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "audio_buffer.h"
+#include "audio_compressor.h"
+#include "audio_filter_biquad.h"
+#include "halley/data_structures/maybe.h"
+#include "halley/text/halleystring.h"
+
+namespace Halley {
+	class AudioBusProperties;
+
+	// A submix: voices and child buses mix into its buffers, which then go through its effects and into its parent (and any sends)
+	class AudioBus {
+	public:
+		struct Send {
+			uint8_t target;
+			float gain;
+		};
+
+		AudioBus(String name, OptionalLite<uint8_t> parent);
+		AudioBus(const AudioBusProperties& properties, OptionalLite<uint8_t> parent);
+
+		const String& getName() const;
+		OptionalLite<uint8_t> getParent() const;
+
+		void setGain(float gain);
+		float getGain() const;
+		float getPrevGain() const;
+		void setCompositeGain(float gain);
+		float getCompositeGain() const;
+
+		Vector<Send>& getSends();
+
+		const String& getSidechainName() const;
+		void setSidechain(OptionalLite<uint8_t> bus);
+		OptionalLite<uint8_t> getSidechain() const;
+
+		// Buffers are only acquired (and zeroed) once something mixes into this bus
+		gsl::span<AudioBuffer*> getBuffers(AudioBufferPool& pool, size_t nChannels, size_t numSamples);
+		bool isActive() const;
+
+		// sidechain is the sidechain bus's buffers, if it has one and anything was mixed into it
+		void process(size_t numSamples, gsl::span<AudioBuffer* const> sidechain);
+		void mixTo(gsl::span<AudioBuffer*> dst, size_t numSamples, float gain0, float gain1) const;
+		void endMix();
+
+	private:
+		struct Filter {
+			AudioFilterBiquad::Coefficients coefficients;
+			std::array<AudioFilterBiquad::State, AudioConfig::maxChannels> states;
+		};
+
+		String name;
+		OptionalLite<uint8_t> parent;
+		float gain = 1;
+		float prevGain = 1;
+		float compositeGain = 1;
+
+		Vector<Filter> filters;
+		AudioCompressor compressor;
+		String sidechainName;
+		OptionalLite<uint8_t> sidechain;
+		Vector<Send> sends;
+
+		AudioBuffersRef buffers;
+		bool active = false;
+	};
+}
@@ -1,6 +1,7 @@
 #include "audio_clip.h"
 
 #include "audio_mixer.h"
+#include "audio_stream_decoder.h"
 #include "halley/resources/resource_data.h"
 #include "vorbis_dec.h"
 #include "halley/resources/metadata.h"
@@ -9,6 +10,10 @@
 
 using namespace Halley;
 
+namespace {
+	std::atomic<size_t> defaultReadAhead { AudioConfig::sampleRate / 2 };
+}
+
 AudioClip::AudioClip(uint8_t numChannels)
 	: numChannels(numChannels)
 {
@@ -17,6 +22,9 @@ AudioClip::AudioClip(uint8_t numChannels)
 
 AudioClip::~AudioClip()
 {
+	if (decoder) {
+		decoder->abort();
+	}
 }
 
 AudioClip& AudioClip::operator=(AudioClip&& other) noexcept
@@ -26,11 +34,13 @@ AudioClip& AudioClip::operator=(AudioClip&& other) noexcept
 	sampleLength = other.sampleLength;
 	numChannels = other.numChannels;
 	loopPoint = other.loopPoint;
-	streamPos = other.streamPos;
 	streaming = other.streaming;
 	
 	samples = std::move(other.samples);
-	vorbisData = std::move(other.vorbisData);
+	if (decoder) {
+		decoder->abort();
+	}
+	decoder = std::move(other.decoder);
 
 	doneLoading();
 
@@ -61,21 +71,17 @@ void AudioClip::loadFromStatic(std::shared_ptr<ResourceDataStatic> data, Metadat
 
 void AudioClip::loadFromStream(std::shared_ptr<ResourceDataStream> data, Metadata metadata)
 {
-	for (size_t i = 0; i < vorbisData.size(); ++i) {
-		vorbisData[i] = std::make_unique<VorbisData>(data, i == 0);
-	}
-
-	uint8_t nChannels = vorbisData[0]->getNumChannels();
-	if (vorbisData[0]->getSampleRate() != AudioConfig::sampleRate) {
+	const auto readAhead = static_cast<size_t>(metadata.getInt("readAhead", static_cast<int>(defaultReadAhead.load())));
+	loopPoint = metadata.getInt("loopPoint", 0);
+	decoder = std::make_shared<AudioStreamDecoder>(std::move(data), readAhead, loopPoint);
+	if (decoder->getSampleRate() != AudioConfig::sampleRate) {
 		throw Exception("Sound clip should be " + toString(AudioConfig::sampleRate) + " Hz.", HalleyExceptions::AudioEngine);
 	}
 	
-	samples.resize(nChannels);
-	numChannels = nChannels;
-	sampleLength = vorbisData[0]->getNumSamples();
-	loopPoint = metadata.getInt("loopPoint", 0);
-	streamPos = 0;
+	numChannels = decoder->getNumChannels();
+	sampleLength = decoder->getNumSamples();
 	streaming = true;
+	decoder->start();
 	doneLoading();
 }
 
@@ -84,52 +90,11 @@ size_t AudioClip::copyChannelData(size_t channelN, size_t pos, size_t len, float
 	Expects(pos + len <= sampleLength);
 
 	if (streaming) {
-		// NB: this assumes the channels will be read in order.
-		if (channelN == 0) {
-			if (buffer.size() != numChannels) {
-				buffer.resize(numChannels);
-			}
-			for (auto& b: buffer) {
-				if (b.size() <= len) {
-					b.resize(len);
-				}
-			}
-
-			auto& vorbis = getVorbisData(pos);
-			vorbis.read(buffer);
-			streamPos = pos + len;
-		}
-
-		AudioMixer::copy(dst, AudioSamples(buffer[channelN]).subspan(0, len), gain0, gain1);
+		return decoder->read(channelN, pos, len, gain0, gain1, dst);
 	} else {
 		AudioMixer::copy(dst, AudioSamples(samples.at(channelN)).subspan(pos, len), gain0, gain1);
+		return len;
 	}
-	return len;
-}
-
-VorbisData& AudioClip::getVorbisData(size_t targetPos) const
-{
-	// This chooses which of the two vorbis data readers to use. This allows two simultaneous reads of the stream without insane seeking, needed for self-overlapping music loops.
-	// It'll basically pick whichever of the two readers is closer to the target position, and seek if needed.
-
-	const size_t nSamples = vorbisData[0]->getNumSamples();
-	size_t bestDist = std::numeric_limits<size_t>::max();
-	size_t bestIdx = 0;
-
-	for (size_t i = 0; i < vorbisData.size(); ++i) {
-		const auto curPos = vorbisData[i]->tell();
-		const auto dist = (targetPos - curPos) % nSamples; // Unsigned subtraction is desirable here, seeking forward is faster than seeking backwards
-		if (dist < bestDist) {
-			bestDist = dist;
-			bestIdx = i;
-		}
-	}
-
-	if (bestDist != 0) {
-		vorbisData[bestIdx]->seek(targetPos);
-	}
-	
-	return *vorbisData[bestIdx];
 }
 
 size_t AudioClip::getLength() const
@@ -154,14 +119,25 @@ bool AudioClip::isLoaded() const
 	return AsyncResource::isLoaded();
 }
 
+bool AudioClip::isStreaming() const
+{
+	return streaming;
+}
+
+bool AudioClip::prefetch(size_t pos) const
+{
+	if (!streaming) {
+		return true;
+	}
+	return isLoaded() && decoder->prefetch(pos);
+}
+
 ResourceMemoryUsage AudioClip::getMemoryUsage() const
 {
 	ResourceMemoryUsage result;
 
-	for (auto& v: vorbisData) {
-		if (v) {
-			result.ramUsage += v->getSizeBytes() + sizeof(VorbisData);
-		}
+	if (decoder) {
+		result.ramUsage += decoder->getSizeBytes() + sizeof(AudioStreamDecoder);
 	}
 	result.ramUsage += samples.size() * sizeof(AudioSample);
 	result.ramUsage += sizeof(*this);
@@ -169,6 +145,11 @@ ResourceMemoryUsage AudioClip::getMemoryUsage() const
 	return result;
 }
 
+void AudioClip::setDefaultReadAhead(size_t samples)
+{
+	defaultReadAhead = samples;
+}
+
 std::shared_ptr<AudioClip> AudioClip::loadResource(ResourceLoader& loader)
 {
 	auto meta = loader.getMeta();
@@ -177,6 +158,7 @@ std::shared_ptr<AudioClip> AudioClip::loadResource(ResourceLoader& loader)
 	auto result = std::make_shared<AudioClip>(uint8_t(channels));
 
 	if (streaming) {
+		result->streaming = true; // Known up front, so anything that might play it can tell before it finishes loading
 		std::shared_ptr<ResourceDataStream> stream = loader.getStream();
 		Concurrent::execute([stream, result, meta] () {
 			result->loadFromStream(stream, meta);
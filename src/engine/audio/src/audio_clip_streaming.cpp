@@ -28,11 +28,7 @@ void AudioClipStreaming::addInterleavedSamples(AudioSamplesConst src)
 
 	for (size_t i = 0; i < numChannels; ++i) {
 		// For each channel, deinterleave
-		auto srcSamples = src.data() + i;
-		for (size_t j = 0; j < nSamples; ++j) {
-			tmp[j] = *srcSamples;
-			srcSamples += numChannels;
-		}
+		AudioMixer::deinterleaveChannel(src, gsl::span<float>(tmp).subspan(0, nSamples), i, numChannels);
 
 		// Add to buffer
 		const auto n = std::min(nSamples, buffers[i].availableToWrite());
@@ -120,6 +116,11 @@ bool AudioClipStreaming::isLoaded() const
 	return ready;
 }
 
+bool AudioClipStreaming::isStreaming() const
+{
+	return true;
+}
+
 void AudioClipStreaming::setLatencyTarget(size_t samples)
 {
 	latencyTarget = samples;
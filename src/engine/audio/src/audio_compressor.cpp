@@ -0,0 +1,51 @@
+#include "audio_compressor.h"
+#include "halley/core/properties/audio_properties.h"
+
+using namespace Halley;
+
+namespace {
+	float getSmoothingCoefficient(float time)
+	{
+		return time > 0.0f ? std::exp(-1.0f / (time * AudioConfig::sampleRate)) : 0.0f;
+	}
+}
+
+void AudioCompressor::setParameters(const AudioCompressorProperties& properties)
+{
+	enabled = properties.isEnabled();
+	threshold = std::pow(10.0f, properties.getThreshold() / 20.0f);
+	slope = 1.0f - 1.0f / std::max(properties.getRatio(), 1.0f);
+	attackCoefficient = getSmoothingCoefficient(properties.getAttack());
+	releaseCoefficient = getSmoothingCoefficient(properties.getRelease());
+}
+
+bool AudioCompressor::isEnabled() const
+{
+	return enabled;
+}
+
+void AudioCompressor::process(gsl::span<AudioBuffer*> buffers, gsl::span<AudioBuffer* const> key, size_t numSamples)
+{
+	const size_t nChannels = buffers.size();
+	for (size_t i = 0; i < numSamples; ++i) {
+		float peak = 0.0f;
+		for (const auto* k: key) {
+			peak = std::max(peak, std::abs(k->samples[i]));
+		}
+
+		const float coefficient = peak > envelope ? attackCoefficient : releaseCoefficient;
+		envelope = peak + coefficient * (envelope - peak);
+
+		if (envelope > threshold) {
+			const float gain = std::pow(threshold / envelope, slope);
+			for (size_t ch = 0; ch < nChannels; ++ch) {
+				buffers[ch]->samples[i] *= gain;
+			}
+		}
+	}
+}
+
+void AudioCompressor::reset()
+{
+	envelope = 0.0f;
+}
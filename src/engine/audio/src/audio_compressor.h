@@ -0,0 +1,25 @@
+#pragma once
+#include "audio_buffer.h"
+
+namespace Halley {
+	class AudioCompressorProperties;
+
+	// Feed-forward peak compressor, linked across all channels
+	class AudioCompressor {
+	public:
+		void setParameters(const AudioCompressorProperties& properties);
+		bool isEnabled() const;
+
+		// The envelope follows the peaks of key (usually buffers themselves, or another bus for ducking); an empty key counts as silence
+		void process(gsl::span<AudioBuffer*> buffers, gsl::span<AudioBuffer* const> key, size_t numSamples);
+		void reset();
+
+	private:
+		float threshold = 1.0f;
+		float slope = 0.0f;
+		float attackCoefficient = 0.0f;
+		float releaseCoefficient = 0.0f;
+		float envelope = 0.0f;
+		bool enabled = false;
+	};
+}
@@ -13,9 +13,18 @@
 #include "halley/support/profiler.h"
 #include "halley/time/stopwatch.h"
 #include "halley/utils/algorithm.h"
+#include "halley/utils/scoped_guard.h"
+#include "halley/concurrency/concurrent.h"
 
 using namespace Halley;
 
+namespace {
+	// Below this many real voices, mixing them in parallel isn't worth the overhead
+	constexpr size_t minParallelVoices = 8;
+}
+
+thread_local AudioEngine::MixContext* AudioEngine::currentMixContext = nullptr;
+
 AudioEngine::AudioEngine()
 	: pool(std::make_unique<AudioBufferPool>())
 	, audioOutputBuffer(4096 * 8)
@@ -29,6 +38,7 @@ AudioEngine::AudioEngine()
 
 AudioEngine::~AudioEngine()
 {
+	mixThreadPool.reset();
 }
 
 void AudioEngine::createEmitter(AudioEmitterId id, AudioPosition position, bool temporary)
@@ -236,11 +246,10 @@ void AudioEngine::queueAudioFloat(gsl::span<const float> data)
 		if (tmpShort.size() < numSamples) {
 			tmpShort.resize(numSamples);
 		}
-		for (size_t i = 0; i < data.size(); ++i) {
-			tmpShort[i] = static_cast<short>(data[i] * 32768.0f);
-		}
+		const auto dst = gsl::span<short>(tmpShort).subspan(0, numSamples);
+		AudioMixer::convertToInt16(data, dst);
 
-		queueAudioBytes(gsl::as_bytes(gsl::span<short>(tmpShort)));
+		queueAudioBytes(gsl::as_bytes(dst));
 	}
 
 	// Int32
@@ -248,11 +257,10 @@ void AudioEngine::queueAudioFloat(gsl::span<const float> data)
 		if (tmpInt.size() < numSamples) {
 			tmpInt.resize(numSamples);
 		}
-		for (size_t i = 0; i < data.size(); ++i) {
-			tmpInt[i] = static_cast<int>(data[i] * 2147483648.0f);
-		}
+		const auto dst = gsl::span<int>(tmpInt).subspan(0, numSamples);
+		AudioMixer::convertToInt32(data, dst);
 
-		queueAudioBytes(gsl::as_bytes(gsl::span<int>(tmpInt)));
+		queueAudioBytes(gsl::as_bytes(dst));
 	}
 }
 
@@ -298,12 +306,12 @@ bool AudioEngine::needsMoreAudio()
 
 Random& AudioEngine::getRNG()
 {
-	return rng;
+	return currentMixContext ? currentMixContext->rng : rng;
 }
 
 AudioBufferPool& AudioEngine::getPool() const
 {
-	return *pool;
+	return currentMixContext ? currentMixContext->pool : *pool;
 }
 
 void AudioEngine::setMasterGain(float gain)
@@ -321,7 +329,8 @@ void AudioEngine::mixVoices(size_t numSamples, size_t nChannels, gsl::span<Audio
 		AudioMixer::zero(buffers[i]->samples);
 	}
 
-	// Mix every emitter
+	// Update every emitter
+	activeVoices.clear();
 	for (auto& e: emitters) {
 		for (auto& v: e.second->getVoices()) {
 			// Start playing if necessary
@@ -329,13 +338,152 @@ void AudioEngine::mixVoices(size_t numSamples, size_t nChannels, gsl::span<Audio
 				v->start();
 			}
 
-			// Mix it in!
 			if (v->isPlaying()) {
-				v->update(channels, e.second->getPosition(), listener, masterGain * getCompositeBusGain(v->getBus()));
-				v->mixTo(numSamples, buffers, *pool);
+				v->update(channels, e.second->getPosition(), listener);
+				activeVoices.push_back(v.get());
+			}
+		}
+	}
+
+	const size_t nRealVoices = virtualiseVoices();
+
+	// Mix voices into their buses, and then buses into the output
+	if (mixThreadPool && nRealVoices >= minParallelVoices) {
+		mixVoicesParallel(numSamples, nChannels);
+	} else {
+		for (auto* v: activeVoices) {
+			v->mixTo(numSamples, buses[v->getBus()].getBuffers(*pool, nChannels, numSamples), *pool);
+		}
+	}
+	mixBuses(numSamples, nChannels, buffers);
+}
+
+void AudioEngine::mixVoicesParallel(size_t numSamples, size_t nChannels)
+{
+	// Streaming sources share their decoder between voices, so those are mixed on this thread afterwards
+	const auto serialStart = std::partition(activeVoices.begin(), activeVoices.end(), [] (const AudioVoice* v) { return !v->isStreaming(); });
+	const size_t nParallel = static_cast<size_t>(serialStart - activeVoices.begin());
+
+	const size_t nChunks = std::min(nParallel, mixQueue->threadCount() + 1);
+	while (mixContexts.size() < nChunks) {
+		mixContexts.push_back(std::make_unique<MixContext>());
+		mixContexts.back()->rng.setSeed(rng.getRawInt());
+	}
+
+	// This thread takes chunks too, so a mix never waits on a worker which hasn't woken up yet, only on chunks already being mixed.
+	// Voices are dealt out round-robin, so that neighbouring expensive voices end up spread out.
+	Concurrent::parallelFor(*mixQueue, nChunks, 1, [&] (size_t chunk, size_t, size_t)
+	{
+		auto& context = *mixContexts[chunk];
+		currentMixContext = &context;
+		auto guard = ScopedGuard([] () { currentMixContext = nullptr; });
+
+		for (size_t i = chunk; i < nParallel; i += nChunks) {
+			auto* v = activeVoices[i];
+			v->mixTo(numSamples, context.getBusBuffers(v->getBus(), nChannels, numSamples), context.pool);
+		}
+	});
+
+	// Reduce into the buses
+	for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+		auto& context = *mixContexts[chunk];
+		for (size_t busId = 0; busId < context.busBuffers.size(); ++busId) {
+			auto& src = context.busBuffers[busId];
+			if (!src.getBuffers().empty()) {
+				const auto srcSpans = src.getSpans();
+				const auto dst = buses[busId].getBuffers(*pool, nChannels, numSamples);
+				for (size_t ch = 0; ch < nChannels; ++ch) {
+					AudioMixer::mixAudio(srcSpans[ch].subspan(0, numSamples), AudioSamples(dst[ch]->samples).subspan(0, numSamples), 1.0f, 1.0f);
+				}
+				src.clear();
 			}
 		}
 	}
+
+	for (auto iter = serialStart; iter != activeVoices.end(); ++iter) {
+		auto* v = *iter;
+		v->mixTo(numSamples, buses[v->getBus()].getBuffers(*pool, nChannels, numSamples), *pool);
+	}
+}
+
+gsl::span<AudioBuffer*> AudioEngine::MixContext::getBusBuffers(uint8_t bus, size_t nChannels, size_t numSamples)
+{
+	if (busBuffers.size() <= bus) {
+		busBuffers.resize(bus + 1);
+	}
+
+	auto& buffers = busBuffers[bus];
+	if (buffers.getBuffers().empty()) {
+		buffers = pool.getBuffers(nChannels, numSamples);
+		AudioMixer::zero(buffers.getSpans(), nChannels);
+	}
+	return buffers.getBuffers();
+}
+
+void AudioEngine::mixBuses(size_t numSamples, size_t nChannels, gsl::span<AudioBuffer*> buffers)
+{
+	for (const auto id: busMixOrder) {
+		auto& bus = buses[id];
+		if (!bus.isActive()) {
+			continue;
+		}
+
+		const auto sidechain = bus.getSidechain();
+		bus.process(numSamples, sidechain && buses[sidechain.value()].isActive() ? buses[sidechain.value()].getBuffers(*pool, nChannels, numSamples) : gsl::span<AudioBuffer*>());
+
+		const float gain0 = bus.getPrevGain();
+		const float gain1 = bus.getGain();
+		for (const auto& send: bus.getSends()) {
+			bus.mixTo(buses[send.target].getBuffers(*pool, nChannels, numSamples), numSamples, gain0 * send.gain, gain1 * send.gain);
+		}
+
+		if (const auto parent = bus.getParent()) {
+			bus.mixTo(buses[parent.value()].getBuffers(*pool, nChannels, numSamples), numSamples, gain0, gain1);
+		} else {
+			bus.mixTo(buffers, numSamples, gain0 * prevMasterGain, gain1 * masterGain);
+		}
+	}
+
+	for (auto& bus: buses) {
+		bus.endMix();
+	}
+	prevMasterGain = masterGain;
+}
+
+size_t AudioEngine::virtualiseVoices()
+{
+	constexpr float minAudibility = 0.0001f;
+	constexpr float realVoiceBias = 1.1f; // Favour voices that are already real, so similar voices don't keep swapping
+
+	const auto getAudibility = [&] (const AudioVoice* v)
+	{
+		return v->getAudibility() * masterGain * getCompositeBusGain(v->getBus());
+	};
+	const auto getScore = [&] (const AudioVoice* v)
+	{
+		return getAudibility(v) * (v->isVirtual() ? 1.0f : realVoiceBias);
+	};
+	const auto isBetter = [&] (const AudioVoice* a, const AudioVoice* b)
+	{
+		if (a->getPriority() != b->getPriority()) {
+			return a->getPriority() > b->getPriority();
+		}
+		return getScore(a) > getScore(b);
+	};
+
+	// Move the voices we want to keep to the front
+	auto realEnd = std::partition(activeVoices.begin(), activeVoices.end(), [&] (const AudioVoice* v) { return getAudibility(v) >= minAudibility; });
+	if (static_cast<size_t>(realEnd - activeVoices.begin()) > maxVoices) {
+		const auto nth = activeVoices.begin() + maxVoices;
+		std::nth_element(activeVoices.begin(), nth, realEnd, isBetter);
+		realEnd = nth;
+	}
+
+	for (auto iter = activeVoices.begin(); iter != activeVoices.end(); ++iter) {
+		(*iter)->setVirtual(iter >= realEnd);
+	}
+
+	return static_cast<size_t>(realEnd - activeVoices.begin());
 }
 
 void AudioEngine::removeFinishedVoices()
@@ -348,7 +496,7 @@ void AudioEngine::removeFinishedVoices()
 
 int AudioEngine::getBusId(const String& busName)
 {
-	const auto iter = std::find_if(buses.begin(), buses.end(), [&] (const BusData& b) { return b.name == busName; });
+	const auto iter = std::find_if(buses.begin(), buses.end(), [&] (const AudioBus& b) { return b.getName() == busName; });
 	if (iter != buses.end()) {
 		return int(iter - buses.begin());
 	} else {
@@ -365,22 +513,114 @@ void AudioEngine::loadBuses()
 	for (const auto& bus: audioProperties->getBuses()) {
 		loadBus(bus, OptionalLite<uint8_t>{});
 	}
+	if (buses.empty()) {
+		buses.emplace_back(String(), OptionalLite<uint8_t>{});
+	}
+
+	for (const auto& bus: audioProperties->getBuses()) {
+		loadBusRouting(bus);
+	}
+	sortBuses();
 }
 
 void AudioEngine::loadBus(const AudioBusProperties& bus, OptionalLite<uint8_t> parent)
 {
 	const auto id = static_cast<uint8_t>(buses.size());
-	buses.emplace_back(BusData{ bus.getId(), 1.0f, 1.0f, parent });
+	buses.emplace_back(bus, parent);
 	for (const auto& b: bus.getChildren()) {
 		loadBus(b, id);
 	}
 }
 
+void AudioEngine::loadBusRouting(const AudioBusProperties& bus)
+{
+	const auto id = getBusId(bus.getId());
+	auto& sends = buses[id].getSends();
+	for (const auto& send: bus.getSends()) {
+		sends.push_back(AudioBus::Send{ static_cast<uint8_t>(getBusId(send.getBus())), send.getGain() });
+	}
+	if (const auto& sidechain = buses[id].getSidechainName(); !sidechain.isEmpty()) {
+		if (const auto sidechainId = getBusId(sidechain); sidechainId != id) {
+			buses[id].setSidechain(static_cast<uint8_t>(sidechainId));
+		}
+	}
+	for (const auto& b: bus.getChildren()) {
+		loadBusRouting(b);
+	}
+}
+
+void AudioEngine::sortBuses()
+{
+	// Each bus must be mixed before anything it outputs to (its parent and its sends), and before any bus it's the sidechain of
+	Vector<int> nInputs;
+	const auto sort = [&] ()
+	{
+		nInputs.clear();
+		nInputs.resize(buses.size(), 0);
+		for (auto& bus: buses) {
+			for (const auto& send: bus.getSends()) {
+				++nInputs[send.target];
+			}
+			if (const auto parent = bus.getParent()) {
+				++nInputs[parent.value()];
+			}
+			if (bus.getSidechain()) {
+				++nInputs[&bus - buses.data()];
+			}
+		}
+
+		busMixOrder.clear();
+		for (size_t i = 0; i < buses.size(); ++i) {
+			if (nInputs[i] == 0) {
+				busMixOrder.push_back(static_cast<uint8_t>(i));
+			}
+		}
+
+		const auto removeInput = [&] (uint8_t target)
+		{
+			if (--nInputs[target] == 0) {
+				busMixOrder.push_back(target);
+			}
+		};
+		for (size_t i = 0; i < busMixOrder.size(); ++i) {
+			auto& bus = buses[busMixOrder[i]];
+			for (const auto& send: bus.getSends()) {
+				removeInput(send.target);
+			}
+			if (const auto parent = bus.getParent()) {
+				removeInput(parent.value());
+			}
+			for (size_t j = 0; j < buses.size(); ++j) {
+				if (buses[j].getSidechain() == busMixOrder[i]) {
+					removeInput(static_cast<uint8_t>(j));
+				}
+			}
+		}
+
+		return busMixOrder.size() == buses.size();
+	};
+
+	if (!sort()) {
+		// Parent links can't form a loop by themselves, so dropping the sends and sidechains from the buses left over resolves it
+		for (size_t i = 0; i < buses.size(); ++i) {
+			if (nInputs[i] > 0 && !buses[i].getSends().empty()) {
+				Logger::logError("Audio bus \"" + buses[i].getName() + "\" is part of a feedback loop, ignoring its sends.");
+				buses[i].getSends().clear();
+			}
+			if (nInputs[i] > 0 && buses[i].getSidechain()) {
+				Logger::logError("Audio bus \"" + buses[i].getName() + "\" is keyed off a bus that depends on it, ignoring its sidechain.");
+				buses[i].setSidechain({});
+			}
+		}
+		sort();
+	}
+}
+
 void AudioEngine::updateBusGains()
 {
 	for (auto& bus: buses) {
-		const float base = bus.parent ? buses.at(bus.parent.value()).compositeGain : 1.0f;
-		bus.compositeGain = bus.gain * base;
+		const float base = bus.getParent() ? buses.at(bus.getParent().value()).getCompositeGain() : 1.0f;
+		bus.setCompositeGain(bus.getGain() * base);
 	}
 }
 
@@ -391,7 +631,24 @@ int64_t AudioEngine::getLastTimeElapsed()
 
 void AudioEngine::setBusGain(const String& name, float gain)
 {
-	buses[getBusId(name)].gain = gain;
+	buses[getBusId(name)].setGain(gain);
+}
+
+void AudioEngine::setMaxVoices(size_t voices)
+{
+	maxVoices = voices;
+}
+
+void AudioEngine::setMixThreads(size_t nThreads, ThreadPool::MakeThread makeThread)
+{
+	// A queue can't be reused once its pool is torn down
+	mixThreadPool.reset();
+	mixQueue.reset();
+
+	if (nThreads > 0) {
+		mixQueue = std::make_unique<ExecutionQueue>();
+		mixThreadPool = std::make_unique<ThreadPool>("AudioMix", *mixQueue, nThreads, std::move(makeThread));
+	}
 }
 
 float AudioEngine::getCompositeBusGain(uint8_t id) const
@@ -399,5 +656,5 @@ float AudioEngine::getCompositeBusGain(uint8_t id) const
 	if (id >= buses.size()) {
 		return 1.0f;
 	}
-	return buses.at(id).compositeGain;
+	return buses.at(id).getCompositeGain();
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "audio_buffer.h"
+#include "audio_bus.h"
 #include <atomic>
 #include <condition_variable>
 #include <map>
@@ -9,6 +10,7 @@
 
 #include "audio_voice.h"
 #include "halley/audio/resampler.h"
+#include "halley/concurrency/executor.h"
 #include "halley/data_structures/hash_map.h"
 #include "halley/data_structures/ring_buffer.h"
 #include "halley/maths/random.h"
@@ -57,19 +59,14 @@ namespace Halley {
 
 		void setMasterGain(float gain);
 		void setBusGain(const String& name, float gain);
+		void setMaxVoices(size_t maxVoices);
+		void setMixThreads(size_t nThreads, ThreadPool::MakeThread makeThread);
     	float getCompositeBusGain(uint8_t bus) const;
 		int getBusId(const String& busName);
 
 		int64_t getLastTimeElapsed();
 
     private:
-		struct BusData {
-			String name;
-			float gain = 1;
-			float compositeGain = 1;
-			OptionalLite<uint8_t> parent;
-		};
-
 		AudioSpec spec;
 		AudioOutputAPI* out = nullptr;
 		const AudioProperties* audioProperties = nullptr;
@@ -86,16 +83,37 @@ namespace Halley {
 		Vector<AudioChannelData> channels;
 		
 		float masterGain = 1.0f;
-		Vector<BusData> buses;
+		float prevMasterGain = 1.0f;
+		Vector<AudioBus> buses;
+		Vector<uint8_t> busMixOrder;
 
 		AudioListenerData listener;
 
+		size_t maxVoices = 64;
+		Vector<AudioVoice*> activeVoices;
+
+		// Each parallel mix chunk gets its own pool, RNG and bus accumulators, so sources running on it never need to lock
+		struct MixContext {
+			AudioBufferPool pool;
+			Random rng;
+			Vector<AudioBuffersRef> busBuffers;
+
+			gsl::span<AudioBuffer*> getBusBuffers(uint8_t bus, size_t nChannels, size_t numSamples);
+		};
+		Vector<std::unique_ptr<MixContext>> mixContexts;
+		std::unique_ptr<ExecutionQueue> mixQueue;
+		std::unique_ptr<ThreadPool> mixThreadPool;
+		static thread_local MixContext* currentMixContext;
+
 		Random rng;
 		std::atomic<int64_t> lastTimeElapsed;
 
     	Vector<uint32_t> finishedSounds;
 
 		void mixVoices(size_t numSamples, size_t channels, gsl::span<AudioBuffer*> buffers);
+		size_t virtualiseVoices();
+		void mixVoicesParallel(size_t numSamples, size_t nChannels);
+		void mixBuses(size_t numSamples, size_t nChannels, gsl::span<AudioBuffer*> buffers);
 	    void removeFinishedVoices();
 		void queueAudioFloat(gsl::span<const float> data);
 		void queueAudioBytes(gsl::span<const gsl::byte> data);
@@ -106,6 +124,8 @@ namespace Halley {
 
     	void loadBuses();
 		void loadBus(const AudioBusProperties& bus, OptionalLite<uint8_t> parent);
+		void loadBusRouting(const AudioBusProperties& bus);
+		void sortBuses();
 		void updateBusGains();
     };
 }
@@ -385,6 +385,7 @@ bool AudioEventActionPlay::run(AudioEngine& engine, AudioEventId uniqueId, Audio
 	auto source = object->makeSource(engine, emitter);
 	auto voice = std::make_unique<AudioVoice>(engine, std::move(source), gain, pitch, delaySamples, engine.getBusId(object->getBus()));
 	voice->setIds(uniqueId, audioObjectId);
+	voice->setPriority(object->getPriority());
 	voice->play(fade);
 	emitter.addVoice(std::move(voice));
 
@@ -11,6 +11,16 @@
 
 using namespace Halley;
 
+namespace {
+	ThreadPool::MakeThread makeMixThread(SystemAPI& system)
+	{
+		return [&system] (String name, std::function<void()> runnable)
+		{
+			return system.createThread(name, ThreadPriority::High, std::move(runnable));
+		};
+	}
+}
+
 AudioFacade::AudioFacade(AudioOutputAPI& o, SystemAPI& system)
 	: output(o)
 	, system(system)
@@ -69,6 +79,9 @@ void AudioFacade::doStartPlayback(int deviceNumber, bool createEngine)
 	if (int(devices.size()) > deviceNumber) {
 		if (createEngine) {
 			engine = std::make_unique<AudioEngine>();
+			if (mixThreads > 0) {
+				engine->setMixThreads(mixThreads, makeMixThread(system));
+			}
 		}
 
 		AudioSpec format;
@@ -334,6 +347,21 @@ void AudioFacade::setOutputChannels(Vector<AudioChannelData> audioChannelData)
 	});
 }
 
+void AudioFacade::setMaxVoices(size_t maxVoices)
+{
+	enqueue([=] () {
+		engine->setMaxVoices(maxVoices);
+	});
+}
+
+void AudioFacade::setMixThreads(size_t nThreads)
+{
+	mixThreads = nThreads;
+	enqueue([=] () {
+		engine->setMixThreads(nThreads, makeMixThread(system));
+	});
+}
+
 void AudioFacade::stopMusic(AudioHandle& handle, float fadeOutTime)
 {
 	handle->stop(AudioFade(fadeOutTime, AudioFadeCurve::Linear));
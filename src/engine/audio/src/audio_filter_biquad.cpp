@@ -1,12 +1,53 @@
 #include "audio_filter_biquad.h"
+#include "halley/utils/utils.h"
 
 using namespace Halley;
 
+namespace {
+	AudioFilterBiquad::Coefficients makeFilter(float cutoffHz, float q, bool highPass)
+	{
+		// From the RBJ audio EQ cookbook
+		const float w0 = 2.0f * pif() * clamp(cutoffHz, 10.0f, AudioConfig::sampleRate * 0.49f) / AudioConfig::sampleRate;
+		const float cosW0 = std::cos(w0);
+		const float alpha = std::sin(w0) / (2.0f * std::max(q, 0.01f));
+		const float norm = 1.0f / (1.0f + alpha);
+
+		AudioFilterBiquad::Coefficients result;
+		const float b = highPass ? (1.0f + cosW0) : (1.0f - cosW0);
+		result.a0 = 0.5f * b * norm;
+		result.a1 = (highPass ? -b : b) * norm;
+		result.a2 = result.a0;
+		result.b1 = -2.0f * cosW0 * norm;
+		result.b2 = (1.0f - alpha) * norm;
+		return result;
+	}
+}
+
+AudioFilterBiquad::Coefficients AudioFilterBiquad::Coefficients::makeLowPass(float cutoffHz, float q)
+{
+	return makeFilter(cutoffHz, q, false);
+}
+
+AudioFilterBiquad::Coefficients AudioFilterBiquad::Coefficients::makeHighPass(float cutoffHz, float q)
+{
+	return makeFilter(cutoffHz, q, true);
+}
+
 AudioFilterBiquad::AudioFilterBiquad(std::shared_ptr<AudioSource> src)
 	: src(std::move(src))
 {
 }
 
+void AudioFilterBiquad::setParameters(float a0, float a1, float a2, float b1, float b2)
+{
+	setParameters(Coefficients{ a0, a1, a2, b1, b2 });
+}
+
+void AudioFilterBiquad::setParameters(const Coefficients& c)
+{
+	coefficients = c;
+}
+
 uint8_t AudioFilterBiquad::getNumberOfChannels() const
 {
 	return src->getNumberOfChannels();
@@ -17,10 +58,24 @@ bool AudioFilterBiquad::isReady() const
 	return src->isReady();
 }
 
+bool AudioFilterBiquad::isStreaming() const
+{
+	return src->isStreaming();
+}
+
 bool AudioFilterBiquad::getAudioData(size_t numSamples, AudioMultiChannelSamples dst)
 {
-	// TODO
-	return src->getAudioData(numSamples, dst);
+	const bool playing = src->getAudioData(numSamples, dst);
+	const auto nChannels = getNumberOfChannels();
+	for (size_t i = 0; i < nChannels; ++i) {
+		process(dst[i].subspan(0, numSamples), coefficients, states[i]);
+	}
+	return playing;
+}
+
+bool AudioFilterBiquad::skipSamples(size_t numSamples)
+{
+	return src->skipSamples(numSamples);
 }
 
 size_t AudioFilterBiquad::getSamplesLeft() const
@@ -31,4 +86,26 @@ size_t AudioFilterBiquad::getSamplesLeft() const
 void AudioFilterBiquad::restart()
 {
 	src->restart();
+	states = {};
+}
+
+void AudioFilterBiquad::process(AudioSamples samples, const Coefficients& c, State& state)
+{
+	// Direct form I
+	float x1 = state.x1;
+	float x2 = state.x2;
+	float y1 = state.y1;
+	float y2 = state.y2;
+
+	for (auto& sample: samples) {
+		const float x0 = sample;
+		const float y0 = c.a0 * x0 + c.a1 * x1 + c.a2 * x2 - c.b1 * y1 - c.b2 * y2;
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = y0;
+		sample = y0;
+	}
+
+	state = { x1, x2, y1, y2 };
 }
@@ -1,10 +1,11 @@
 #include "audio_filter_resample.h"
+#include "audio_engine.h"
 #include "halley/support/debug.h"
 
 using namespace Halley;
 
-AudioFilterResample::AudioFilterResample(std::shared_ptr<AudioSource> source, int fromHz, int toHz, AudioBufferPool& pool)
-	: pool(pool)
+AudioFilterResample::AudioFilterResample(std::shared_ptr<AudioSource> source, int fromHz, int toHz, AudioEngine& engine)
+	: engine(engine)
 	, source(std::move(source))
 	, fromHz(fromHz)
 	, toHz(toHz)
@@ -21,6 +22,11 @@ bool AudioFilterResample::isReady() const
 	return source->isReady();
 }
 
+bool AudioFilterResample::isStreaming() const
+{
+	return source->isStreaming();
+}
+
 bool AudioFilterResample::getAudioData(size_t numSamples, AudioMultiChannelSamples dstBuffers)
 {
 	const size_t nChannels = source->getNumberOfChannels();
@@ -36,12 +42,12 @@ bool AudioFilterResample::getAudioData(size_t numSamples, AudioMultiChannelSampl
 	}
 
 	// Read upstream data
-	auto srcBuffers = pool.getBuffers(nChannels, numSamplesSrc);
+	auto srcBuffers = engine.getPool().getBuffers(nChannels, numSamplesSrc);
 	auto srcs = srcBuffers.getSampleSpans();
 	bool playing = source->getAudioData(numSamplesSrc, srcs);
 
 	// Prepare temporary destination data
-	auto tmpBuffer = pool.getBuffer(numSamples + 32); // Is this +32 needed?
+	auto tmpBuffer = engine.getPool().getBuffer(numSamples + 32); // Is this +32 needed?
 	auto tmp = tmpBuffer.getSpan();
 	
 	// Resample
@@ -70,6 +76,16 @@ bool AudioFilterResample::getAudioData(size_t numSamples, AudioMultiChannelSampl
 	return playing;
 }
 
+bool AudioFilterResample::skipSamples(size_t numSamples)
+{
+	// Leftovers count towards the skipped samples, and the rest is skipped upstream at the source rate
+	const size_t nLeftOver = std::min(leftoverSamples[0].n, numSamples);
+	for (auto& leftOver: leftoverSamples) {
+		leftOver.n = 0;
+	}
+	return source->skipSamples((numSamples - nLeftOver) * fromHz / toHz);
+}
+
 size_t AudioFilterResample::getSamplesLeft() const
 {
 	return source->getSamplesLeft() * toHz / fromHz;
@@ -8,18 +8,20 @@ namespace Halley
 	class AudioFilterResample final : public AudioSource
 	{
 	public:
-		AudioFilterResample(std::shared_ptr<AudioSource> source, int fromHz, int toHz, AudioBufferPool& pool);
+		AudioFilterResample(std::shared_ptr<AudioSource> source, int fromHz, int toHz, AudioEngine& engine);
 
 		uint8_t getNumberOfChannels() const override;
 		bool isReady() const override;
+		bool isStreaming() const override;
 		bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		size_t getSamplesLeft() const override;
 		void restart() override;
 
 		void setFromHz(int fromHz);
 
 	private:
-		AudioBufferPool& pool;
+		AudioEngine& engine;
 		std::shared_ptr<AudioSource> source;
 		Vector<std::unique_ptr<AudioResampler>> resamplers;
 		int fromHz;
@@ -4,32 +4,419 @@
 using namespace Halley;
 
 
-#if (defined(_M_X64) || defined(__x86_64__)) && !defined(__APPLE__)
-#define HAS_SSE
+#if defined(_M_X64) || defined(__x86_64__)
+// SSE2 is part of x86-64, AVX needs to be checked for at runtime
+#define HAS_SSE2
+#if !defined(__APPLE__)
 #define HAS_AVX
 #endif
-
-#if defined(_M_IX86) || defined(__i386)
-// Might not be available, but do we really care about such old processors?
-#define HAS_SSE
 #endif
 
-#ifdef HAS_AVX
-#include <xmmintrin.h>
-#ifdef __clang__
-#include <immintrin.h>
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define HAS_NEON
 #endif
+
+#ifdef HAS_SSE2
+#include <emmintrin.h>
 #ifdef _MSC_VER
 #include <intrin.h>
+#include <immintrin.h>
+#endif
 #endif
+
+#ifdef HAS_NEON
+#include <arm_neon.h>
 #endif
 
-#ifdef HAS_SSE
-#include <xmmintrin.h>
+namespace {
+	constexpr float maxInt32Sample = 2147483520.0f; // Largest float below 2^31
+
+	void mixScalar(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] += src[i] * gain;
+		}
+	}
+
+	void mixRampScalar(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] += src[i] * (gain + gainStep * static_cast<float>(i));
+		}
+	}
+
+	void copyGainScalar(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] = src[i] * gain;
+		}
+	}
+
+	void copyRampScalar(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] = src[i] * (gain + gainStep * static_cast<float>(i));
+		}
+	}
+
+	void interleaveStereoScalar(const AudioSample* left, const AudioSample* right, AudioSample* dst, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[2 * i] = left[i];
+			dst[2 * i + 1] = right[i];
+		}
+	}
+
+	void deinterleaveStereoScalar(const AudioSample* src, AudioSample* dst, size_t n, size_t channel)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] = src[2 * i + channel];
+		}
+	}
+
+	void clampScalar(AudioSample* buffer, size_t n, float limit)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			buffer[i] = std::max(-limit, std::min(buffer[i], limit));
+		}
+	}
+
+	void toInt16Scalar(const AudioSample* src, short* dst, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] = static_cast<short>(std::max(-32768.0f, std::min(src[i] * 32768.0f, 32767.0f)));
+		}
+	}
+
+	void toInt32Scalar(const AudioSample* src, int* dst, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			dst[i] = static_cast<int>(std::max(-2147483648.0f, std::min(src[i] * 2147483648.0f, maxInt32Sample)));
+		}
+	}
+
+	const AudioMixerKernels scalarKernels = {
+		"scalar",
+		&mixScalar,
+		&mixRampScalar,
+		&copyGainScalar,
+		&copyRampScalar,
+		&interleaveStereoScalar,
+		&deinterleaveStereoScalar,
+		&clampScalar,
+		&toInt16Scalar,
+		&toInt32Scalar
+	};
+
+
+#ifdef HAS_SSE2
+	void mixSSE2(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		const __m128 g = _mm_set1_ps(gain);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+			_mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g)));
+		}
+		mixScalar(src + i, dst + i, n - i, gain);
+	}
+
+	void mixRampSSE2(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		const __m128 g0 = _mm_set1_ps(gain);
+		const __m128 step = _mm_set1_ps(gainStep);
+		const __m128 inc = _mm_set1_ps(4.0f);
+		__m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 g = _mm_add_ps(g0, _mm_mul_ps(step, index));
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+			index = _mm_add_ps(index, inc);
+		}
+		mixRampScalar(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void copyGainSSE2(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		const __m128 g = _mm_set1_ps(gain);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+		}
+		copyGainScalar(src + i, dst + i, n - i, gain);
+	}
+
+	void copyRampSSE2(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		const __m128 g0 = _mm_set1_ps(gain);
+		const __m128 step = _mm_set1_ps(gainStep);
+		const __m128 inc = _mm_set1_ps(4.0f);
+		__m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 g = _mm_add_ps(g0, _mm_mul_ps(step, index));
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+			index = _mm_add_ps(index, inc);
+		}
+		copyRampScalar(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void interleaveStereoSSE2(const AudioSample* left, const AudioSample* right, AudioSample* dst, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 l = _mm_loadu_ps(left + i);
+			const __m128 r = _mm_loadu_ps(right + i);
+			_mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+		}
+		interleaveStereoScalar(left + i, right + i, dst + 2 * i, n - i);
+	}
+
+	void deinterleaveStereoSSE2(const AudioSample* src, AudioSample* dst, size_t n, size_t channel)
+	{
+		size_t i = 0;
+		if (channel == 0) {
+			for (; i + 4 <= n; i += 4) {
+				_mm_storeu_ps(dst + i, _mm_shuffle_ps(_mm_loadu_ps(src + 2 * i), _mm_loadu_ps(src + 2 * i + 4), _MM_SHUFFLE(2, 0, 2, 0)));
+			}
+		} else {
+			for (; i + 4 <= n; i += 4) {
+				_mm_storeu_ps(dst + i, _mm_shuffle_ps(_mm_loadu_ps(src + 2 * i), _mm_loadu_ps(src + 2 * i + 4), _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+		}
+		deinterleaveStereoScalar(src + 2 * i, dst + i, n - i, channel);
+	}
+
+	void clampSSE2(AudioSample* buffer, size_t n, float limit)
+	{
+		const __m128 maxVal = _mm_set1_ps(limit);
+		const __m128 minVal = _mm_set1_ps(-limit);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(buffer + i, _mm_max_ps(minVal, _mm_min_ps(_mm_loadu_ps(buffer + i), maxVal)));
+		}
+		clampScalar(buffer + i, n - i, limit);
+	}
+
+	void toInt16SSE2(const AudioSample* src, short* dst, size_t n)
+	{
+		// Conversion truncates like a cast, and packing saturates to the int16 range
+		// Clamped first, since anything beyond the int32 range converts to INT_MIN
+		const __m128 scale = _mm_set1_ps(32768.0f);
+		const __m128 maxVal = _mm_set1_ps(32767.0f);
+		const __m128 minVal = _mm_set1_ps(-32768.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m128i a = _mm_cvttps_epi32(_mm_max_ps(minVal, _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), maxVal)));
+			const __m128i b = _mm_cvttps_epi32(_mm_max_ps(minVal, _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), maxVal)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+		}
+		toInt16Scalar(src + i, dst + i, n - i);
+	}
+
+	void toInt32SSE2(const AudioSample* src, int* dst, size_t n)
+	{
+		const __m128 scale = _mm_set1_ps(2147483648.0f);
+		const __m128 maxVal = _mm_set1_ps(maxInt32Sample);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 v = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), maxVal);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvttps_epi32(v));
+		}
+		toInt32Scalar(src + i, dst + i, n - i);
+	}
+
+	const AudioMixerKernels sse2Kernels = {
+		"sse2",
+		&mixSSE2,
+		&mixRampSSE2,
+		&copyGainSSE2,
+		&copyRampSSE2,
+		&interleaveStereoSSE2,
+		&deinterleaveStereoSSE2,
+		&clampSSE2,
+		&toInt16SSE2,
+		&toInt32SSE2
+	};
+#endif
+
+
+#ifdef HAS_NEON
+	float32x4_t getRampIndex()
+	{
+		const float index[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+		return vld1q_f32(index);
+	}
+
+	void mixNEON(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		const float32x4_t g = vdupq_n_f32(gain);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), g)));
+			vst1q_f32(dst + i + 4, vaddq_f32(vld1q_f32(dst + i + 4), vmulq_f32(vld1q_f32(src + i + 4), g)));
+		}
+		mixScalar(src + i, dst + i, n - i, gain);
+	}
+
+	void mixRampNEON(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		const float32x4_t g0 = vdupq_n_f32(gain);
+		const float32x4_t step = vdupq_n_f32(gainStep);
+		const float32x4_t inc = vdupq_n_f32(4.0f);
+		float32x4_t index = getRampIndex();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const float32x4_t g = vaddq_f32(g0, vmulq_f32(step, index));
+			vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), g)));
+			index = vaddq_f32(index, inc);
+		}
+		mixRampScalar(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void copyGainNEON(const AudioSample* src, AudioSample* dst, size_t n, float gain)
+	{
+		const float32x4_t g = vdupq_n_f32(gain);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+		}
+		copyGainScalar(src + i, dst + i, n - i, gain);
+	}
+
+	void copyRampNEON(const AudioSample* src, AudioSample* dst, size_t n, float gain, float gainStep)
+	{
+		const float32x4_t g0 = vdupq_n_f32(gain);
+		const float32x4_t step = vdupq_n_f32(gainStep);
+		const float32x4_t inc = vdupq_n_f32(4.0f);
+		float32x4_t index = getRampIndex();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const float32x4_t g = vaddq_f32(g0, vmulq_f32(step, index));
+			vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+			index = vaddq_f32(index, inc);
+		}
+		copyRampScalar(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void interleaveStereoNEON(const AudioSample* left, const AudioSample* right, AudioSample* dst, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			float32x4x2_t v;
+			v.val[0] = vld1q_f32(left + i);
+			v.val[1] = vld1q_f32(right + i);
+			vst2q_f32(dst + 2 * i, v);
+		}
+		interleaveStereoScalar(left + i, right + i, dst + 2 * i, n - i);
+	}
+
+	void deinterleaveStereoNEON(const AudioSample* src, AudioSample* dst, size_t n, size_t channel)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const float32x4x2_t v = vld2q_f32(src + 2 * i);
+			vst1q_f32(dst + i, channel == 0 ? v.val[0] : v.val[1]);
+		}
+		deinterleaveStereoScalar(src + 2 * i, dst + i, n - i, channel);
+	}
+
+	void clampNEON(AudioSample* buffer, size_t n, float limit)
+	{
+		const float32x4_t maxVal = vdupq_n_f32(limit);
+		const float32x4_t minVal = vdupq_n_f32(-limit);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			vst1q_f32(buffer + i, vmaxq_f32(minVal, vminq_f32(vld1q_f32(buffer + i), maxVal)));
+		}
+		clampScalar(buffer + i, n - i, limit);
+	}
+
+	void toInt16NEON(const AudioSample* src, short* dst, size_t n)
+	{
+		const float32x4_t scale = vdupq_n_f32(32768.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const int32x4_t a = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src + i), scale));
+			const int32x4_t b = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src + i + 4), scale));
+			vst1q_s16(reinterpret_cast<int16_t*>(dst + i), vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+		}
+		toInt16Scalar(src + i, dst + i, n - i);
+	}
+
+	void toInt32NEON(const AudioSample* src, int* dst, size_t n)
+	{
+		const float32x4_t scale = vdupq_n_f32(2147483648.0f);
+		const float32x4_t maxVal = vdupq_n_f32(maxInt32Sample);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const float32x4_t v = vminq_f32(vmulq_f32(vld1q_f32(src + i), scale), maxVal);
+			vst1q_s32(reinterpret_cast<int32_t*>(dst + i), vcvtq_s32_f32(v));
+		}
+		toInt32Scalar(src + i, dst + i, n - i);
+	}
+
+	const AudioMixerKernels neonKernels = {
+		"neon",
+		&mixNEON,
+		&mixRampNEON,
+		&copyGainNEON,
+		&copyRampNEON,
+		&interleaveStereoNEON,
+		&deinterleaveStereoNEON,
+		&clampNEON,
+		&toInt16NEON,
+		&toInt32NEON
+	};
+#endif
+
+
+#ifdef HAS_AVX
+	bool hasAVX()
+	{
 #ifdef _MSC_VER
-#include <intrin.h>
+		int regs[4];
+		__cpuid(regs, 1);
+		const bool osUsesXSAVE_XRSTORE = (regs[2] & (1 << 27)) != 0;
+		const bool cpuAVXSupport = (regs[2] & (1 << 28)) != 0;
+		return osUsesXSAVE_XRSTORE && cpuAVXSupport && (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6;
+#else
+		// Also checks that the OS saves the AVX registers on context switches
+		return __builtin_cpu_supports("avx");
 #endif
+	}
 #endif
+}
+
+const AudioMixerKernels& Halley::getAudioMixerKernelsScalar()
+{
+	return scalarKernels;
+}
+
+Vector<const AudioMixerKernels*> AudioMixer::getAvailableKernels()
+{
+	Vector<const AudioMixerKernels*> result;
+	result.push_back(&scalarKernels);
+#ifdef HAS_SSE2
+	result.push_back(&sse2Kernels);
+#endif
+#ifdef HAS_NEON
+	result.push_back(&neonKernels);
+#endif
+#ifdef HAS_AVX
+	if (hasAVX()) {
+		result.push_back(&getAudioMixerKernelsAVX());
+	}
+#endif
+	return result;
+}
+
+const AudioMixerKernels& AudioMixer::getKernels()
+{
+	static const AudioMixerKernels& kernels = *getAvailableKernels().back();
+	return kernels;
+}
 
 
 void AudioMixer::mixAudio(AudioSamplesConst src, AudioSamples dst, float gain0, float gain1)
@@ -39,21 +426,13 @@ void AudioMixer::mixAudio(AudioSamplesConst src, AudioSamples dst, float gain0,
 	if (std::abs(gain0 - gain1) < 0.0001f) {
 		// If the gain doesn't change, the code is faster
 		if (std::abs(gain0 - 1.0f) < 0.0001f) {
-			// No need to even multiply
-			for (size_t i = 0; i < nSamples; ++i) {
-				dst[i] += src[i];
-			}
+			getKernels().mix(src.data(), dst.data(), nSamples, 1.0f);
 		} else if (std::abs(gain0) > 0.0001f) {
-			for (size_t i = 0; i < nSamples; ++i) {
-				dst[i] += src[i] * gain0;
-			}
+			getKernels().mix(src.data(), dst.data(), nSamples, gain0);
 		}
-	} else {
+	} else if (nSamples > 0) {
 		// Interpolate the gain
-		const float scale = 1.0f / nSamples;
-		for (size_t i = 0; i < nSamples; ++i) {
-			dst[i] += src[i] * lerp(gain0, gain1, i * scale);
-		}
+		getKernels().mixRamp(src.data(), dst.data(), nSamples, gain0, (gain1 - gain0) / nSamples);
 	}
 }
 
@@ -75,8 +454,13 @@ void AudioMixer::mixAudio(AudioMultiChannelSamples src, AudioMultiChannelSamples
 
 void AudioMixer::interleaveChannels(AudioSamples dstBuffer, gsl::span<AudioBuffer*> srcs)
 {
-	const size_t nChannels = srcs.size();	
+	const size_t nChannels = srcs.size();
 	const size_t nSamples = dstBuffer.size() / nChannels;
+	if (nChannels == 2) {
+		getKernels().interleaveStereo(srcs[0]->samples.data(), srcs[1]->samples.data(), dstBuffer.data(), nSamples);
+		return;
+	}
+
 	for (size_t i = 0; i < nSamples; ++i) {
 		for (size_t j = 0; j < nChannels; ++j) {
 			dstBuffer[i * nChannels + j] = srcs[j]->samples[i];
@@ -84,22 +468,40 @@ void AudioMixer::interleaveChannels(AudioSamples dstBuffer, gsl::span<AudioBuffe
 	}
 }
 
+void AudioMixer::deinterleaveChannel(AudioSamplesConst src, AudioSamples dst, size_t channel, size_t nChannels)
+{
+	const size_t nSamples = std::min(src.size() / nChannels, dst.size());
+	if (nChannels == 2) {
+		getKernels().deinterleaveStereo(src.data(), dst.data(), nSamples, channel);
+		return;
+	}
+
+	for (size_t i = 0; i < nSamples; ++i) {
+		dst[i] = src[i * nChannels + channel];
+	}
+}
+
 void AudioMixer::concatenateChannels(AudioSamples dst, gsl::span<AudioBuffer*> srcs)
 {
-	size_t pos = 0;
+	const size_t nSamples = dst.size() / srcs.size();
 	for (size_t i = 0; i < size_t(srcs.size()); ++i) {
-		const size_t nBytes = srcs[i]->samples.size() * sizeof(AudioSample);
-		memcpy(dst.subspan(pos, nBytes).data(), srcs[i]->samples.data(), nBytes);
-		pos += nBytes;
+		memcpy(dst.data() + i * nSamples, srcs[i]->samples.data(), nSamples * sizeof(AudioSample));
 	}
 }
 
 void AudioMixer::compressRange(AudioSamples buffer)
 {
-	for (size_t i = 0; i < buffer.size(); ++i) {
-		float& sample = buffer[i];
-		sample = std::max(-0.99995f, std::min(sample, 0.99995f));
-	}
+	getKernels().clamp(buffer.data(), buffer.size(), 0.99995f);
+}
+
+void AudioMixer::convertToInt16(AudioSamplesConst src, gsl::span<short> dst)
+{
+	getKernels().toInt16(src.data(), dst.data(), std::min(src.size(), dst.size()));
+}
+
+void AudioMixer::convertToInt32(AudioSamplesConst src, gsl::span<int> dst)
+{
+	getKernels().toInt32(src.data(), dst.data(), std::min(src.size(), dst.size()));
 }
 
 void AudioMixer::zero(AudioSamples dst)
@@ -144,173 +546,10 @@ void AudioMixer::copy(AudioSamples dst, AudioSamples src, float gainStart, float
 		if (std::abs(gainStart - 1.0f) < 0.0001f) {
 			copy(dst, src);
 		} else {
-			for (size_t i = 0; i < nSamples; ++i) {
-				dst[i] = src[i] * gainStart;
-			}
+			getKernels().copyGain(src.data(), dst.data(), nSamples, gainStart);
 		}
-	} else {
+	} else if (nSamples > 0) {
 		// Interpolate the gain
-		const float scale = 1.0f / nSamples;
-		for (size_t i = 0; i < nSamples; ++i) {
-			dst[i] = src[i] * lerp(gainStart, gainEnd, i * scale);
-		}
-	}
-}
-
-#ifdef HAS_SSE
-
-#ifdef _MSC_VER
-
-#include <intrin.h>
-
-#else
-
-#include <cpuid.h>
-static inline unsigned long long _xgetbv(unsigned int index) {
-    unsigned int eax, edx;
-    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
-    return ((unsigned long long)edx << 32) | eax;
-}
-#ifndef _XCR_XFEATURE_ENABLED_MASK
-#define _XCR_XFEATURE_ENABLED_MASK 0
-#endif
-
-#endif
-
-#endif
-
-#ifdef HAS_AVX
-static bool hasAVX()
-{
-#ifndef _MSC_VER
-    // It's crashing on Linux :(
-    return false;
-#endif
-
-#ifdef HAS_SSE
-	int regs[4];
-	int i = 1;
-
-#ifdef _WIN32
-	__cpuid(regs, i);
-#else
-	asm volatile
-	("cpuid" : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-	: "a" (i), "c" (0));
-	// ECX is set to zero for CPUID function 4
-#endif
-
-	bool osUsesXSAVE_XRSTORE = regs[2] & (1 << 27) || false;
-	bool cpuAVXSuport = regs[2] & (1 << 28) || false;
-
-	if (osUsesXSAVE_XRSTORE && cpuAVXSuport) {
-		unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
-		return (xcrFeatureMask & 0x6) == 0x6;
-	} else {
-		return false;
-	}
-#else
-	return false;
-#endif
-}
-#endif
-
-
-/*
-#ifdef HAS_AVX
-void AudioMixerAVX::mixAudio(AudioSamplesConst srcRaw, AudioSamples dstRaw, float gain0, float gain1)
-{
-	gsl::span<const __m256> src(reinterpret_cast<const __m256*>(srcRaw.data()), srcRaw.size() * 2);
-	gsl::span<__m256> dst(reinterpret_cast<__m256*>(dstRaw.data()), dstRaw.size() * 2);
-	const size_t nSamples = size_t(src.size());
-
-	if (gain0 == gain1) {
-		__m256 gain = _mm256_broadcast_ss(&gain0);
-		for (size_t i = 0; i < nSamples; i += 2) {
-			dst[i] = _mm256_add_ps(dst[i], _mm256_mul_ps(src[i], gain));
-			dst[i + 1] = _mm256_add_ps(dst[i + 1], _mm256_mul_ps(src[i + 1], gain));
-		}
-	} else {
-		const float sc = 1.0f / (dst.size() * 16);
-		const float gainDiff = gain1 - gain0;
-		const float eight = 8.0f;
-
-		__m256 gain0p = _mm256_broadcast_ss(&gain0);
-		__m256 gain1p = _mm256_broadcast_ss(&gainDiff);
-		__m256 scale = _mm256_broadcast_ss(&sc);
-		__m256 inc = _mm256_broadcast_ss(&eight);
-		__m256 offset = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
-		for (size_t i = 0; i < nSamples; ++i) {
-			__m256 t = _mm256_mul_ps(offset, scale);
-			__m256 gain = _mm256_add_ps(gain0p, _mm256_mul_ps(gain1p, t));
-			offset = _mm256_add_ps(offset, inc);
-			dst[i] = _mm256_add_ps(dst[i], _mm256_mul_ps(src[i], gain));
-		}
+		getKernels().copyRamp(src.data(), dst.data(), nSamples, gainStart, (gainEnd - gainStart) / nSamples);
 	}
 }
-
-void AudioMixerAVX::compressRange(AudioSamples buffer)
-{
-	gsl::span<__m256> dst(reinterpret_cast<__m256*>(buffer.data()), buffer.size() * 2);
-	const size_t nSamples = size_t(dst.size());
-
-	float val = 0.99995f;
-	__m256 minVal = { -val, -val, -val, -val, -val, -val, -val, -val };
-	__m256 maxVal = { val, val, val, val, val, val, val, val };
-
-	for (size_t i = 0; i < nSamples; ++i) {
-		dst[i] = _mm256_max_ps(minVal, _mm256_min_ps(dst[i], maxVal));
-	}
-}
-
-#endif
-
-#ifdef HAS_SSE
-
-void AudioMixerSSE::mixAudio(AudioSamplesConst srcRaw, AudioSamples dstRaw, float gain0, float gain1)
-{
-	gsl::span<const __m128> src(reinterpret_cast<const __m128*>(srcRaw.data()), srcRaw.size() * 4);
-	gsl::span<__m128> dst(reinterpret_cast<__m128*>(dstRaw.data()), dstRaw.size() * 4);
-	const size_t nSamples = size_t(src.size());
-
-	if (gain0 == gain1) {
-		__m128 gain = { gain0, gain0, gain0, gain0 };
-		for (size_t i = 0; i < nSamples; i += 4) {
-			dst[i] = _mm_add_ps(dst[i], _mm_mul_ps(src[i], gain));
-			dst[i + 1] = _mm_add_ps(dst[i + 1], _mm_mul_ps(src[i + 1], gain));
-			dst[i + 2] = _mm_add_ps(dst[i + 2], _mm_mul_ps(src[i + 2], gain));
-			dst[i + 3] = _mm_add_ps(dst[i + 3], _mm_mul_ps(src[i + 3], gain));
-		}
-	} else {
-		const float sc = 1.0f / (dst.size() * 16);
-		const float gainDiff = gain1 - gain0;
-
-		__m128 gain0p = { gain0, gain0, gain0, gain0 };
-		__m128 gain1p = { gainDiff, gainDiff, gainDiff, gainDiff };
-		__m128 scale = { sc, sc, sc, sc };
-		__m128 offset = { 0.0f, 1.0f, 2.0f, 3.0f };
-		__m128 inc = { 4.0f, 4.0f, 4.0f, 4.0f };
-		for (size_t i = 0; i < nSamples; ++i) {
-			__m128 t = _mm_mul_ps(offset, scale);
-			__m128 gain = _mm_add_ps(_mm_mul_ps(gain1p, t), gain0p);
-			offset = _mm_add_ps(offset, inc);
-			dst[i] = _mm_add_ps(dst[i], _mm_mul_ps(src[i], gain));
-		}
-	}
-}
-
-void AudioMixerSSE::compressRange(AudioSamples buffer)
-{
-	gsl::span<__m128> dst(reinterpret_cast<__m128*>(buffer.data()), buffer.size() * 4);
-	const size_t nSamples = size_t(dst.size());
-
-	float val = 0.99995f;
-	__m128 minVal = {-val, -val, -val, -val};
-	__m128 maxVal = {val, val, val, val};
-
-	for (size_t i = 0; i < nSamples; ++i) {
-		dst[i] = _mm_max_ps(minVal, _mm_min_ps(dst[i], maxVal));
-	}
-}
-#endif
-*/
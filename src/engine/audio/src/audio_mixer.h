@@ -2,6 +2,7 @@
 #include <gsl/span>
 #include "halley/core/api/audio_api.h"
 #include "audio_buffer.h"
+#include "audio_mixer_kernels.h"
 
 namespace Halley
 {
@@ -13,14 +14,21 @@ namespace Halley
 		static void mixAudio(AudioMultiChannelSamples src, AudioMultiChannelSamples dst, float gainStart, float gainEnd);
 
 		static void interleaveChannels(AudioSamples dst, gsl::span<AudioBuffer*> srcs);
+		static void deinterleaveChannel(AudioSamplesConst src, AudioSamples dst, size_t channel, size_t nChannels);
 		static void concatenateChannels(AudioSamples dst, gsl::span<AudioBuffer*> srcs);
 		static void compressRange(AudioSamples buffer);
 
+		static void convertToInt16(AudioSamplesConst src, gsl::span<short> dst);
+		static void convertToInt32(AudioSamplesConst src, gsl::span<int> dst);
+
 		static void zero(AudioSamples dst);
 		static void zero(AudioMultiChannelSamples dst, size_t nChannels = 8);
 		static void zeroRange(AudioMultiChannelSamples dst, size_t nChannels, size_t start, size_t len = std::numeric_limits<size_t>::max());
 		static void copy(AudioMultiChannelSamples dst, AudioMultiChannelSamples src, size_t nChannels = 8);
 		static void copy(AudioSamples dst, AudioSamples src);
 		static void copy(AudioSamples dst, AudioSamples src, float gainStart, float gainEnd);
+
+		static const AudioMixerKernels& getKernels(); // Fastest set this CPU supports, picked on first use
+		static Vector<const AudioMixerKernels*> getAvailableKernels(); // Every set this CPU supports, scalar first
 	};
 }
@@ -0,0 +1,153 @@
+#include "audio_mixer_kernels.h"
+
+// Built with AVX code generation enabled (see CMakeLists.txt), so nothing in here may run before AudioMixer has checked the CPU supports it
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(__APPLE__)
+
+#include <immintrin.h>
+
+using namespace Halley;
+
+namespace {
+	constexpr float maxInt32Sample = 2147483520.0f; // Largest float below 2^31
+
+	void mixAVX(const float* src, float* dst, size_t n, float gain)
+	{
+		const __m256 g = _mm256_set1_ps(gain);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+			_mm256_storeu_ps(dst + i + 8, _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), g)));
+		}
+		getAudioMixerKernelsScalar().mix(src + i, dst + i, n - i, gain);
+	}
+
+	void mixRampAVX(const float* src, float* dst, size_t n, float gain, float gainStep)
+	{
+		const __m256 g0 = _mm256_set1_ps(gain);
+		const __m256 step = _mm256_set1_ps(gainStep);
+		const __m256 inc = _mm256_set1_ps(8.0f);
+		__m256 index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 g = _mm256_add_ps(g0, _mm256_mul_ps(step, index));
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+			index = _mm256_add_ps(index, inc);
+		}
+		getAudioMixerKernelsScalar().mixRamp(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void copyGainAVX(const float* src, float* dst, size_t n, float gain)
+	{
+		const __m256 g = _mm256_set1_ps(gain);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+		}
+		getAudioMixerKernelsScalar().copyGain(src + i, dst + i, n - i, gain);
+	}
+
+	void copyRampAVX(const float* src, float* dst, size_t n, float gain, float gainStep)
+	{
+		const __m256 g0 = _mm256_set1_ps(gain);
+		const __m256 step = _mm256_set1_ps(gainStep);
+		const __m256 inc = _mm256_set1_ps(8.0f);
+		__m256 index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 g = _mm256_add_ps(g0, _mm256_mul_ps(step, index));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+			index = _mm256_add_ps(index, inc);
+		}
+		getAudioMixerKernelsScalar().copyRamp(src + i, dst + i, n - i, gain + gainStep * static_cast<float>(i), gainStep);
+	}
+
+	void interleaveStereoAVX(const float* left, const float* right, float* dst, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			// Unpacking works within each 128-bit lane, so the halves need swapping back into order
+			const __m256 l = _mm256_loadu_ps(left + i);
+			const __m256 r = _mm256_loadu_ps(right + i);
+			const __m256 lo = _mm256_unpacklo_ps(l, r);
+			const __m256 hi = _mm256_unpackhi_ps(l, r);
+			_mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+			_mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+		}
+		getAudioMixerKernelsScalar().interleaveStereo(left + i, right + i, dst + 2 * i, n - i);
+	}
+
+	void deinterleaveStereoAVX(const float* src, float* dst, size_t n, size_t channel)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 a = _mm256_loadu_ps(src + 2 * i);
+			const __m256 b = _mm256_loadu_ps(src + 2 * i + 8);
+			const __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);
+			const __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);
+			if (channel == 0) {
+				_mm256_storeu_ps(dst + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+			} else {
+				_mm256_storeu_ps(dst + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+		}
+		getAudioMixerKernelsScalar().deinterleaveStereo(src + 2 * i, dst + i, n - i, channel);
+	}
+
+	void clampAVX(float* buffer, size_t n, float limit)
+	{
+		const __m256 maxVal = _mm256_set1_ps(limit);
+		const __m256 minVal = _mm256_set1_ps(-limit);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(buffer + i, _mm256_max_ps(minVal, _mm256_min_ps(_mm256_loadu_ps(buffer + i), maxVal)));
+		}
+		getAudioMixerKernelsScalar().clamp(buffer + i, n - i, limit);
+	}
+
+	void toInt16AVX(const float* src, short* dst, size_t n)
+	{
+		// Clamped before converting, since anything beyond the int32 range converts to INT_MIN
+		const __m256 scale = _mm256_set1_ps(32768.0f);
+		const __m256 maxVal = _mm256_set1_ps(32767.0f);
+		const __m256 minVal = _mm256_set1_ps(-32768.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i v = _mm256_cvttps_epi32(_mm256_max_ps(minVal, _mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), maxVal)));
+			const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extractf128_si256(v, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+		}
+		getAudioMixerKernelsScalar().toInt16(src + i, dst + i, n - i);
+	}
+
+	void toInt32AVX(const float* src, int* dst, size_t n)
+	{
+		const __m256 scale = _mm256_set1_ps(2147483648.0f);
+		const __m256 maxVal = _mm256_set1_ps(maxInt32Sample);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 v = _mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), maxVal);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvttps_epi32(v));
+		}
+		getAudioMixerKernelsScalar().toInt32(src + i, dst + i, n - i);
+	}
+
+	const AudioMixerKernels avxKernels = {
+		"avx",
+		&mixAVX,
+		&mixRampAVX,
+		&copyGainAVX,
+		&copyRampAVX,
+		&interleaveStereoAVX,
+		&deinterleaveStereoAVX,
+		&clampAVX,
+		&toInt16AVX,
+		&toInt32AVX
+	};
+}
+
+const AudioMixerKernels& Halley::getAudioMixerKernelsAVX()
+{
+	return avxKernels;
+}
+
+#endif
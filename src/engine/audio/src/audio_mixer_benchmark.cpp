@@ -0,0 +1,81 @@
+#include "audio_mixer_benchmark.h"
+#include "audio_mixer.h"
+#include "halley/text/string_converter.h"
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+using namespace Halley;
+
+String AudioMixerBenchmark::Result::toString() const
+{
+	using Halley::toString;
+
+	String result = "ns/sample";
+	for (const auto& k: kernels) {
+		result += "\t" + k;
+	}
+
+	for (const auto& timing: timings) {
+		result += "\n" + timing.operation;
+		for (const auto& t: timing.nanosecondsPerSample) {
+			result += "\t" + toString(t, 3);
+			if (t > 0 && &t != &timing.nanosecondsPerSample.front()) {
+				result += " (" + toString(timing.nanosecondsPerSample.front() / t, 1) + "x)";
+			}
+		}
+	}
+
+	return result;
+}
+
+AudioMixerBenchmark::Result AudioMixerBenchmark::run(size_t samplesPerBuffer, int iterations)
+{
+	using Clock = std::chrono::steady_clock;
+
+	const size_t n = samplesPerBuffer;
+	Vector<float> left(n);
+	Vector<float> right(n);
+	Vector<float> interleaved(n * 2);
+	Vector<float> dst(n);
+	Vector<short> dstShort(n);
+	for (size_t i = 0; i < n; ++i) {
+		left[i] = std::sin(static_cast<float>(i) * 0.01f) * 1.2f;
+		right[i] = std::cos(static_cast<float>(i) * 0.013f) * 1.2f;
+	}
+
+	using Op = std::function<void(const AudioMixerKernels&)>;
+	const std::pair<const char*, Op> ops[] = {
+		{ "mix", [&](const AudioMixerKernels& k) { k.mix(left.data(), dst.data(), n, 0.5f); } },
+		{ "mix ramp", [&](const AudioMixerKernels& k) { k.mixRamp(left.data(), dst.data(), n, 0.5f, -0.5f / n); } },
+		{ "copy ramp", [&](const AudioMixerKernels& k) { k.copyRamp(left.data(), dst.data(), n, 0.0f, 1.0f / n); } },
+		{ "interleave", [&](const AudioMixerKernels& k) { k.interleaveStereo(left.data(), right.data(), interleaved.data(), n); } },
+		{ "deinterleave", [&](const AudioMixerKernels& k) { k.deinterleaveStereo(interleaved.data(), dst.data(), n, 1); } },
+		{ "clip", [&](const AudioMixerKernels& k) { k.clamp(interleaved.data(), n * 2, 0.99995f); } },
+		{ "to int16", [&](const AudioMixerKernels& k) { k.toInt16(interleaved.data(), dstShort.data(), n); } }
+	};
+
+	Result result;
+	const auto kernels = AudioMixer::getAvailableKernels();
+	for (const auto* k: kernels) {
+		result.kernels.push_back(k->name);
+	}
+
+	for (const auto& [name, op]: ops) {
+		auto& timing = result.timings.emplace_back();
+		timing.operation = name;
+		for (const auto* k: kernels) {
+			for (int i = 0; i < iterations / 10 + 1; ++i) {
+				op(*k); // Warm up
+			}
+			const auto start = Clock::now();
+			for (int i = 0; i < iterations; ++i) {
+				op(*k);
+			}
+			const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			timing.nanosecondsPerSample.push_back(elapsed / (static_cast<double>(iterations) * static_cast<double>(n)));
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+
+// No other includes: this is shared with the translation units built for wider instruction sets, and any inline function pulled in there could be the copy that gets linked for everyone
+namespace Halley
+{
+	// The inner loops behind AudioMixer, one table per instruction set. Ramps apply gain + i * gainStep to sample i.
+	struct AudioMixerKernels
+	{
+		const char* name;
+		void (*mix)(const float* src, float* dst, size_t n, float gain);
+		void (*mixRamp)(const float* src, float* dst, size_t n, float gain, float gainStep);
+		void (*copyGain)(const float* src, float* dst, size_t n, float gain);
+		void (*copyRamp)(const float* src, float* dst, size_t n, float gain, float gainStep);
+		void (*interleaveStereo)(const float* left, const float* right, float* dst, size_t n);
+		void (*deinterleaveStereo)(const float* src, float* dst, size_t n, size_t channel);
+		void (*clamp)(float* buffer, size_t n, float limit);
+		void (*toInt16)(const float* src, short* dst, size_t n);
+		void (*toInt32)(const float* src, int* dst, size_t n);
+	};
+
+	const AudioMixerKernels& getAudioMixerKernelsScalar();
+	const AudioMixerKernels& getAudioMixerKernelsAVX(); // x86-64 only, and only if the CPU supports it
+}
@@ -26,6 +26,7 @@ AudioObject::AudioObject(const ConfigNode& node)
 	bus = node[node.hasKey("bus") ? "bus" : "group"].asString("");
 	pitch = node["pitch"].asFloatRange(Range<float>(1, 1));
 	gain = node["gain"].asFloatRange(Range<float>(1, 1));
+	priority = node["priority"].asInt(0);
 	objects = node["objects"].asVector<AudioSubObjectHandle>({});
 }
 
@@ -42,6 +43,9 @@ ConfigNode AudioObject::toConfigNode() const
 	if (gain != Range<float>(1, 1)) {
 		result["gain"] = gain;
 	}
+	if (priority != 0) {
+		result["priority"] = priority;
+	}
 	result["objects"] = objects;
 	
 	return result;
@@ -113,6 +117,16 @@ void AudioObject::setBus(String bus)
 	this->bus = std::move(bus);
 }
 
+int AudioObject::getPriority() const
+{
+	return priority;
+}
+
+void AudioObject::setPriority(int priority)
+{
+	this->priority = priority;
+}
+
 gsl::span<AudioSubObjectHandle> AudioObject::getSubObjects()
 {
 	return objects;
@@ -132,6 +146,7 @@ void AudioObject::serialize(Serializer& s) const
 	s << bus;
 	s << pitch;
 	s << gain;
+	s << priority;
 	s << objects;
 }
 
@@ -140,6 +155,7 @@ void AudioObject::deserialize(Deserializer& s)
 	s >> bus;
 	s >> pitch;
 	s >> gain;
+	s >> priority;
 	s >> objects;
 }
 
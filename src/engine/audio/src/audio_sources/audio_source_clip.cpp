@@ -27,7 +27,12 @@ uint8_t AudioSourceClip::getNumberOfChannels() const
 
 bool AudioSourceClip::isReady() const
 {
-	return clip->isLoaded();
+	return clip->isLoaded() && clip->prefetch(getStartPos());
+}
+
+bool AudioSourceClip::isStreaming() const
+{
+	return clip->isStreaming();
 }
 
 size_t AudioSourceClip::getSamplesLeft() const
@@ -39,12 +44,38 @@ void AudioSourceClip::restart()
 {
 	streams[0] = {};
 	streams[1] = {};
+	startPos = {};
 	initialised = false;
 }
 
 bool AudioSourceClip::getAudioData(size_t samplesRequested, AudioMultiChannelSamples dstChannels)
 {
-	Expects(isReady());
+	return advance(samplesRequested, dstChannels, true);
+}
+
+bool AudioSourceClip::skipSamples(size_t numSamples)
+{
+	return advance(numSamples, {}, false);
+}
+
+size_t AudioSourceClip::getStartPos() const
+{
+	if (!startPos) {
+		const auto clipLength = clip->getLength();
+		const auto endPos = loopEnd > 0 && static_cast<size_t>(loopEnd) < clipLength ? static_cast<size_t>(loopEnd) : clipLength;
+		startPos = looping && randomiseStart ? engine.getRNG().getSizeT(0, endPos) : 0;
+	}
+	return *startPos;
+}
+
+size_t AudioSourceClip::getLoopTarget() const
+{
+	return std::max(static_cast<size_t>(loopStart), clip->getLoopPoint());
+}
+
+bool AudioSourceClip::advance(size_t samplesRequested, AudioMultiChannelSamples dstChannels, bool render)
+{
+	Expects(clip->isLoaded());
 
 	// Set stream end positions
 	const auto clipLength = clip->getLength();
@@ -58,7 +89,12 @@ bool AudioSourceClip::getAudioData(size_t samplesRequested, AudioMultiChannelSam
 
 		streams[0].active = true;
 		streams[0].loop = looping;
-		streams[0].playbackPos = looping && randomiseStart ? engine.getRNG().getSizeT(0, streams[0].endPos) : 0;
+		streams[0].playbackPos = getStartPos();
+	}
+
+	if (looping) {
+		// Keeps streaming clips decoding wherever this wraps to, which the clip can't know about by itself
+		clip->prefetch(getLoopTarget());
 	}
 
 	const uint8_t nChannels = getNumberOfChannels();
@@ -71,7 +107,7 @@ bool AudioSourceClip::getAudioData(size_t samplesRequested, AudioMultiChannelSam
 					// If we're at the end of playback, either loop, or flag as done
 					if (stream.loop) {
 						const auto prevPos = stream.playbackPos;
-						stream.playbackPos = std::max(static_cast<size_t>(loopStart), clip->getLoopPoint());
+						stream.playbackPos = getLoopTarget();
 						if (stream.playbackPos >= clipLength) {
 							// Loop failed
 							looping = false;
@@ -112,14 +148,14 @@ bool AudioSourceClip::getAudioData(size_t samplesRequested, AudioMultiChannelSam
 
 			for (auto& stream: streams) {
 				if (stream.active) {
-					if (first) {
+					if (render && first) {
 						for (size_t ch = 0; ch < nChannels; ++ch) {
 							auto dst = dstChannels[ch].subspan(samplesWritten, samplesToRead);
 							const size_t nCopied = clip->copyChannelData(ch, stream.playbackPos, samplesToRead, prevGain, gain, dst);
 							assert(nCopied <= samplesRequested * sizeof(AudioSample));
 						}
 						first = false;
-					} else {
+					} else if (render) {
 						auto buffer = engine.getPool().getBuffer(samplesToRead);
 						for (size_t ch = 0; ch < nChannels; ++ch) {
 							auto dst = dstChannels[ch].subspan(samplesWritten, samplesToRead);
@@ -136,7 +172,9 @@ bool AudioSourceClip::getAudioData(size_t samplesRequested, AudioMultiChannelSam
 			samplesWritten += samplesToRead;
 		} else {
 			// Reached end of playback, pad with zeroes
-			AudioMixer::zeroRange(dstChannels, nChannels, samplesWritten, samplesRemaining);
+			if (render) {
+				AudioMixer::zeroRange(dstChannels, nChannels, samplesWritten, samplesRemaining);
+			}
 			samplesWritten += samplesRemaining;
 		}
 	}
@@ -1,4 +1,5 @@
 #pragma once
+#include <optional>
 #include "audio_source.h"
 #include "halley/maths/range.h"
 
@@ -11,7 +12,9 @@ namespace Halley
 
 		uint8_t getNumberOfChannels() const override;
 		bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		bool isReady() const override;
+		bool isStreaming() const override;
 		size_t getSamplesLeft() const override;
 		void restart() override;
 
@@ -33,8 +36,14 @@ namespace Halley
 		float gain = 1;
 		float prevGain = 1;
 
+		mutable std::optional<size_t> startPos;
+
 		bool initialised = false;
 		bool looping = false;
 		bool randomiseStart = false;
+
+		size_t getStartPos() const;
+		size_t getLoopTarget() const;
+		bool advance(size_t samplesRequested, AudioMultiChannelSamples dst, bool render);
 	};
 }
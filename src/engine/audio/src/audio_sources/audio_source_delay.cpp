@@ -35,11 +35,26 @@ bool AudioSourceDelay::getAudioData(size_t numSamples, AudioMultiChannelSamples
 	}
 }
 
+bool AudioSourceDelay::skipSamples(size_t numSamples)
+{
+	const size_t delayNow = std::min(numSamples, curDelay);
+	curDelay -= delayNow;
+	if (numSamples > delayNow) {
+		return src->skipSamples(numSamples - delayNow);
+	}
+	return true;
+}
+
 bool AudioSourceDelay::isReady() const
 {
 	return src->isReady();
 }
 
+bool AudioSourceDelay::isStreaming() const
+{
+	return src->isStreaming();
+}
+
 size_t AudioSourceDelay::getSamplesLeft() const
 {
 	return curDelay + src->getSamplesLeft();
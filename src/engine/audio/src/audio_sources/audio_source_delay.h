@@ -10,7 +10,9 @@ namespace Halley
 
 		uint8_t getNumberOfChannels() const override;
 		bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		bool isReady() const override;
+		bool isStreaming() const override;
 		size_t getSamplesLeft() const override;
         void restart() override;
 		void setInitialDelay(size_t delay);
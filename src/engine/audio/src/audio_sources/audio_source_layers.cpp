@@ -33,12 +33,7 @@ uint8_t AudioSourceLayers::getNumberOfChannels() const
 
 bool AudioSourceLayers::getAudioData(size_t numSamples, AudioMultiChannelSamples dst)
 {
-	if (!initialized) {
-		for (auto& layer : layers) {
-			layer.restart(layerConfig, emitter);
-		}
-		initialized = true;
-	}
+	initialize();
 
 	const auto nChannels = getNumberOfChannels();
 	const float deltaTime = static_cast<float>(numSamples) / static_cast<float>(AudioConfig::sampleRate);
@@ -63,11 +58,33 @@ bool AudioSourceLayers::getAudioData(size_t numSamples, AudioMultiChannelSamples
 	return ok;
 }
 
+bool AudioSourceLayers::skipSamples(size_t numSamples)
+{
+	initialize();
+
+	const float deltaTime = static_cast<float>(numSamples) / static_cast<float>(AudioConfig::sampleRate);
+
+	bool ok = true;
+	for (auto& layer: layers) {
+		layer.update(deltaTime, layerConfig, emitter, fadeConfig);
+		if (layer.playing || layer.synchronised || layer.fader.isFading()) {
+			ok = layer.source->skipSamples(numSamples) && ok;
+		}
+	}
+
+	return ok;
+}
+
 bool AudioSourceLayers::isReady() const
 {
 	return std::all_of(layers.begin(), layers.end(), [=] (const auto& ls) { return ls.source->isReady(); });
 }
 
+bool AudioSourceLayers::isStreaming() const
+{
+	return std::any_of(layers.begin(), layers.end(), [=] (const auto& ls) { return ls.source->isStreaming(); });
+}
+
 size_t AudioSourceLayers::getSamplesLeft() const
 {
 	size_t result = 0;
@@ -85,6 +102,16 @@ void AudioSourceLayers::restart()
 	}
 }
 
+void AudioSourceLayers::initialize()
+{
+	if (!initialized) {
+		for (auto& layer : layers) {
+			layer.restart(layerConfig, emitter);
+		}
+		initialized = true;
+	}
+}
+
 AudioSourceLayers::Layer::Layer(std::unique_ptr<AudioSource> source, size_t idx)
 	: source(std::move(source))
 	, idx(idx)
@@ -15,7 +15,9 @@ namespace Halley
 
 		uint8_t getNumberOfChannels() const override;
 		bool getAudioData(size_t numSamples, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		bool isReady() const override;
+		bool isStreaming() const override;
 		size_t getSamplesLeft() const override;
 		void restart() override;
 
@@ -44,5 +46,7 @@ namespace Halley
 		Vector<Layer> layers;
 		AudioFade fadeConfig;
 		bool initialized = false;
+
+		void initialize();
 	};
 }
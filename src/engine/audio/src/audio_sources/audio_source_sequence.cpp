@@ -19,9 +19,21 @@ uint8_t AudioSourceSequence::getNumberOfChannels() const
 }
 
 bool AudioSourceSequence::getAudioData(size_t samplesRequested, AudioMultiChannelSamples dst)
+{
+	return advance(samplesRequested, dst, true);
+}
+
+bool AudioSourceSequence::skipSamples(size_t numSamples)
+{
+	return advance(numSamples, {}, false);
+}
+
+bool AudioSourceSequence::advance(size_t samplesRequested, AudioMultiChannelSamples dst, bool render)
 {
 	if (playingTracks.empty()) {
-		AudioMixer::zero(dst);
+		if (render) {
+			AudioMixer::zero(dst);
+		}
 		return false;
 	}
 
@@ -37,7 +49,9 @@ bool AudioSourceSequence::getAudioData(size_t samplesRequested, AudioMultiChanne
 
 	while (samplePos < samplesRequested) {
 		if (playingTracks.empty()) {
-			AudioMixer::zeroRange(dst, nChannels, samplePos);
+			if (render) {
+				AudioMixer::zeroRange(dst, nChannels, samplePos);
+			}
 			return false;
 		}
 
@@ -72,7 +86,11 @@ bool AudioSourceSequence::getAudioData(size_t samplesRequested, AudioMultiChanne
 		}
 
 		// Read samples
-		if (nPlaying == 1 && samplePos == 0 && samplesToRead == samplesRequested && playingTracks.front().fader.getCurrentValue() == 1 && playingTracks.front().prevGain == 1) {
+		if (!render) {
+			for (auto& p: playingTracks) {
+				p.source->skipSamples(samplesToRead);
+			}
+		} else if (nPlaying == 1 && samplePos == 0 && samplesToRead == samplesRequested && playingTracks.front().fader.getCurrentValue() == 1 && playingTracks.front().prevGain == 1) {
 			// Passthrough!
 			playingTracks.front().source->getAudioData(samplesRequested, dst);
 		} else {
@@ -126,6 +144,12 @@ bool AudioSourceSequence::isReady() const
 	return true;
 }
 
+bool AudioSourceSequence::isStreaming() const
+{
+	// Checks every segment rather than just the playing ones, since the next track can start in the middle of a mix
+	return sequenceConfig.isStreaming();
+}
+
 size_t AudioSourceSequence::getSamplesLeft() const
 {
 	return std::numeric_limits<size_t>::max();
@@ -12,7 +12,9 @@ namespace Halley
 
 		uint8_t getNumberOfChannels() const override;
 		bool getAudioData(size_t samplesRequested, AudioMultiChannelSamples dst) override;
+		bool skipSamples(size_t numSamples) override;
 		bool isReady() const override;
+		bool isStreaming() const override;
 		size_t getSamplesLeft() const override;
 		void restart() override;
 
@@ -54,6 +56,7 @@ namespace Halley
 
 		Vector<PlayingTrack> playingTracks;
 
+		bool advance(size_t samplesRequested, AudioMultiChannelSamples dst, bool render);
 		void initialize();
 		void nextTrack();
 		void loadCurrentTrack();
@@ -0,0 +1,303 @@
+#include "audio_stream_decoder.h"
+
+#include "audio_mixer.h"
+#include "vorbis_dec.h"
+#include "halley/concurrency/concurrent.h"
+#include "halley/resources/resource_data.h"
+#include "halley/support/logger.h"
+
+using namespace Halley;
+
+namespace {
+	constexpr size_t decodeChunkSize = 4096;
+	constexpr size_t minReadAhead = 2 * decodeChunkSize;
+	constexpr uint64_t idleReads = 4; // A reader that hasn't been read from in this many reads is free to be repurposed
+}
+
+size_t AudioStreamDecoder::Reader::getBufferEnd() const
+{
+	return bufferStart + buffers[0].availableToRead();
+}
+
+bool AudioStreamDecoder::Reader::contains(size_t pos) const
+{
+	return targeted && pos >= bufferStart && pos <= getBufferEnd();
+}
+
+AudioStreamDecoder::AudioStreamDecoder(std::shared_ptr<ResourceDataStream> data, size_t readAhead, size_t loopPoint)
+	: aborted(false)
+	, readAhead(std::max(readAhead, minReadAhead))
+{
+	for (size_t i = 0; i < readers.size(); ++i) {
+		readers[i].vorbis = std::make_unique<VorbisData>(data, i == 0);
+	}
+
+	numChannels = static_cast<uint8_t>(readers[0].vorbis->getNumChannels());
+	numSamples = readers[0].vorbis->getNumSamples();
+	this->loopPoint = std::min(loopPoint, numSamples);
+
+	for (auto& reader: readers) {
+		reader.buffers.resize(numChannels, RingBuffer<AudioSample>(this->readAhead + decodeChunkSize));
+		reader.scratch.resize(numChannels, Vector<AudioSample>(decodeChunkSize));
+		reader.streamEnd = numSamples;
+	}
+}
+
+AudioStreamDecoder::~AudioStreamDecoder() = default;
+
+uint8_t AudioStreamDecoder::getNumChannels() const
+{
+	return numChannels;
+}
+
+int AudioStreamDecoder::getSampleRate() const
+{
+	return readers[0].vorbis->getSampleRate();
+}
+
+size_t AudioStreamDecoder::getNumSamples() const
+{
+	return numSamples;
+}
+
+size_t AudioStreamDecoder::getSizeBytes() const
+{
+	size_t result = 0;
+	for (const auto& reader: readers) {
+		result += reader.vorbis->getSizeBytes() + sizeof(VorbisData);
+		result += numChannels * (readAhead + 2 * decodeChunkSize) * sizeof(AudioSample);
+	}
+	return result;
+}
+
+void AudioStreamDecoder::start()
+{
+	// The first chunks are decoded right here, so the clip doesn't finish loading before there's anything to play
+	std::unique_lock lock(mutex);
+	for (size_t i = 0; i < readers.size(); ++i) {
+		if (i == 0 || loopPoint < numSamples) {
+			readers[i].decoding = true;
+			retarget(readers[i], i == 0 ? 0 : loopPoint);
+		}
+	}
+	lock.unlock();
+
+	for (auto& reader: readers) {
+		if (reader.decoding) {
+			decodeAhead(reader, 1);
+		}
+	}
+
+	lock.lock();
+	for (auto& reader: readers) {
+		if (reader.targeted) {
+			requestDecode(reader);
+		}
+	}
+}
+
+void AudioStreamDecoder::abort()
+{
+	aborted = true;
+}
+
+size_t AudioStreamDecoder::read(size_t channel, size_t pos, size_t len, float gain0, float gain1, AudioSamples dst)
+{
+	std::unique_lock lock(mutex);
+
+	if (channel == 0) {
+		++readCount;
+		auto& reader = getReader(pos);
+		if (reader.getBufferEnd() < pos + len && !hasWorkers()) {
+			// Nobody to decode in the background, so it has to happen here
+			lock.unlock();
+			decodeAhead(reader);
+			lock.lock();
+		}
+		reader.readEnd = pos + len;
+		prepareLoop(reader);
+	}
+
+	// Looked up again for every channel rather than remembered from channel 0, so that nothing carries over between callers
+	const auto* reader = findReader(pos, len);
+	if (!reader || channel >= numChannels) {
+		// Underrun, the decoder will catch up on the next buffers
+		AudioMixer::zero(dst.subspan(0, std::min(len, dst.size())));
+		return len;
+	}
+
+	if (mixScratch.size() < len) {
+		mixScratch.resize(len);
+	}
+	const auto samples = AudioSamples(mixScratch).subspan(0, len);
+	reader->buffers[channel].peek(samples);
+	AudioMixer::copy(dst, samples, gain0, gain1);
+	return len;
+}
+
+bool AudioStreamDecoder::prefetch(size_t pos)
+{
+	if (pos >= numSamples || !hasWorkers()) {
+		// Reading will decode whatever is missing
+		return true;
+	}
+
+	std::unique_lock lock(mutex);
+	for (auto& reader: readers) {
+		if (reader.contains(pos)) {
+			reader.lastUsed = readCount;
+			return reader.getBufferEnd() >= std::min(pos + decodeChunkSize, reader.streamEnd);
+		}
+	}
+
+	// Prefer a reader nobody is using, otherwise whichever was used least recently, same as a read would
+	auto& reader = isIdle(readers[0]) != isIdle(readers[1])
+		? (isIdle(readers[0]) ? readers[0] : readers[1])
+		: (readers[0].lastUsed <= readers[1].lastUsed ? readers[0] : readers[1]);
+	retarget(reader, pos);
+	return false;
+}
+
+AudioStreamDecoder::Reader& AudioStreamDecoder::getReader(size_t pos)
+{
+	// Prefer whichever has to skip the least, so a reader waiting at the loop point doesn't get dragged along with playback
+	Reader* best = nullptr;
+	for (auto& reader: readers) {
+		if (reader.contains(pos) && (!best || reader.bufferStart > best->bufferStart || (reader.bufferStart == best->bufferStart && reader.getBufferEnd() > best->getBufferEnd()))) {
+			best = &reader;
+		}
+	}
+
+	if (!best) {
+		// Nothing decoded around here, so repurpose whichever reader was used least recently
+		best = readers[0].lastUsed <= readers[1].lastUsed ? &readers[0] : &readers[1];
+		retarget(*best, pos);
+	}
+
+	best->lastUsed = readCount;
+	if (pos > best->bufferStart) {
+		for (auto& buffer: best->buffers) {
+			buffer.skip(pos - best->bufferStart);
+		}
+		best->bufferStart = pos;
+	}
+	requestDecode(*best);
+
+	return *best;
+}
+
+AudioStreamDecoder::Reader* AudioStreamDecoder::findReader(size_t pos, size_t len)
+{
+	for (auto& reader: readers) {
+		if (reader.targeted && reader.bufferStart == pos && reader.getBufferEnd() >= pos + len) {
+			return &reader;
+		}
+	}
+	return nullptr;
+}
+
+bool AudioStreamDecoder::isIdle(const Reader& reader) const
+{
+	return !reader.targeted || reader.readEnd >= reader.streamEnd || reader.lastUsed + idleReads < readCount;
+}
+
+void AudioStreamDecoder::prepareLoop(const Reader& reader)
+{
+	if (reader.getBufferEnd() < reader.streamEnd || loopPoint >= numSamples) {
+		return;
+	}
+
+	// This one is about to run out, so get the loop ready on the other reader, unless it's busy
+	auto& other = &reader == &readers[0] ? readers[1] : readers[0];
+	if (!reader.contains(loopPoint) && !other.contains(loopPoint) && isIdle(other)) {
+		retarget(other, loopPoint);
+	}
+}
+
+void AudioStreamDecoder::retarget(Reader& reader, size_t pos)
+{
+	for (auto& buffer: reader.buffers) {
+		buffer.clear();
+	}
+	reader.bufferStart = pos;
+	reader.readEnd = pos;
+	reader.targeted = true;
+	reader.streamEnd = numSamples;
+	reader.needsSeek = true;
+	reader.lastUsed = readCount;
+	++reader.generation;
+
+	requestDecode(reader);
+}
+
+void AudioStreamDecoder::requestDecode(Reader& reader)
+{
+	if (reader.decoding || aborted || !hasWorkers()) {
+		return;
+	}
+	if (reader.buffers[0].availableToRead() >= readAhead || reader.getBufferEnd() >= reader.streamEnd) {
+		return;
+	}
+
+	reader.decoding = true;
+	Concurrent::execute(Executors::getCPUAux(), [self = shared_from_this(), &reader] ()
+	{
+		self->decodeAhead(reader);
+	});
+}
+
+void AudioStreamDecoder::decodeAhead(Reader& reader, size_t maxChunks)
+{
+	std::unique_lock lock(mutex);
+
+	for (size_t chunk = 0; chunk < maxChunks && !aborted; ++chunk) {
+		const size_t start = reader.getBufferEnd();
+		const size_t available = reader.buffers[0].availableToRead();
+		const size_t toDecode = available >= readAhead ? 0 : std::min(decodeChunkSize, std::min(reader.buffers[0].availableToWrite(), reader.streamEnd - start));
+		if (toDecode == 0) {
+			break;
+		}
+
+		const bool seek = reader.needsSeek;
+		const auto generation = reader.generation;
+		reader.needsSeek = false;
+		lock.unlock();
+
+		size_t nRead = 0;
+		try {
+			if (seek) {
+				reader.vorbis->seek(start);
+			}
+			AudioMultiChannelSamples dst;
+			for (size_t i = 0; i < numChannels; ++i) {
+				dst[i] = AudioSamples(reader.scratch[i]).subspan(0, toDecode);
+			}
+			nRead = reader.vorbis->read(dst, numChannels);
+		} catch (const std::exception& e) {
+			Logger::logException(e);
+		}
+
+		lock.lock();
+		if (generation != reader.generation) {
+			// Moved somewhere else while decoding, start over from there
+			continue;
+		}
+
+		if (nRead < toDecode) {
+			// Shorter than advertised, or broken
+			reader.streamEnd = start + nRead;
+		}
+		for (size_t i = 0; i < numChannels; ++i) {
+			reader.buffers[i].write(gsl::span<const AudioSample>(reader.scratch[i]).subspan(0, nRead));
+		}
+
+		prepareLoop(reader);
+	}
+
+	reader.decoding = false;
+}
+
+bool AudioStreamDecoder::hasWorkers()
+{
+	return Executors::getCPUAux().threadCount() > 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#include "halley/core/api/audio_api.h"
+#include "halley/data_structures/ring_buffer.h"
+#include "halley/data_structures/vector.h"
+
+namespace Halley
+{
+	class ResourceDataStream;
+	class VorbisData;
+
+	// Decodes a streaming clip ahead of playback on the CPUAux executor, so the audio thread only ever copies PCM that's ready.
+	// There are two readers, so that two positions (e.g. both ends of a self-overlapping music loop) can play without seeking back and forth.
+	class AudioStreamDecoder : public std::enable_shared_from_this<AudioStreamDecoder>
+	{
+	public:
+		AudioStreamDecoder(std::shared_ptr<ResourceDataStream> data, size_t readAhead, size_t loopPoint);
+		~AudioStreamDecoder();
+
+		uint8_t getNumChannels() const;
+		int getSampleRate() const;
+		size_t getNumSamples() const;
+		size_t getSizeBytes() const;
+
+		void start(); // Decodes the first chunk at the beginning and at the loop point, then carries on in the background
+		void abort();
+
+		// Channels are expected to be read in order for each position. Samples that aren't decoded yet come out as silence
+		size_t read(size_t channel, size_t pos, size_t len, float gain0, float gain1, AudioSamples dst);
+		bool prefetch(size_t pos); // Gets a reader decoding at pos if none is there yet, returns whether it's ready to be read
+
+	private:
+		struct Reader
+		{
+			std::unique_ptr<VorbisData> vorbis; // Only touched by whoever is decoding
+			Vector<RingBuffer<AudioSample>> buffers;
+			Vector<Vector<AudioSample>> scratch;
+			size_t bufferStart = 0; // Sample position of the first buffered sample
+			size_t streamEnd = 0;
+			uint64_t generation = 0;
+			uint64_t lastUsed = 0;
+			size_t readEnd = 0; // Where the last read from this reader stopped
+			bool targeted = false; // Untouched readers aren't at any position, not even 0
+			bool needsSeek = true;
+			bool decoding = false;
+
+			size_t getBufferEnd() const;
+			bool contains(size_t pos) const;
+		};
+
+		std::mutex mutex;
+		std::array<Reader, 2> readers;
+		std::atomic<bool> aborted;
+		Vector<AudioSample> mixScratch;
+
+		size_t numSamples = 0;
+		size_t readAhead = 0;
+		size_t loopPoint = 0;
+		uint8_t numChannels = 0;
+		uint64_t readCount = 0;
+
+		Reader& getReader(size_t pos);
+		Reader* findReader(size_t pos, size_t len);
+		bool isIdle(const Reader& reader) const;
+		void prepareLoop(const Reader& reader);
+		void retarget(Reader& reader, size_t pos);
+		void requestDecode(Reader& reader);
+		void decodeAhead(Reader& reader, size_t maxChunks = std::numeric_limits<size_t>::max());
+		static bool hasWorkers();
+	};
+}
@@ -16,6 +16,8 @@ AudioVoice::AudioVoice(AudioEngine& engine, std::shared_ptr<AudioSource> src, fl
 	, paused(false)
 	, done(false)
 	, isFirstUpdate(true)
+	, virtualised(false)
+	, fadingToVirtual(false)
 	, baseGain(gain)
 	, userGain(1.0f)
 	, delaySamples(delaySamples)
@@ -114,6 +116,11 @@ bool AudioVoice::isDone() const
 	return done;
 }
 
+bool AudioVoice::isStreaming() const
+{
+	return source->isStreaming();
+}
+
 
 uint8_t AudioVoice::getBus() const
 {
@@ -148,18 +155,56 @@ void AudioVoice::setPitch(float pitch)
 		if (resample) {
 			resample->setFromHz(freq);
 		} else {
-			resample = std::make_shared<AudioFilterResample>(source, freq, AudioConfig::sampleRate, engine.getPool());
+			resample = std::make_shared<AudioFilterResample>(source, freq, AudioConfig::sampleRate, engine);
 			source = resample;
 		}
 	}
 }
 
+void AudioVoice::setPriority(int priority)
+{
+	this->priority = priority;
+}
+
+int AudioVoice::getPriority() const
+{
+	return priority;
+}
+
+float AudioVoice::getAudibility() const
+{
+	return audibility;
+}
+
+void AudioVoice::setVirtual(bool virt)
+{
+	if (virt == virtualised) {
+		return;
+	}
+
+	virtualised = virt;
+	if (virtualised) {
+		// Mix one last buffer, ramping down to silence
+		channelMix.fill(0);
+		fadingToVirtual = true;
+	} else {
+		// Ramp up from silence on the first buffer back
+		prevChannelMix.fill(0);
+		fadingToVirtual = false;
+	}
+}
+
+bool AudioVoice::isVirtual() const
+{
+	return virtualised;
+}
+
 size_t AudioVoice::getNumberOfChannels() const
 {
 	return nChannels;
 }
 
-void AudioVoice::update(gsl::span<const AudioChannelData> channels, const AudioPosition& sourcePos, const AudioListenerData& listener, float busGain)
+void AudioVoice::update(gsl::span<const AudioChannelData> channels, const AudioPosition& sourcePos, const AudioListenerData& listener)
 {
 	Expects(playing);
 
@@ -174,13 +219,19 @@ void AudioVoice::update(gsl::span<const AudioChannelData> channels, const AudioP
 	const float pauseGain = paused ? 0.0f : 1.0f;
 	
 	prevChannelMix = channelMix;
-	sourcePos.setMix(nChannels, channels, channelMix, baseGain * userGain * dynamicGain * busGain * pauseGain, listener);
+	sourcePos.setMix(nChannels, channels, channelMix, baseGain * userGain * dynamicGain * pauseGain, listener);
 	
 	if (isFirstUpdate) {
 		prevChannelMix = channelMix;
 		isFirstUpdate = false;
 	}
 
+	audibility = 0;
+	const size_t nMixes = std::min(nChannels * channels.size(), channelMix.size());
+	for (size_t i = 0; i < nMixes; ++i) {
+		audibility += channelMix[i];
+	}
+
 	elapsedTime = 0;
 }
 
@@ -205,6 +256,12 @@ void AudioVoice::mixTo(size_t numSamplesRequested, gsl::span<AudioBuffer*> dst,
 		return;
 	}
 
+	if (virtualised && !fadingToVirtual) {
+		skip(numSamplesRequested);
+		return;
+	}
+	fadingToVirtual = false;
+
 	// Figure out the total mix in the previous update, and now. If it's zero, then there's nothing to listen here.
 	const size_t nSrcChannels = getNumberOfChannels();
 	const auto nDstChannels = size_t(dst.size());
@@ -216,14 +273,8 @@ void AudioVoice::mixTo(size_t numSamplesRequested, gsl::span<AudioBuffer*> dst,
 	}
 
 	// Check delay
-	size_t startDstSample = 0;
-	size_t numSamples = numSamplesRequested;
-	if (delaySamples > 0) {
-		const size_t delayNow = std::min(static_cast<size_t>(delaySamples), numSamples);
-		delaySamples -= static_cast<uint32_t>(delayNow);
-		startDstSample += delayNow;
-		numSamples -= delayNow;
-	}
+	const size_t startDstSample = consumeDelay(numSamplesRequested);
+	const size_t numSamples = numSamplesRequested - startDstSample;
 
 	if (numSamples > 0) {
 		// Read data from source
@@ -265,6 +316,26 @@ void AudioVoice::mixTo(size_t numSamplesRequested, gsl::span<AudioBuffer*> dst,
 	}
 }
 
+size_t AudioVoice::consumeDelay(size_t numSamples)
+{
+	const size_t delayNow = std::min(static_cast<size_t>(delaySamples), numSamples);
+	delaySamples -= static_cast<uint32_t>(delayNow);
+	return delayNow;
+}
+
+void AudioVoice::skip(size_t numSamplesRequested)
+{
+	const size_t numSamples = numSamplesRequested - consumeDelay(numSamplesRequested);
+	if (numSamples > 0) {
+		const bool isPlaying = source->skipSamples(numSamples);
+		advancePlayback(numSamples);
+
+		if (!isPlaying) {
+			stop(AudioFade());
+		}
+	}
+}
+
 void AudioVoice::advancePlayback(size_t samples)
 {
 	if (!paused) {
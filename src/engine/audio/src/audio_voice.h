@@ -27,6 +27,7 @@ namespace Halley {
 		bool isPlaying() const;
 		bool isReady() const;
 		bool isDone() const;
+		bool isStreaming() const;
 
 		void setBaseGain(float gain);
 		float getBaseGain() const;
@@ -35,9 +36,17 @@ namespace Halley {
 
 		void setPitch(float pitch);
 
+		void setPriority(int priority);
+		int getPriority() const;
+		float getAudibility() const;
+
+		// Virtual voices keep track of their playback position, but don't decode or mix any audio
+		void setVirtual(bool virt);
+		bool isVirtual() const;
+
 		size_t getNumberOfChannels() const;
 
-		void update(gsl::span<const AudioChannelData> channels, const AudioPosition& sourcePos, const AudioListenerData& listener, float busGain);
+		void update(gsl::span<const AudioChannelData> channels, const AudioPosition& sourcePos, const AudioListenerData& listener);
 		void mixTo(size_t numSamples, gsl::span<AudioBuffer*> dst, AudioBufferPool& pool);
 		
 		void setIds(AudioEventId eventId, AudioObjectId audioObjectId = 0);
@@ -63,10 +72,14 @@ namespace Halley {
 		bool paused : 1;
 		bool done : 1;
 		bool isFirstUpdate : 1;
+		bool virtualised : 1;
+		bool fadingToVirtual : 1;
     	float baseGain = 1.0f;
 		float userGain = 1.0f;
 		float elapsedTime = 0.0f;
 		uint32_t delaySamples = 0;
+		int priority = 0;
+		float audibility = 0.0f;
 
 		AudioFader fader;
 		FadeEndBehaviour fadeEnd = FadeEndBehaviour::None;
@@ -77,6 +90,8 @@ namespace Halley {
 		std::array<float, 16> channelMix;
 		std::array<float, 16> prevChannelMix;
 
+		size_t consumeDelay(size_t numSamples);
+		void skip(size_t numSamples);
 		void advancePlayback(size_t samples);
 		void onFadeEnd();
     };
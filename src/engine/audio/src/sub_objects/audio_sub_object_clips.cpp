@@ -93,6 +93,11 @@ std::unique_ptr<AudioSource> AudioSubObjectClips::makeSource(AudioEngine& engine
 	return std::make_unique<AudioSourceClip>(engine, clip, loop, engine.getRNG().getFloat(gain), loopStart, loopEnd, randomiseStart);
 }
 
+bool AudioSubObjectClips::isStreaming() const
+{
+	return std::any_of(clipData.begin(), clipData.end(), [] (const auto& clip) { return clip && clip->isStreaming(); });
+}
+
 void AudioSubObjectClips::loadDependencies(Resources& resources)
 {
 	if (clipData.size() != clips.size()) {
@@ -73,6 +73,11 @@ std::unique_ptr<AudioSource> AudioSubObjectLayers::makeSource(AudioEngine& engin
 	return std::make_unique<AudioSourceLayers>(engine, emitter, std::move(sources), *this, fadeConfig);
 }
 
+bool AudioSubObjectLayers::isStreaming() const
+{
+	return std::any_of(layers.begin(), layers.end(), [] (const Layer& layer) { return layer.object->isStreaming(); });
+}
+
 void AudioSubObjectLayers::loadDependencies(Resources& resources)
 {
 	for (auto& l: layers) {
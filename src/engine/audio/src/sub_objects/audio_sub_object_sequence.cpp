@@ -31,6 +31,11 @@ std::unique_ptr<AudioSource> AudioSubObjectSequence::makeSource(AudioEngine& eng
 	return std::make_unique<AudioSourceSequence>(engine, emitter, *this);
 }
 
+bool AudioSubObjectSequence::isStreaming() const
+{
+	return std::any_of(segments.begin(), segments.end(), [] (const Segment& segment) { return segment.object->isStreaming(); });
+}
+
 String AudioSubObjectSequence::getName() const
 {
 	return name.isEmpty() ? "Sequence" : name;
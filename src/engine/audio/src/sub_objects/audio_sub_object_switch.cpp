@@ -36,6 +36,11 @@ std::unique_ptr<AudioSource> AudioSubObjectSwitch::makeSource(AudioEngine& engin
 	return {};
 }
 
+bool AudioSubObjectSwitch::isStreaming() const
+{
+	return std::any_of(cases.begin(), cases.end(), [] (const auto& c) { return c.second->isStreaming(); });
+}
+
 String AudioSubObjectSwitch::getName() const
 {
 	return "Switch [" + switchId + "]";
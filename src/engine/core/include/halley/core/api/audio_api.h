@@ -221,6 +221,8 @@ namespace Halley
 		[[deprecated("Use setBusVolume")]] void setGroupVolume(const String& groupName, float gain = 1.0f) { setBusVolume(groupName, gain); }
 		virtual void setBusVolume(const String& busName, float gain = 1.0f) = 0;
 		virtual void setOutputChannels(Vector<AudioChannelData> audioChannelData) = 0;
+		virtual void setMaxVoices(size_t maxVoices) = 0; // Voices past this limit, or inaudible, are virtualised
+		virtual void setMixThreads(size_t nThreads) = 0; // Worker threads to mix voices on, on top of the audio thread. 0 mixes everything on the audio thread
 
 		virtual void setListener(AudioListenerData listener) = 0;
 
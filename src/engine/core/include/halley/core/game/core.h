@@ -41,6 +41,7 @@ namespace Halley
 		void quit(int exitCode = 0) override;
 		const Environment& getEnvironment() override;
 		bool isDevMode() override;
+		bool isHeadless() const override { return headless; }
 		
 		void onTick(Time delta) override;
 		bool isRunning() const override	{ return running; }
@@ -126,6 +127,7 @@ namespace Halley
 		bool running = true;
 		bool hasError = false;
 		bool hasConsole = false;
+		bool headless = false;
 		int exitCode = 0;
 		std::unique_ptr<RedirectStream> out;
 
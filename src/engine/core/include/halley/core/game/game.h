@@ -47,6 +47,10 @@ namespace Halley
 		virtual double getTargetFPS() const;
 		virtual double getTargetBackgroundFPS() const;
 		virtual double getFixedUpdateFPS() const;
+
+		// Headless games (e.g. dedicated servers) don't initialise video, audio, input or movie, never render, and tick at exactly getFixedUpdateFPS()
+		// Can also be enabled with the --headless command line argument
+		virtual bool isHeadless() const;
 		virtual size_t getMaxThreads() const;
 
 		virtual String getDevConAddress() const;
@@ -3,6 +3,8 @@
 #include <string>
 #include <chrono>
 
+#include "halley/data_structures/vector.h"
+
 #include "halley/maths/rolling_data_set.h"
 
 namespace Halley
@@ -28,6 +30,7 @@ namespace Halley
 		virtual void onTerminatedInError(const std::string& error) = 0;
 
 		virtual double getTargetFPS() = 0;
+		virtual bool isHeadless() const = 0;
 		virtual bool hasVsync() = 0;
 		virtual void waitForVsync() = 0;
 	};
@@ -45,6 +48,8 @@ namespace Halley
 		using Clock = std::chrono::high_resolution_clock;
 
 		void runLoop();
+		void runHeadlessLoop();
+		void reportTickTimes(Vector<Time>& tickTimes, size_t ticksDropped) const;
 		Time snapElapsedTime(Time measuredElapsed, std::optional<Time> desired, RollingDataSet<Clock::time_point>& frameTimes);
 		bool isRunning() const;
 		bool tryReload() const;
@@ -37,6 +37,7 @@ namespace Halley
 		friend class Core;
 		friend class Material;
 		friend class RenderSnapshot;
+		friend class SpritePainter;
 
 		struct PainterVertexData
 		{
@@ -74,6 +75,9 @@ namespace Halley
 		// vertPosOffset is the offset, in bytes, from the start of each vertex's data, to a Vector2f which will be filled with the vertex's position in 0-1 space.
 		void drawSprites(const std::shared_ptr<const Material>& material, size_t numSprites, const void* vertexData);
 
+		// Same as above, but the data of consecutive sprites is srcStride bytes apart (e.g. sizeof(Sprite), to read straight from a span of sprites)
+		void drawSprites(const std::shared_ptr<const Material>& material, size_t numSprites, const void* vertexData, size_t srcStride);
+
 		// Draw one sliced sprite. Slices -> x = left, y = top, z = right, w = bottom, in [0..1] space relative to the texture
 		void drawSlicedSprite(const std::shared_ptr<const Material>& material, Vector2f scale, Vector4f slices, const void* vertexData);
 
@@ -107,6 +111,14 @@ namespace Halley
 		size_t getPrevVertices() const { return prevVertices; }
 		size_t getPrevTriangles() const { return prevTriangles; }
 
+		// How many draw calls were avoided by reordering non-overlapping draws by material (see setBatchReorderWindow)
+		size_t getNumBatchesSaved() const { return nBatchesSaved; }
+		size_t getPrevBatchesSaved() const { return prevBatchesSaved; }
+
+		// When non-zero, SpritePainter may move a sprite back past up to this many batches of other materials within the same layer, as long as it doesn't overlap any of them, so it joins a batch of its own material
+		void setBatchReorderWindow(size_t window) { batchReorderWindow = window; }
+		size_t getBatchReorderWindow() const { return batchReorderWindow; }
+
 		void setLogging(bool logging);
 
 		void pushDebugGroup(const String& id);
@@ -184,6 +196,9 @@ namespace Halley
 		size_t prevDrawCalls = 0;
 		size_t prevVertices = 0;
 		size_t prevTriangles = 0;
+		size_t nBatchesSaved = 0;
+		size_t prevBatchesSaved = 0;
+		size_t batchReorderWindow = 0;
 		bool logging = true;
 
 		Vector<IndexType> stdQuadIndexCache;
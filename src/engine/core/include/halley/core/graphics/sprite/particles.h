@@ -10,14 +10,20 @@ namespace Halley {
 	class Animation;
 	
 	class Particles {
-		struct Particle {
-			Vector3f pos;
-			Vector3f vel;
-			Angle1f angle;
-			float scale = 1;
-			float time = 0;
-			float ttl = 1;
-			bool alive = true;
+		// Stored as structure of arrays, so the simulation can run on four particles at a time.
+		// Capacity is always a multiple of four, so the last group can be processed whole.
+		struct ParticleData {
+			Vector<float> posX, posY, posZ;
+			Vector<float> velX, velY, velZ;
+			Vector<float> angle;
+			Vector<float> scale;
+			Vector<float> time;
+			Vector<float> ttl;
+			Vector<uint8_t> alive;
+
+			size_t size() const;
+			void resize(size_t size);
+			void swap(size_t a, size_t b);
 		};
 		
 	public:
@@ -64,6 +70,10 @@ namespace Halley {
 
 		bool isAnimated() const;
 		bool isAlive() const;
+
+		// Emitters with at least this many live particles update them across the CPU executors
+		void setParallelUpdateThreshold(std::optional<size_t> threshold);
+		std::optional<size_t> getParallelUpdateThreshold() const;
 		
 		[[nodiscard]] gsl::span<Sprite> getSprites();
 		[[nodiscard]] gsl::span<const Sprite> getSprites() const;
@@ -77,7 +87,7 @@ namespace Halley {
 		float spawnRateMultiplier = 1.0f;
 
 		Vector<Sprite> sprites;
-		Vector<Particle> particles;
+		ParticleData particles;
 		Vector<AnimationPlayerLite> animationPlayers;
 		
 		size_t nParticlesAlive = 0;
@@ -107,6 +117,7 @@ namespace Halley {
 		std::optional<size_t> maxParticles;
 		std::optional<size_t> burst;
 		std::optional<float> minHeight;
+		std::optional<size_t> parallelUpdateThreshold;
 
 		Vector<Sprite> baseSprites;
 		std::shared_ptr<const Animation> baseAnimation;
@@ -115,6 +126,8 @@ namespace Halley {
 		void start();
 		void initializeParticle(size_t index, float time);
 		void updateParticles(float t);
+		void integrateParticles(size_t start, size_t end, float t);
+		void updateParticleSprites(size_t start, size_t end, float t);
 		void spawn(size_t n, float time);
 
 		Vector3f getSpawnPosition() const;
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include "halley/maths/rect.h"
 #include <limits>
+#include <array>
 #include <optional>
 
 #include "halley/data_structures/hash_map.h"
@@ -35,6 +36,8 @@ namespace Halley
 		SpritePainterEntry(SpritePainterEntryType type, size_t spriteIdx, size_t count, int mask, int layer, float tieBreaker, size_t insertOrder, std::optional<Rect4f> clip);
 
 		bool operator<(const SpritePainterEntry& o) const;
+		uint64_t getSortKey() const;
+		int getLayer() const;
 		SpritePainterEntryType getType() const;
 		gsl::span<const Sprite> getSprites() const;
 		gsl::span<const TextRenderer> getTexts() const;
@@ -70,9 +73,27 @@ namespace Halley
 		void addCopy(const TextRenderer& text, int mask, int layer, float tieBreaker, std::optional<Rect4f> clip = {});
 		void add(SpritePainterEntry::Callback callback, int mask, int layer, float tieBreaker, std::optional<Rect4f> clip = {});
 		
+		// Sorting and band bounds are only recomputed after entries change, so referenced sprites shouldn't move between draws without a new start()
 		void draw(int mask, Painter& painter);
 
+		// How many entries a draw with this mask and view goes through once whole bands are culled, mostly useful for profiling
+		size_t getNumEntriesInView(int mask, Rect4f view);
+
 	private:
+		struct SortItem {
+			uint64_t key;
+			uint32_t index;
+		};
+
+		// A run of consecutive entries (in draw order) within the same layer and around the same area, culled as a whole when possible
+		struct Band {
+			uint32_t start;
+			uint32_t end;
+			int mask;
+			bool cullable;
+			std::optional<Rect4f> bounds;
+		};
+
 		Vector<SpritePainterEntry> sprites;
 		Vector<Sprite> cachedSprites;
 		Vector<TextRenderer> cachedText;
@@ -80,7 +101,40 @@ namespace Halley
 		bool dirty = false;
 		bool forceCopy = false;
 
-		void draw(gsl::span<const Sprite> sprite, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const;
+		// Sprites waiting to be reordered by material, see Painter::setBatchReorderWindow
+		struct PendingSprite {
+			const Sprite* sprite;
+			Rect4f bounds;
+			uint32_t next;
+		};
+
+		struct PendingBatch {
+			const Material* material;
+			Rect4f bounds;
+			uint32_t first;
+			uint32_t last;
+		};
+
+		Vector<PendingSprite> pendingSprites;
+		Vector<PendingBatch> pendingBatches;
+
+		Vector<SortItem> sortItems;
+		Vector<SortItem> sortItemsScratch;
+		Vector<SpritePainterEntry> sortedSprites;
+		Vector<Band> bands;
+		Vector<Rect4f> spriteBounds;
+		Vector<uint32_t> boundsStart; // Index into spriteBounds for each sorted entry
+
+		void update();
+		void sortEntries();
+		void updateBands();
+		bool isInView(const Band& band, int mask, Rect4f view) const;
+		gsl::span<const Sprite> getSprites(const SpritePainterEntry& entry) const;
+		gsl::span<const Rect4f> getBounds(uint32_t entryIdx) const;
+
+		void draw(gsl::span<const Sprite> sprite, gsl::span<const Rect4f> aabbs, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip, bool cull) const;
+		void addReorderable(gsl::span<const Sprite> sprite, gsl::span<const Rect4f> aabbs, Painter& painter, Rect4f view, bool cull);
+		void flushReordered(Painter& painter);
 		void draw(gsl::span<const TextRenderer> text, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const;
 		void draw(const SpritePainterEntry::Callback& callback, Painter& painter, const std::optional<Rect4f>& clip) const;
 	};
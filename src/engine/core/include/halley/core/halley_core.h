@@ -71,6 +71,7 @@ namespace Halley {} // Get GitHub to realise this is C++ :3
 #include "resources/resources.h"
 #include "resources/resource_locator.h"
 #include "resources/resource_reference.h"
+#include "resources/resource_streamer.h"
 
 #include "stage/stage.h"
 
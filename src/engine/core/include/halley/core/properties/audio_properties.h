@@ -47,6 +47,49 @@ namespace Halley {
 		int nHorizontalDividers = 10;
 	};
 
+	class AudioBusSendProperties {
+	public:
+		AudioBusSendProperties() = default;
+		AudioBusSendProperties(const ConfigNode& node);
+
+		ConfigNode toConfigNode() const;
+		
+		void serialize(Serializer& s) const;
+		void deserialize(Deserializer& s);
+
+		const String& getBus() const;
+		float getGain() const;
+
+	private:
+		String bus;
+		float gain = 1.0f;
+	};
+
+	class AudioCompressorProperties {
+	public:
+		AudioCompressorProperties() = default;
+		AudioCompressorProperties(const ConfigNode& node);
+
+		ConfigNode toConfigNode() const;
+		
+		void serialize(Serializer& s) const;
+		void deserialize(Deserializer& s);
+
+		bool isEnabled() const;
+		float getThreshold() const; // In dB
+		float getRatio() const;
+		float getAttack() const; // In seconds
+		float getRelease() const; // In seconds
+		const String& getSidechain() const; // Bus whose level drives the compressor, empty to use its own input
+
+	private:
+		float threshold = 0.0f;
+		float ratio = 1.0f;
+		float attack = 0.005f;
+		float release = 0.1f;
+		String sidechain;
+	};
+
 	class AudioBusProperties {
 	public:
 		AudioBusProperties() = default;
@@ -62,11 +105,20 @@ namespace Halley {
 		gsl::span<const AudioBusProperties> getChildren() const;
 		gsl::span<AudioBusProperties> getChildren();
 
+		float getLowPassCutoff() const; // In Hz, 0 disables it
+		float getHighPassCutoff() const; // In Hz, 0 disables it
+		const AudioCompressorProperties& getCompressor() const;
+		gsl::span<const AudioBusSendProperties> getSends() const;
+
 		void collectBusIds(Vector<String>& output) const;
 
 	private:
 		String id;
 		Vector<AudioBusProperties> children;
+		float lowPassCutoff = 0;
+		float highPassCutoff = 0;
+		AudioCompressorProperties compressor;
+		Vector<AudioBusSendProperties> sends;
 	};
 
 	class AudioProperties {
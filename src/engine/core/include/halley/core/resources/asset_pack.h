@@ -12,6 +12,7 @@ namespace Halley {
 	class AssetDatabase;
 	class ResourceData;
 	class ResourceDataReader;
+	class MemoryMappedFile;
 
 	struct AssetPackHeader {
 		std::array<char, 8> identifier;
@@ -28,6 +29,7 @@ namespace Halley {
 		AssetPack(const AssetPack& other) = delete;
 		AssetPack(AssetPack&& other) noexcept;
 		AssetPack(std::unique_ptr<ResourceDataReader> reader, const String& encryptionKey = "", bool preLoad = false);
+		AssetPack(std::shared_ptr<MemoryMappedFile> file, const String& encryptionKey = ""); // Static data is returned as views into the mapping
 		~AssetPack();
 
 		AssetPack& operator=(const AssetPack& other) = delete;
@@ -50,6 +52,8 @@ namespace Halley {
 
 		std::unique_ptr<ResourceDataReader> extractReader();
 
+		bool isMemoryMapped() const;
+
     private:
 		std::unique_ptr<AssetDatabase> assetDb;
 		std::unique_ptr<ResourceDataReader> reader;
@@ -57,7 +61,13 @@ namespace Halley {
 		std::mutex readerMutex;
 		size_t dataOffset = 0;
 		Bytes data;
+		std::shared_ptr<MemoryMappedFile> mappedFile;
+		gsl::span<const gsl::byte> mappedData;
 		std::array<char, 16> iv;
+
+		void readHeader(const AssetPackHeader& header, size_t totalSize);
+		void loadAssetDatabase(gsl::span<const gsl::byte> assetDbBytes);
+		bool isEncrypted(const String& encryptionKey) const;
     };
 
 
@@ -8,6 +8,7 @@
 #include <halley/text/halleystring.h>
 #include <halley/resources/resource_data.h>
 #include <halley/data_structures/hash_map.h>
+#include "resource_streamer.h"
 
 namespace Halley
 {
@@ -19,6 +20,8 @@ namespace Halley
 
 	class ResourceCollectionBase
 	{
+		friend class ResourceStreamer;
+
 		class Wrapper
 		{
 		public:
@@ -52,6 +55,7 @@ namespace Halley
 		void purge(std::string_view assetId);
 
 		std::shared_ptr<Resource> getUntyped(std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal);
+		std::shared_ptr<ResourceRequest> getAsyncUntyped(std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal);
 
 		Vector<String> enumerate() const;
 
@@ -68,11 +72,15 @@ namespace Halley
 		virtual std::shared_ptr<Resource> loadResource(ResourceLoader& loader) = 0;
 
 		std::shared_ptr<Resource> doGet(std::string_view name, ResourceLoadPriority priority, bool allowFallback);
-		std::pair<std::shared_ptr<Resource>, bool> loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback);
+		std::pair<std::shared_ptr<Resource>, bool> loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback, std::unique_ptr<ResourceDataStatic> prefetched = {});
+		std::unique_ptr<ResourceDataStatic> prefetchAsset(std::string_view assetId);
+		std::shared_ptr<Resource> finishStreaming(std::string_view assetId, std::shared_ptr<Resource> resource, bool cache);
+		void abandonStreaming(std::string_view assetId, const ResourceRequest* request);
 
 	private:
 		Resources& parent;
 		HashMap<String, Wrapper> resources;
+		HashMap<String, std::weak_ptr<ResourceRequest>> streaming;
 		String fallback;
 		AssetType type;
 		ResourceLoaderFunc resourceLoader;
@@ -95,6 +103,11 @@ namespace Halley
 			return std::static_pointer_cast<T>(doGet(assetId, priority, true));
 		}
 
+		ResourceHandle<T> getAsync(std::string_view assetId, ResourceLoadPriority priority = ResourceLoadPriority::Normal)
+		{
+			return ResourceHandle<T>(getAsyncUntyped(assetId, priority));
+		}
+
 	protected:
 		std::shared_ptr<Resource> loadResource(ResourceLoader& loader) override {
 			return T::loadResource(loader);
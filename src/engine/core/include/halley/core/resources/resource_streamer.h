@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <halley/data_structures/vector.h>
+#include <halley/resources/resource_data.h>
+#include <halley/text/halleystring.h>
+#include <halley/time/halleytime.h>
+
+namespace Halley
+{
+	enum class AssetType;
+	class Resource;
+	class ResourceCollectionBase;
+
+	class ResourceRequest
+	{
+		friend class ResourceStreamer;
+
+	public:
+		enum class State
+		{
+			Queued,
+			Reading,
+			Decoding,
+			Loaded,
+			Failed
+		};
+
+		ResourceRequest(ResourceCollectionBase& collection, String assetId, ResourceLoadPriority priority);
+		explicit ResourceRequest(std::shared_ptr<Resource> loaded);
+
+		const String& getAssetId() const;
+		ResourceLoadPriority getPriority() const;
+		State getState() const;
+		bool isDone() const;
+
+		std::shared_ptr<Resource> getResource() const; // Null until loaded
+
+	private:
+		ResourceCollectionBase* collection = nullptr;
+		String assetId;
+		std::atomic<ResourceLoadPriority> priority;
+		std::atomic<State> state;
+		std::shared_ptr<Resource> resource;
+		std::unique_ptr<ResourceDataStatic> data;
+		bool fallback = false;
+	};
+
+	// Placeholder for a resource being streamed in, which resolves once it's loaded.
+	// When every handle to a request goes away, any loading work that hasn't started yet is cancelled.
+	template <typename T>
+	class ResourceHandle
+	{
+	public:
+		ResourceHandle() = default;
+		explicit ResourceHandle(std::shared_ptr<ResourceRequest> request)
+			: request(std::move(request))
+		{}
+
+		bool isValid() const { return request != nullptr; }
+		bool isReady() const { return request && request->getState() == ResourceRequest::State::Loaded; }
+		bool hasFailed() const { return request && request->getState() == ResourceRequest::State::Failed; }
+		const String& getAssetId() const { return request->getAssetId(); }
+
+		std::shared_ptr<const T> get() const
+		{
+			return request ? std::static_pointer_cast<const T>(request->getResource()) : std::shared_ptr<const T>();
+		}
+
+	private:
+		std::shared_ptr<ResourceRequest> request;
+	};
+
+	// Streams resources in the background: requests are served in priority order, data is read on the disk IO executor,
+	// decoded on CPU workers (or on the main thread, for types which talk to the video API while loading), and then handed over to their collections in update().
+	class ResourceStreamer
+	{
+	public:
+		ResourceStreamer();
+		~ResourceStreamer();
+
+		void enqueue(const std::shared_ptr<ResourceRequest>& request);
+		void raisePriority(const std::shared_ptr<ResourceRequest>& request, ResourceLoadPriority priority);
+
+		// Call from the main thread, finishes as many requests as it can within the time budget
+		void update(Time maxTime = 0.004);
+
+		size_t getPendingCount() const;
+
+		static bool canDecodeOnWorker(AssetType type);
+
+	private:
+		// Remembers where a request came from, so that its collection can forget about it if it's cancelled
+		struct PendingRequest
+		{
+			std::weak_ptr<ResourceRequest> request;
+			ResourceCollectionBase* collection = nullptr;
+			String assetId;
+
+			explicit PendingRequest(const std::shared_ptr<ResourceRequest>& request);
+		};
+
+		struct QueueEntry
+		{
+			ResourceLoadPriority priority;
+			uint64_t sequence;
+			PendingRequest pending;
+
+			bool operator<(const QueueEntry& other) const;
+		};
+
+		struct SharedState
+		{
+			std::mutex mutex;
+			Vector<QueueEntry> queue;
+			std::deque<PendingRequest> toDecode;
+			std::deque<PendingRequest> toFinish;
+			uint64_t nextSequence = 0;
+			std::atomic<int> pending;
+			std::atomic<int> running;
+			std::atomic<bool> aborted;
+		};
+
+		std::shared_ptr<SharedState> state;
+
+		void push(std::shared_ptr<ResourceRequest> request, ResourceLoadPriority priority);
+
+		static void readNext(const std::shared_ptr<SharedState>& state);
+		static void decode(SharedState& state, const std::shared_ptr<ResourceRequest>& request);
+		static void finish(SharedState& state, const std::shared_ptr<ResourceRequest>& request);
+		static void cancel(SharedState& state, const PendingRequest& pending);
+	};
+}
@@ -66,6 +66,13 @@ namespace Halley {
 			return of<T>().get(name, priority);
 		}
 
+		// Streams the resource in the background, see ResourceStreamer
+		template <typename T>
+		ResourceHandle<T> getAsync(std::string_view name, ResourceLoadPriority priority = ResourceLoadPriority::Normal) const
+		{
+			return of<T>().getAsync(name, priority);
+		}
+
 		template <typename T>
 		void preload(std::string_view name) const
 		{
@@ -122,10 +129,14 @@ namespace Halley {
 
 		void generateMemoryReport();
 
+		void update(); // Finishes streamed resources, call from the main thread
+		ResourceStreamer& getStreamer() const;
+
 	private:
 		const std::unique_ptr<ResourceLocator> locator;
 		Vector<std::unique_ptr<ResourceCollectionBase>> resources;
 		const HalleyAPI* const api;
 		ResourceOptions options;
+		std::unique_ptr<ResourceStreamer> streamer; // Declared after resources so it's destroyed before them
 	};
 }
@@ -51,6 +51,7 @@ Core::Core(std::unique_ptr<Game> g, Vector<std::string> _args)
 
 	// Basic initialization
 	game->init(*environment, args);
+	headless = game->isHeadless() || std_ex::contains(args, String("--headless"));
 
 	// Console
 	if (game->shouldCreateSeparateConsole()) {
@@ -88,7 +89,12 @@ Core::Core(std::unique_ptr<Game> g, Vector<std::string> _args)
 
 	// Create API
 	registerDefaultPlugins();
-	api = HalleyAPI::create(this, game->initPlugins(*this));
+	int apiFlags = game->initPlugins(*this);
+	if (headless) {
+		std::cout << "Running headless." << std::endl;
+		apiFlags &= ~(HalleyAPIFlags::Video | HalleyAPIFlags::Audio | HalleyAPIFlags::Input | HalleyAPIFlags::Movie);
+	}
+	api = HalleyAPI::create(this, apiFlags);
 }
 
 Core::~Core()
@@ -186,6 +192,10 @@ void Core::waitForVsync()
 
 double Core::getTargetFPS()
 {
+	if (headless) {
+		return game->getFixedUpdateFPS();
+	}
+
 	if (api && api->video && api->video->hasWindow()) {
 		const auto& window = api->video->getWindow().getDefinition();
 		if (!window.isFocusLost() && window.getWindowState() != WindowState::Minimized) {
@@ -293,7 +303,9 @@ void Core::initResources()
 	auto options = game->initResourceLocator(gamePath, api->system->getAssetsPath(gamePath.string()), api->system->getUnpackedAssetsPath(gamePath.string()), *locator);
 	resources = std::make_unique<Resources>(std::move(locator), *api, options);
 	StandardResources::initialize(*resources);
-	api->audioInternal->setResources(*resources);
+	if (api->audioInternal) {
+		api->audioInternal->setResources(*resources);
+	}
 }
 
 void Core::setOutRedirect(bool appendToExisting)
@@ -316,9 +328,11 @@ void Core::processEvents(Time time)
 {
 	ProfilerEvent event(ProfilerEventType::CorePumpEvents);
 
-	auto* video = dynamic_cast<VideoAPIInternal*>(&*api->video);
-	auto* input = dynamic_cast<InputAPIInternal*>(&*api->input);
-	input->beginEvents(time);
+	auto* video = dynamic_cast<VideoAPIInternal*>(api->video);
+	auto* input = dynamic_cast<InputAPIInternal*>(api->input);
+	if (input) {
+		input->beginEvents(time);
+	}
 
 	if (api->system) {
 		api->systemInternal->onTickMainLoop();
@@ -385,7 +399,7 @@ void Core::tickFrame(Time time)
 		return;
 	}
 
-	const bool multithreaded = currentStage && currentStage->hasMultithreadedRendering();
+	const bool multithreaded = !headless && currentStage && currentStage->hasMultithreadedRendering();
 
 	updateFrameData(multithreaded);
 	runStartFrame(time);
@@ -426,6 +440,8 @@ void Core::update(Time time)
 
 void Core::preUpdate(Time time)
 {
+	resources->update();
+
 	if (devConClient) {
 		ProfilerEvent event(ProfilerEventType::CoreDevConClient);
 		devConClient->update(time);
@@ -53,6 +53,11 @@ double Game::getFixedUpdateFPS() const
 	return 60.0;
 }
 
+bool Game::isHeadless() const
+{
+	return false;
+}
+
 String Game::getDevConAddress() const
 {
 	return "";
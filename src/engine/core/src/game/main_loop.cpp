@@ -11,8 +11,11 @@
 #include <chrono>
 #include <thread>
 #include <cstdint>
+#include <algorithm>
 
 #include "halley/maths/rolling_data_set.h"
+#include "halley/support/logger.h"
+#include "halley/text/string_converter.h"
 
 using namespace Halley;
 
@@ -25,7 +28,11 @@ MainLoop::MainLoop(IMainLoopable& target, GameLoader& reloader)
 void MainLoop::run()
 {
 	do {
-		runLoop();
+		if (target.isHeadless()) {
+			runHeadlessLoop();
+		} else {
+			runLoop();
+		}
 	} while (tryReload());
 }
 
@@ -87,6 +94,71 @@ void MainLoop::runLoop()
 	std::cout << ConsoleColour(Console::GREEN) << "Main loop terminated." << ConsoleColour() << std::endl;
 }
 
+void MainLoop::runHeadlessLoop()
+{
+	std::cout << ConsoleColour(Console::GREEN) << "\nStarting headless main loop." << ConsoleColour() << std::endl;
+
+	// Headless ticks are always exactly one fixed step long, and scheduled against a steady clock rather than measured
+	using HeadlessClock = std::chrono::steady_clock;
+	constexpr Time reportInterval = 60.0;
+	constexpr int maxTicksBehind = 5;
+
+	auto nextTick = HeadlessClock::now();
+	Vector<Time> tickTimes;
+	size_t ticksDropped = 0;
+
+	while (isRunning()) {
+		if (target.transitionStage()) {
+			nextTick = HeadlessClock::now();
+		}
+
+		const double tickRate = target.getTargetFPS();
+		Expects(tickRate > 0);
+		const Time tickLength = 1.0 / tickRate;
+		const auto tickPeriod = std::chrono::duration_cast<HeadlessClock::duration>(std::chrono::duration<double>(tickLength));
+
+		const auto tickStart = HeadlessClock::now();
+		target.onTick(tickLength);
+		const auto tickEnd = HeadlessClock::now();
+
+		tickTimes.push_back(std::chrono::duration<double>(tickEnd - tickStart).count());
+		if (static_cast<double>(tickTimes.size()) >= reportInterval * tickRate) {
+			reportTickTimes(tickTimes, ticksDropped);
+			tickTimes.clear();
+			ticksDropped = 0;
+		}
+
+		// Late ticks run back-to-back to catch up, unless we've fallen too far behind
+		nextTick += tickPeriod;
+		const auto behind = tickEnd - nextTick;
+		if (behind > tickPeriod * maxTicksBehind) {
+			ticksDropped += static_cast<size_t>(behind / tickPeriod);
+			nextTick = tickEnd;
+		} else {
+			std::this_thread::sleep_until(nextTick);
+		}
+	}
+
+	std::cout << ConsoleColour(Console::GREEN) << "Main loop terminated." << ConsoleColour() << std::endl;
+}
+
+void MainLoop::reportTickTimes(Vector<Time>& tickTimes, size_t ticksDropped) const
+{
+	if (tickTimes.empty()) {
+		return;
+	}
+
+	std::sort(tickTimes.begin(), tickTimes.end());
+	const auto percentile = [&] (double p)
+	{
+		const auto idx = std::min(static_cast<size_t>(p * static_cast<double>(tickTimes.size())), tickTimes.size() - 1);
+		return toString(tickTimes[idx] * 1000.0, 2) + " ms";
+	};
+
+	Logger::logInfo("Tick times over " + toString(tickTimes.size()) + " ticks: p50 " + percentile(0.5) + ", p90 " + percentile(0.9) + ", p99 " + percentile(0.99) + ", max " + percentile(1.0)
+		+ (ticksDropped > 0 ? ", " + toString(ticksDropped) + " ticks dropped" : String()));
+}
+
 Time MainLoop::snapElapsedTime(Time measuredElapsed, std::optional<Time> desired, RollingDataSet<Clock::time_point>& frameTimes)
 {
 	Time elapsed = measuredElapsed;
@@ -15,6 +15,7 @@
 #include "graphics/render_snapshot.h"
 #include "halley/maths/bezier.h"
 #include "halley/maths/polygon.h"
+#include "halley/maths/simd.h"
 #include "halley/support/logger.h"
 #include "halley/support/profiler.h"
 #include "halley/utils/algorithm.h"
@@ -51,7 +52,8 @@ void Painter::startRender()
 	prevDrawCalls = nDrawCalls;
 	prevTriangles = nTriangles;
 	prevVertices = nVertices;
-	nDrawCalls = nTriangles = nVertices = 0;
+	prevBatchesSaved = nBatchesSaved;
+	nDrawCalls = nTriangles = nVertices = nBatchesSaved = 0;
 	frameStart = frameEnd = 0;
 
 	refreshConstantBufferCache();
@@ -175,46 +177,89 @@ void Painter::drawQuads(const std::shared_ptr<const Material>& material, size_t
 	generateQuadIndices(result.firstIndex, numVertices / 4, result.dstIndex);
 }
 
-void Painter::drawSprites(const std::shared_ptr<const Material>& material, size_t totalNumSprites, const void* vertexData)
+void Painter::drawSprites(const std::shared_ptr<const Material>& material, size_t numSprites, const void* vertexData)
+{
+	drawSprites(material, numSprites, vertexData, material->getDefinition().getVertexStride());
+}
+
+namespace {
+	// Expands each sprite into the four vertices of its quad, overwriting vertPos with the corner.
+	// j -> vertPos
+	// 0 -> 0, 0
+	// 1 -> 1, 0
+	// 2 -> 1, 1
+	// 3 -> 0, 1
+	void writeSpriteVertices(char* dst, const char* src, size_t numSprites, size_t srcStride, size_t vertexSize, size_t vertexStride, size_t vertPosOffset)
+	{
+		constexpr size_t verticesPerSprite = 4;
+		const bool canUseSIMD = vertexSize % 16 == 0 && vertexStride % 16 == 0 && vertPosOffset % 16 == 0;
+
+		if (canUseSIMD) {
+			alignas(16) static constexpr float cornerData[verticesPerSprite][4] = { { 0, 0, 0, 0 }, { 1, 0, 1, 0 }, { 1, 1, 1, 1 }, { 0, 1, 0, 1 } };
+			const std::array<SIMDVec4, verticesPerSprite> corners = {
+				SIMDVec4::loadAligned(cornerData[0]), SIMDVec4::loadAligned(cornerData[1]), SIMDVec4::loadAligned(cornerData[2]), SIMDVec4::loadAligned(cornerData[3])
+			};
+			const size_t nLanes = vertexSize / 16;
+			const size_t posLane = vertPosOffset / 16;
+			const size_t dstFloatStride = vertexStride / sizeof(float);
+
+			for (size_t i = 0; i < numSprites; ++i) {
+				const auto* s = reinterpret_cast<const float*>(src + i * srcStride);
+				auto* d = reinterpret_cast<float*>(dst + i * verticesPerSprite * vertexStride);
+
+				for (size_t lane = 0; lane < nLanes; ++lane) {
+					const size_t offset = lane * 4;
+					if (lane == posLane) {
+						for (size_t j = 0; j < verticesPerSprite; ++j) {
+							corners[j].storeUnaligned(d + j * dstFloatStride + offset);
+						}
+					} else {
+						const auto v = SIMDVec4::loadUnaligned(s + offset);
+						for (size_t j = 0; j < verticesPerSprite; ++j) {
+							v.storeUnaligned(d + j * dstFloatStride + offset);
+						}
+					}
+				}
+			}
+		} else {
+			for (size_t i = 0; i < numSprites; i++) {
+				for (size_t j = 0; j < verticesPerSprite; j++) {
+					const size_t srcOffset = i * srcStride;
+					const size_t dstOffset = (i * verticesPerSprite + j) * vertexStride;
+					memcpy(dst + dstOffset, src + srcOffset, vertexSize);
+
+					const float x = ((j & 1) ^ ((j & 2) >> 1)) * 1.0f;
+					const float y = ((j & 2) >> 1) * 1.0f;
+					getVertPos(dst + dstOffset, vertPosOffset) = Vector4f(x, y, x, y);
+				}
+			}
+		}
+	}
+}
+
+void Painter::drawSprites(const std::shared_ptr<const Material>& material, size_t totalNumSprites, const void* vertexData, size_t srcStride)
 {
 	Expects(vertexData != nullptr);
 
 	const size_t verticesPerSprite = 4;
 	const size_t maxSpritesPerCall = (static_cast<size_t>(std::numeric_limits<IndexType>::max()) + 1) / verticesPerSprite;
+	const size_t vertPosOffset = material->getDefinition().getVertexPosOffset();
 	size_t numSpritesLeft = totalNumSprites;
 	size_t offset = 0;
 
 	while (numSpritesLeft > 0) {
 		const size_t numSprites = std::min(numSpritesLeft, maxSpritesPerCall);
-		
 		const size_t numVertices = verticesPerSprite * numSprites;
-		const size_t vertPosOffset = material->getDefinition().getVertexPosOffset();
 
 		const auto result = addDrawData(material, numVertices, numSprites * 6, true);
 
 		const char* const src = reinterpret_cast<const char*>(vertexData) + offset;
-
-		for (size_t i = 0; i < numSprites; i++) {
-			for (size_t j = 0; j < verticesPerSprite; j++) {
-				const size_t srcOffset = i * result.vertexStride;
-				const size_t dstOffset = (i * verticesPerSprite + j) * result.vertexStride;
-				memcpy(result.dstVertex + dstOffset, src + srcOffset, result.vertexSize);
-
-				// j -> vertPos
-				// 0 -> 0, 0
-				// 1 -> 1, 0
-				// 2 -> 1, 1
-				// 3 -> 0, 1
-				const float x = ((j & 1) ^ ((j & 2) >> 1)) * 1.0f;
-				const float y = ((j & 2) >> 1) * 1.0f;
-				getVertPos(result.dstVertex + dstOffset, vertPosOffset) = Vector4f(x, y, x, y);
-			}
-		}
+		writeSpriteVertices(result.dstVertex, src, numSprites, srcStride, result.vertexSize, result.vertexStride, vertPosOffset);
 
 		generateQuadIndices(result.firstIndex, numSprites, result.dstIndex);
 
 		numSpritesLeft -= numSprites;
-		offset += numSprites * material->getDefinition().getVertexStride();
+		offset += numSprites * srcStride;
 	}
 }
 
@@ -1,10 +1,34 @@
 #include "graphics/sprite/particles.h"
 
+#include "halley/concurrency/concurrent.h"
 #include "halley/maths/random.h"
+#include "halley/maths/simd.h"
 #include "halley/support/logger.h"
 
 using namespace Halley;
 
+size_t Particles::ParticleData::size() const
+{
+	return alive.size();
+}
+
+void Particles::ParticleData::resize(size_t size)
+{
+	Expects(size % 4 == 0);
+	for (auto* v: { &posX, &posY, &posZ, &velX, &velY, &velZ, &angle, &scale, &time, &ttl }) {
+		v->resize(size);
+	}
+	alive.resize(size);
+}
+
+void Particles::ParticleData::swap(size_t a, size_t b)
+{
+	for (auto* v: { &posX, &posY, &posZ, &velX, &velY, &velZ, &angle, &scale, &time, &ttl }) {
+		std::swap((*v)[a], (*v)[b]);
+	}
+	std::swap(alive[a], alive[b]);
+}
+
 Particles::Particles()
 	: rng(&Random::getGlobal())
 {
@@ -225,10 +249,10 @@ void Particles::update(Time t)
 
 	// Remove dead particles
 	for (size_t i = 0; i < nParticlesAlive; ) {
-		if (!particles[i].alive) {
+		if (!particles.alive[i]) {
 			if (i != nParticlesAlive - 1) {
 				// Swap with last particle that's alive
-				std::swap(particles[i], particles[nParticlesAlive - 1]);
+				particles.swap(i, nParticlesAlive - 1);
 				std::swap(sprites[i], sprites[nParticlesAlive - 1]);
 				if (isAnimated()) {
 					std::swap(animationPlayers[i], animationPlayers[nParticlesAlive - 1]);
@@ -268,6 +292,16 @@ bool Particles::isAlive() const
 	return nParticlesAlive > 0 || !destroyWhenDone;
 }
 
+void Particles::setParallelUpdateThreshold(std::optional<size_t> threshold)
+{
+	parallelUpdateThreshold = threshold;
+}
+
+std::optional<size_t> Particles::getParallelUpdateThreshold() const
+{
+	return parallelUpdateThreshold;
+}
+
 gsl::span<Sprite> Particles::getSprites()
 {
 	return gsl::span<Sprite>(sprites).subspan(0, nParticlesVisible);
@@ -288,6 +322,7 @@ void Particles::spawn(size_t n, float time)
 	nParticlesAlive += n;
 	const size_t size = std::max(size_t(8), nextPowerOf2(nParticlesAlive));
 	if (particles.size() < size) {
+		// Always a multiple of four, as the simulation processes groups of four
 		particles.resize(size);
 		sprites.resize(size);
 		if (isAnimated()) {
@@ -306,15 +341,20 @@ void Particles::initializeParticle(size_t index, float time)
 	const auto startAzimuth = Angle1f::fromDegrees(rng->getFloat(angle.x - angleScatter.x, angle.x + angleScatter.x));
 	const auto startElevation = Angle1f::fromDegrees(rng->getFloat(angle.y - angleScatter.y, angle.y + angleScatter.y));
 	
-	auto& particle = particles[index];
-	particle.alive = true;
-	particle.time = time;
-	particle.ttl = rng->getFloat(ttl - ttlScatter, ttl + ttlScatter);
-	particle.pos = getSpawnPosition();
-	particle.angle = rotateTowardsMovement ? startAzimuth : Angle1f();
-	particle.scale = startScale;
-	
-	particle.vel = Vector3f(rng->getFloat(speed - speedScatter, speed + speedScatter), startAzimuth, startElevation);
+	const auto pos = getSpawnPosition();
+	const auto vel = Vector3f(rng->getFloat(speed - speedScatter, speed + speedScatter), startAzimuth, startElevation);
+
+	particles.alive[index] = 1;
+	particles.time[index] = time;
+	particles.ttl[index] = rng->getFloat(ttl - ttlScatter, ttl + ttlScatter);
+	particles.posX[index] = pos.x;
+	particles.posY[index] = pos.y;
+	particles.posZ[index] = pos.z;
+	particles.velX[index] = vel.x;
+	particles.velY[index] = vel.y;
+	particles.velZ[index] = vel.z;
+	particles.angle[index] = rotateTowardsMovement ? startAzimuth.getRadians() : 0.0f;
+	particles.scale[index] = startScale;
 
 	auto& sprite = sprites[index];
 	if (isAnimated()) {
@@ -327,58 +367,133 @@ void Particles::initializeParticle(size_t index, float time)
 
 void Particles::updateParticles(float time)
 {
-	const bool hasAnim = isAnimated();
-	
-	for (size_t i = 0; i < nParticlesAlive; ++i) {
-		if (hasAnim) {
-			animationPlayers[i].update(time, sprites[i]);
-		}
-		
-		auto& particle = particles[i];
+	const size_t n = nParticlesAlive;
+	if (n == 0) {
+		return;
+	}
 
-		particle.time += time;
-		if (particle.time >= particle.ttl) {
-			particle.alive = false;
+	const bool parallel = parallelUpdateThreshold && n >= parallelUpdateThreshold.value();
+	auto forEachRange = [&] (auto f)
+	{
+		if (parallel) {
+			// Chunks start at multiples of four, so no two threads ever touch the same group
+			auto& queue = Executors::getCPU();
+			const size_t chunkSize = alignUp(Concurrent::getParallelChunkSize(queue, n), size_t(4));
+			Concurrent::parallelFor(queue, n, chunkSize, [&] (size_t, size_t start, size_t end) { f(start, end); });
 		} else {
-			particle.pos += (particle.vel * time + acceleration * (0.5f * time * time)) * velScale;
-			particle.vel += acceleration * time;
+			f(0, n);
+		}
+	};
 
-			if (minHeight && particle.pos.z < minHeight) {
-				particle.alive = false;
-			}
-			
-			if (stopTime > 0.00001f && particle.time + stopTime >= particle.ttl) {
-				particle.vel = damp(particle.vel, Vector3f(), 10.0f, time);
-			}
-			
-			if (speedDamp > 0.0001f) {
-				particle.vel = damp(particle.vel, Vector3f(), speedDamp, time);
-			}
+	forEachRange([&] (size_t start, size_t end) { integrateParticles(start, end, time); });
 
-			if (directionScatter > 0.00001f) {
-				particle.vel = Vector3f(particle.vel.xy().rotate(Angle1f::fromDegrees(rng->getFloat(-directionScatter * time, directionScatter * time))), particle.vel.z);
+	if (directionScatter > 0.00001f) {
+		// Uses the shared rng, so it can't go wide
+		for (size_t i = 0; i < n; ++i) {
+			if (particles.alive[i]) {
+				const auto vel = Vector2f(particles.velX[i], particles.velY[i]).rotate(Angle1f::fromDegrees(rng->getFloat(-directionScatter * time, directionScatter * time)));
+				particles.velX[i] = vel.x;
+				particles.velY[i] = vel.y;
 			}
+		}
+	}
 
-			if (rotateTowardsMovement && particle.vel.squaredLength() > 0.001f) {
-				particle.angle = particle.vel.xy().angle();
-			}
+	forEachRange([&] (size_t start, size_t end) { updateParticleSprites(start, end, time); });
+}
 
-			particle.scale = lerp(startScale, endScale, particle.time / particle.ttl);
+void Particles::integrateParticles(size_t start, size_t end, float time)
+{
+	// Damping towards zero velocity is the same multiplication for every particle
+	const float speedDampFactor = speedDamp > 0.0001f ? std::exp(-speedDamp * time) : 1.0f;
+	const float stopDampFactor = std::exp(-10.0f * time);
+	const float halfTimeSquared = 0.5f * time * time;
 
-			if (fadeInTime > 0.000001f || fadeOutTime > 0.00001f) {
-				const float alpha = clamp(std::min(particle.time / fadeInTime, (particle.ttl - particle.time) / fadeOutTime), 0.0f, 1.0f);
-				sprites[i].getColour().a = alpha;
-			}
+	const auto dt = SIMDVec4::loadSingleValue(time);
+	const auto posStepX = SIMDVec4::loadSingleValue(time * velScale.x);
+	const auto posStepY = SIMDVec4::loadSingleValue(time * velScale.y);
+	const auto posStepZ = SIMDVec4::loadSingleValue(time * velScale.z);
+	const auto accelPosX = SIMDVec4::loadSingleValue(acceleration.x * halfTimeSquared * velScale.x);
+	const auto accelPosY = SIMDVec4::loadSingleValue(acceleration.y * halfTimeSquared * velScale.y);
+	const auto accelPosZ = SIMDVec4::loadSingleValue(acceleration.z * halfTimeSquared * velScale.z);
+	const auto accelVelX = SIMDVec4::loadSingleValue(acceleration.x * time);
+	const auto accelVelY = SIMDVec4::loadSingleValue(acceleration.y * time);
+	const auto accelVelZ = SIMDVec4::loadSingleValue(acceleration.z * time);
+	const auto damp = SIMDVec4::loadSingleValue(speedDampFactor);
+	const auto scale0 = SIMDVec4::loadSingleValue(startScale);
+	const auto scaleDelta = SIMDVec4::loadSingleValue(endScale - startScale);
+
+	const size_t groupEnd = alignUp(end, size_t(4));
+	Expects(groupEnd <= particles.size());
+
+	for (size_t i = start; i < groupEnd; i += 4) {
+		const auto t = SIMDVec4::loadUnaligned(&particles.time[i]) + dt;
+		t.storeUnaligned(&particles.time[i]);
 
-			sprites[i]
-				.setPosition(particle.pos.xy() + Vector2f(0, -particle.pos.z))
-				.setRotation(particle.angle)
-				.setScale(particle.scale)
-				.setCustom1(Vector4f(particle.pos.xy(), 0, 0));
+		const auto vx = SIMDVec4::loadUnaligned(&particles.velX[i]);
+		const auto vy = SIMDVec4::loadUnaligned(&particles.velY[i]);
+		const auto vz = SIMDVec4::loadUnaligned(&particles.velZ[i]);
+
+		(SIMDVec4::loadUnaligned(&particles.posX[i]) + vx * posStepX + accelPosX).storeUnaligned(&particles.posX[i]);
+		(SIMDVec4::loadUnaligned(&particles.posY[i]) + vy * posStepY + accelPosY).storeUnaligned(&particles.posY[i]);
+		(SIMDVec4::loadUnaligned(&particles.posZ[i]) + vz * posStepZ + accelPosZ).storeUnaligned(&particles.posZ[i]);
+
+		((vx + accelVelX) * damp).storeUnaligned(&particles.velX[i]);
+		((vy + accelVelY) * damp).storeUnaligned(&particles.velY[i]);
+		((vz + accelVelZ) * damp).storeUnaligned(&particles.velZ[i]);
+
+		(scale0 + scaleDelta * (t / SIMDVec4::loadUnaligned(&particles.ttl[i]))).storeUnaligned(&particles.scale[i]);
+	}
+
+	// The rest depends on per-particle conditions
+	const bool stopDamp = stopTime > 0.00001f;
+	for (size_t i = start; i < end; ++i) {
+		const float t = particles.time[i];
+		const float particleTtl = particles.ttl[i];
+		particles.alive[i] = t < particleTtl && !(minHeight && particles.posZ[i] < minHeight.value()) ? 1 : 0;
+
+		if (stopDamp && t + stopTime >= particleTtl) {
+			particles.velX[i] *= stopDampFactor;
+			particles.velY[i] *= stopDampFactor;
+			particles.velZ[i] *= stopDampFactor;
 		}
 	}
 }
 
+void Particles::updateParticleSprites(size_t start, size_t end, float time)
+{
+	const bool hasAnim = isAnimated();
+	const bool fade = fadeInTime > 0.000001f || fadeOutTime > 0.00001f;
+
+	for (size_t i = start; i < end; ++i) {
+		auto& sprite = sprites[i];
+		if (hasAnim) {
+			animationPlayers[i].update(time, sprite);
+		}
+
+		if (!particles.alive[i]) {
+			continue;
+		}
+
+		const auto pos = Vector2f(particles.posX[i], particles.posY[i]);
+		const auto vel = Vector2f(particles.velX[i], particles.velY[i]);
+		if (rotateTowardsMovement && vel.squaredLength() + particles.velZ[i] * particles.velZ[i] > 0.001f) {
+			particles.angle[i] = vel.angle().getRadians();
+		}
+
+		if (fade) {
+			const float t = particles.time[i];
+			const float alpha = clamp(std::min(t / fadeInTime, (particles.ttl[i] - t) / fadeOutTime), 0.0f, 1.0f);
+			sprite.getColour().a = alpha;
+		}
+
+		sprite
+			.setPosition(pos + Vector2f(0, -particles.posZ[i]))
+			.setRotation(Angle1f::fromRadians(particles.angle[i]))
+			.setScale(particles.scale[i])
+			.setCustom1(Vector4f(pos, 0, 0));
+	}
+}
+
 Vector3f Particles::getSpawnPosition() const
 {
 	return position + Vector3f(rng->getFloat(-spawnArea.x * 0.5f, spawnArea.x * 0.5f), rng->getFloat(-spawnArea.y * 0.5f, spawnArea.y * 0.5f), startHeight);
@@ -103,26 +103,12 @@ void Sprite::draw(gsl::span<const Sprite> sprites, Painter& painter) // static
 
 	auto& material = sprites[0].material;
 	Expects(material->getDefinition().getVertexStride() == sizeof(SpriteVertexAttrib) + 16);
-
-	size_t spriteSize = sizeof(SpriteVertexAttrib) + 16;
-	char buffer[4096];
-	char* vertexData;
-	Vector<char> vertices;
-	const size_t vertexDataSize = sprites.size() * spriteSize;
-	if (vertexDataSize <= 4096) {
-		vertexData = buffer;
-	} else {
-		vertices.resize(vertexDataSize);
-		vertexData = vertices.data();
-	}
-
-	for (size_t i = 0; i < sprites.size(); i++) {
-		auto& sprite = sprites[i];
+	for (auto& sprite: sprites) {
 		Expects(sprite.material == material);
-		memcpy(&vertexData[i * spriteSize], sprite.getVertexAttrib(), spriteSize);
 	}
 
-	painter.drawSprites(material, sprites.size(), vertexData);
+	// Vertex data is read straight out of each sprite
+	painter.drawSprites(material, sprites.size(), sprites[0].getVertexAttrib(), sizeof(Sprite));
 }
 
 void Sprite::drawMixedMaterials(const Sprite* sprites, size_t n, Painter& painter)
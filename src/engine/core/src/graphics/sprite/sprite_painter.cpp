@@ -2,6 +2,7 @@
 #include "graphics/sprite/sprite.h"
 #include "graphics/painter.h"
 #include <gsl/gsl>
+#include <cstring>
 
 #include "graphics/material/material.h"
 #include "graphics/text/text_renderer.h"
@@ -54,6 +55,24 @@ bool SpritePainterEntry::operator<(const SpritePainterEntry& o) const
 	}
 }
 
+uint64_t SpritePainterEntry::getSortKey() const
+{
+	// Layer in the high bits, tie breaker in the low bits, both mapped so that unsigned order matches their signed order
+	const uint32_t layerKey = uint32_t(layer) ^ 0x80000000u;
+
+	uint32_t tieBits;
+	const float tie = tieBreaker + 0.0f; // Collapses -0 into +0, as they compare equal
+	memcpy(&tieBits, &tie, sizeof(tieBits));
+	const uint32_t tieKey = (tieBits & 0x80000000u) != 0 ? ~tieBits : (tieBits | 0x80000000u);
+
+	return (uint64_t(layerKey) << 32) | uint64_t(tieKey);
+}
+
+int SpritePainterEntry::getLayer() const
+{
+	return layer;
+}
+
 SpritePainterEntryType SpritePainterEntry::getType() const
 {
 	return type;
@@ -100,6 +119,7 @@ void SpritePainter::start(bool forceCopy)
 	sprites.clear();
 	cachedSprites.clear();
 	cachedText.clear();
+	dirty = true;
 }
 
 void SpritePainter::add(const Sprite& sprite, int mask, int layer, float tieBreaker, std::optional<Rect4f> clip)
@@ -190,49 +210,329 @@ void SpritePainter::add(SpritePainterEntry::Callback callback, int mask, int lay
 	dirty = true;
 }
 
-void SpritePainter::draw(int mask, Painter& painter)
+void SpritePainter::update()
 {
 	if (dirty) {
-		// TODO: implement hierarchical bucketing.
-		// - one bucket per layer
-		// - for each layer, one bucket per vertical band of the screen (32px or so)
-		// - sort each leaf bucket
-		std::sort(sprites.begin(), sprites.end()); // lol
+		sortEntries();
+		updateBands();
 		dirty = false;
 	}
+}
+
+bool SpritePainter::isInView(const Band& band, int mask, Rect4f view) const
+{
+	if ((band.mask & mask) == 0) {
+		return false;
+	}
+	return !band.cullable || (band.bounds && band.bounds->overlaps(view));
+}
+
+size_t SpritePainter::getNumEntriesInView(int mask, Rect4f view)
+{
+	update();
+
+	size_t count = 0;
+	for (const auto& band: bands) {
+		if (isInView(band, mask, view)) {
+			for (uint32_t i = band.start; i < band.end; ++i) {
+				if ((sprites[i].getMask() & mask) != 0) {
+					++count;
+				}
+			}
+		}
+	}
+	return count;
+}
+
+void SpritePainter::draw(int mask, Painter& painter)
+{
+	update();
 
 	// View
 	const auto& cam = painter.getCurrentCamera();
 	Rect4f view = cam.getClippingRectangle();
 
 	// Draw!
-	for (auto& s : sprites) {
-		if ((s.getMask() & mask) != 0) {
-			const auto type = s.getType();
-			
-			if (type == SpritePainterEntryType::SpriteRef) {
-				draw(s.getSprites(), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::SpriteCached) {
-				draw(gsl::span<const Sprite>(cachedSprites.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::TextRef) {
-				draw(s.getTexts(), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::TextCached) {
-				draw(gsl::span<const TextRenderer>(cachedText.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
-			} else if (type == SpritePainterEntryType::Callback) {
-				draw(callbacks.at(s.getIndex()), painter, s.getClip());
+	const bool reorder = painter.getBatchReorderWindow() > 0;
+	std::optional<int> lastLayer;
+	for (const auto& band: bands) {
+		if (!isInView(band, mask, view)) {
+			continue;
+		}
+		const bool cull = !band.cullable || !view.contains(band.bounds.value());
+
+		for (uint32_t i = band.start; i < band.end; ++i) {
+			const auto& s = sprites[i];
+			if ((s.getMask() & mask) != 0) {
+				const auto type = s.getType();
+				const bool isSprite = type == SpritePainterEntryType::SpriteRef || type == SpritePainterEntryType::SpriteCached;
+
+				// Sprites are only ever reordered within a layer, and never across anything else
+				if (!pendingSprites.empty() && (!isSprite || s.getClip() || s.getLayer() != lastLayer)) {
+					flushReordered(painter);
+				}
+				lastLayer = s.getLayer();
+
+				if (isSprite && reorder && !s.getClip()) {
+					addReorderable(getSprites(s), getBounds(i), painter, view, cull);
+				} else if (isSprite) {
+					draw(getSprites(s), getBounds(i), painter, view, s.getClip(), cull);
+				} else if (type == SpritePainterEntryType::TextRef) {
+					draw(s.getTexts(), painter, view, s.getClip());
+				} else if (type == SpritePainterEntryType::TextCached) {
+					draw(gsl::span<const TextRenderer>(cachedText.data() + s.getIndex(), s.getCount()), painter, view, s.getClip());
+				} else if (type == SpritePainterEntryType::Callback) {
+					draw(callbacks.at(s.getIndex()), painter, s.getClip());
+				}
 			}
 		}
 	}
+	flushReordered(painter);
 	painter.flush();
 }
 
-void SpritePainter::draw(gsl::span<const Sprite> sprites, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const
+void SpritePainter::addReorderable(gsl::span<const Sprite> sprites, gsl::span<const Rect4f> aabbs, Painter& painter, Rect4f view, bool cull)
 {
-	for (const auto& sprite: sprites) {
-		if (sprite.isInView(view)) {
-			sprite.draw(painter, clip);
+	const size_t window = painter.getBatchReorderWindow();
+
+	for (size_t i = 0; i < sprites.size(); ++i) {
+		const auto& sprite = sprites[i];
+		if (!sprite.isVisible() || !sprite.hasMaterial()) {
+			continue;
+		}
+		const auto bounds = aabbs[i];
+		if (cull && !bounds.overlaps(view)) {
+			continue;
+		}
+		if (sprite.getClip()) {
+			// Sprite clips force a flush on the painter anyway
+			flushReordered(painter);
+			sprite.draw(painter);
+			continue;
+		}
+
+		const auto* material = &sprite.getMaterial();
+		const auto idx = uint32_t(pendingSprites.size());
+		pendingSprites.push_back(PendingSprite{ &sprite, bounds, std::numeric_limits<uint32_t>::max() });
+
+		// Walk back through the most recent batches. The sprite can join a batch of the same material as long as it doesn't overlap anything it'd be moved behind.
+		const size_t nBatches = pendingBatches.size();
+		std::optional<size_t> target;
+		for (size_t j = nBatches; j > 0 && nBatches - j < window; --j) {
+			const auto& batch = pendingBatches[j - 1];
+			if (batch.material == material || *batch.material == *material) {
+				target = j - 1;
+				break;
+			}
+			if (batch.bounds.overlaps(bounds)) {
+				break;
+			}
+		}
+
+		if (target) {
+			auto& batch = pendingBatches[*target];
+			pendingSprites[batch.last].next = idx;
+			batch.last = idx;
+			batch.bounds = batch.bounds.merge(bounds);
+		} else {
+			pendingBatches.push_back(PendingBatch{ material, bounds, idx, idx });
+		}
+	}
+}
+
+void SpritePainter::flushReordered(Painter& painter)
+{
+	if (pendingSprites.empty()) {
+		return;
+	}
+
+	// Count how many batches drawing them in their original order would have taken
+	size_t originalBatches = 0;
+	const Material* prevMaterial = nullptr;
+	for (const auto& pending: pendingSprites) {
+		const auto* material = &pending.sprite->getMaterial();
+		if (!prevMaterial || !(prevMaterial == material || *prevMaterial == *material)) {
+			++originalBatches;
+		}
+		prevMaterial = material;
+	}
+	painter.nBatchesSaved += originalBatches - pendingBatches.size();
+
+	for (const auto& batch: pendingBatches) {
+		for (auto i = batch.first; i != std::numeric_limits<uint32_t>::max(); i = pendingSprites[i].next) {
+			pendingSprites[i].sprite->draw(painter);
+		}
+	}
+
+	pendingSprites.clear();
+	pendingBatches.clear();
+}
+
+void SpritePainter::sortEntries()
+{
+	// Stable LSD radix sort on the packed layer + tie breaker key, so insertion order breaks the remaining ties
+	const size_t n = sprites.size();
+	sortItems.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		sortItems[i] = SortItem{ sprites[i].getSortKey(), uint32_t(i) };
+	}
+
+	if (n < 64) {
+		std::stable_sort(sortItems.begin(), sortItems.end(), [] (const SortItem& a, const SortItem& b) { return a.key < b.key; });
+	} else {
+		constexpr size_t nPasses = sizeof(uint64_t);
+		std::array<std::array<uint32_t, 256>, nPasses> histograms = {};
+		for (const auto& item: sortItems) {
+			for (size_t pass = 0; pass < nPasses; ++pass) {
+				++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+			}
+		}
+
+		sortItemsScratch.resize(n);
+		for (size_t pass = 0; pass < nPasses; ++pass) {
+			auto& histogram = histograms[pass];
+			const auto shift = pass * 8;
+
+			// Skip digits shared by every key, which is most of the layer bytes
+			if (histogram[(sortItems[0].key >> shift) & 0xFF] == n) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& h: histogram) {
+				const auto count = h;
+				h = offset;
+				offset += count;
+			}
+			for (const auto& item: sortItems) {
+				sortItemsScratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+			}
+			std::swap(sortItems, sortItemsScratch);
+		}
+	}
+
+	sortedSprites.clear();
+	sortedSprites.reserve(n);
+	for (const auto& item: sortItems) {
+		sortedSprites.push_back(std::move(sprites[item.index]));
+	}
+	std::swap(sprites, sortedSprites);
+}
+
+void SpritePainter::updateBands()
+{
+	// Split each layer into runs of consecutive entries. A run is closed when it gets too long, or when the next entry lands far away from it,
+	// so that each band covers a compact area and culls well even when draw order jumps around the screen.
+	constexpr size_t maxBandSize = 64;
+	constexpr size_t minBandSize = 8;
+	constexpr float maxAreaGrowth = 2.0f;
+
+	auto getArea = [] (const Rect4f& r) { return r.getWidth() * r.getHeight(); };
+
+	bands.clear();
+	spriteBounds.clear();
+	boundsStart.resize(sprites.size());
+
+	std::optional<Band> band;
+	size_t spriteCount = 0;
+	for (uint32_t i = 0; i < uint32_t(sprites.size()); ++i) {
+		const auto& entry = sprites[i];
+		const auto type = entry.getType();
+		const bool isSprite = type == SpritePainterEntryType::SpriteRef || type == SpritePainterEntryType::SpriteCached;
+
+		// Every sprite's bounds are worked out once here, and reused for culling by every draw until the next start()
+		boundsStart[i] = uint32_t(spriteBounds.size());
+		std::optional<Rect4f> entryBounds;
+		if (isSprite) {
+			for (const auto& sprite: getSprites(entry)) {
+				const auto aabb = sprite.getAABB();
+				spriteBounds.push_back(aabb);
+				if (sprite.isVisible()) {
+					entryBounds = entryBounds ? entryBounds->merge(aabb) : aabb;
+				}
+			}
+		}
+
+		if (band) {
+			bool split = sprites[band->start].getLayer() != entry.getLayer() || spriteCount >= maxBandSize;
+			if (!split && spriteCount >= minBandSize && band->bounds && entryBounds) {
+				split = getArea(band->bounds->merge(*entryBounds)) > maxAreaGrowth * (getArea(*band->bounds) + getArea(*entryBounds));
+			}
+			if (split) {
+				bands.push_back(*band);
+				band.reset();
+			}
+		}
+		if (!band) {
+			band = Band{ i, i, 0, true, {} };
+			spriteCount = 0;
+		}
+
+		band->end = i + 1;
+		band->mask |= entry.getMask();
+		if (isSprite) {
+			if (entryBounds) {
+				band->bounds = band->bounds ? band->bounds->merge(*entryBounds) : *entryBounds;
+			}
+			spriteCount += entry.getCount();
+		} else {
+			band->cullable = false;
+			++spriteCount;
+		}
+	}
+	if (band) {
+		bands.push_back(*band);
+	}
+}
+
+gsl::span<const Sprite> SpritePainter::getSprites(const SpritePainterEntry& entry) const
+{
+	if (entry.getType() == SpritePainterEntryType::SpriteCached) {
+		return gsl::span<const Sprite>(cachedSprites.data() + entry.getIndex(), entry.getCount());
+	} else {
+		return entry.getSprites();
+	}
+}
+
+gsl::span<const Rect4f> SpritePainter::getBounds(uint32_t entryIdx) const
+{
+	return gsl::span<const Rect4f>(spriteBounds.data() + boundsStart[entryIdx], sprites[entryIdx].getCount());
+}
+
+void SpritePainter::draw(gsl::span<const Sprite> sprites, gsl::span<const Rect4f> aabbs, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip, bool cull) const
+{
+	// Runs of consecutive plain sprites sharing a material have their vertices generated in one go
+	size_t runStart = 0;
+	size_t runLength = 0;
+	auto flushRun = [&] ()
+	{
+		if (runLength > 0) {
+			Sprite::draw(sprites.subspan(runStart, runLength), painter);
+			runLength = 0;
+		}
+	};
+
+	for (size_t i = 0; i < sprites.size(); ++i) {
+		const auto& sprite = sprites[i];
+		if (!sprite.isVisible() || (cull && !aabbs[i].overlaps(view))) {
+			flushRun();
+			continue;
+		}
+
+		const bool batchable = !clip && sprite.hasMaterial() && !sprite.isSliced() && !sprite.getClip();
+		if (batchable && runLength > 0 && sprites[runStart].getMaterialPtr() == sprite.getMaterialPtr()) {
+			++runLength;
+		} else {
+			flushRun();
+			if (batchable) {
+				runStart = i;
+				runLength = 1;
+			} else {
+				sprite.draw(painter, clip);
+			}
 		}
 	}
+	flushRun();
 }
 
 void SpritePainter::draw(gsl::span<const TextRenderer> texts, Painter& painter, Rect4f view, const std::optional<Rect4f>& clip) const
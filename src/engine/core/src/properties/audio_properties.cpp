@@ -110,10 +110,120 @@ void AudioVariableProperties::setNumberOfHorizontalDividers(int n)
 	nHorizontalDividers = n;
 }
 
+AudioBusSendProperties::AudioBusSendProperties(const ConfigNode& node)
+{
+	bus = node["bus"].asString();
+	gain = node["gain"].asFloat(1.0f);
+}
+
+ConfigNode AudioBusSendProperties::toConfigNode() const
+{
+	ConfigNode::MapType result;
+	result["bus"] = bus;
+	result["gain"] = gain;
+	return result;
+}
+
+void AudioBusSendProperties::serialize(Serializer& s) const
+{
+	s << bus;
+	s << gain;
+}
+
+void AudioBusSendProperties::deserialize(Deserializer& s)
+{
+	s >> bus;
+	s >> gain;
+}
+
+const String& AudioBusSendProperties::getBus() const
+{
+	return bus;
+}
+
+float AudioBusSendProperties::getGain() const
+{
+	return gain;
+}
+
+AudioCompressorProperties::AudioCompressorProperties(const ConfigNode& node)
+{
+	threshold = node["threshold"].asFloat(0.0f);
+	ratio = node["ratio"].asFloat(1.0f);
+	attack = node["attack"].asFloat(0.005f);
+	release = node["release"].asFloat(0.1f);
+	sidechain = node["sidechain"].asString("");
+}
+
+ConfigNode AudioCompressorProperties::toConfigNode() const
+{
+	ConfigNode::MapType result;
+	result["threshold"] = threshold;
+	result["ratio"] = ratio;
+	result["attack"] = attack;
+	result["release"] = release;
+	if (!sidechain.isEmpty()) {
+		result["sidechain"] = sidechain;
+	}
+	return result;
+}
+
+void AudioCompressorProperties::serialize(Serializer& s) const
+{
+	s << threshold;
+	s << ratio;
+	s << attack;
+	s << release;
+	s << sidechain;
+}
+
+void AudioCompressorProperties::deserialize(Deserializer& s)
+{
+	s >> threshold;
+	s >> ratio;
+	s >> attack;
+	s >> release;
+	s >> sidechain;
+}
+
+bool AudioCompressorProperties::isEnabled() const
+{
+	return ratio > 1.0f;
+}
+
+float AudioCompressorProperties::getThreshold() const
+{
+	return threshold;
+}
+
+float AudioCompressorProperties::getRatio() const
+{
+	return ratio;
+}
+
+float AudioCompressorProperties::getAttack() const
+{
+	return attack;
+}
+
+float AudioCompressorProperties::getRelease() const
+{
+	return release;
+}
+
+const String& AudioCompressorProperties::getSidechain() const
+{
+	return sidechain;
+}
+
 AudioBusProperties::AudioBusProperties(const ConfigNode& node)
 {
 	id = node["id"].asString();
 	children = node["children"].asVector<AudioBusProperties>();
+	lowPassCutoff = node["lowPass"].asFloat(0);
+	highPassCutoff = node["highPass"].asFloat(0);
+	compressor = AudioCompressorProperties(node["compressor"]);
+	sends = node["sends"].asVector<AudioBusSendProperties>({});
 }
 
 ConfigNode AudioBusProperties::toConfigNode() const
@@ -121,6 +231,18 @@ ConfigNode AudioBusProperties::toConfigNode() const
 	ConfigNode::MapType result;
 	result["id"] = id;
 	result["children"] = children;
+	if (lowPassCutoff > 0) {
+		result["lowPass"] = lowPassCutoff;
+	}
+	if (highPassCutoff > 0) {
+		result["highPass"] = highPassCutoff;
+	}
+	if (compressor.isEnabled()) {
+		result["compressor"] = compressor.toConfigNode();
+	}
+	if (!sends.empty()) {
+		result["sends"] = sends;
+	}
 	return result;
 }
 
@@ -128,12 +250,20 @@ void AudioBusProperties::serialize(Serializer& s) const
 {
 	s << id;
 	s << children;
+	s << lowPassCutoff;
+	s << highPassCutoff;
+	s << compressor;
+	s << sends;
 }
 
 void AudioBusProperties::deserialize(Deserializer& s)
 {
 	s >> id;
 	s >> children;
+	s >> lowPassCutoff;
+	s >> highPassCutoff;
+	s >> compressor;
+	s >> sends;
 }
 
 const String& AudioBusProperties::getId() const
@@ -156,6 +286,26 @@ gsl::span<AudioBusProperties> AudioBusProperties::getChildren()
 	return children;
 }
 
+float AudioBusProperties::getLowPassCutoff() const
+{
+	return lowPassCutoff;
+}
+
+float AudioBusProperties::getHighPassCutoff() const
+{
+	return highPassCutoff;
+}
+
+const AudioCompressorProperties& AudioBusProperties::getCompressor() const
+{
+	return compressor;
+}
+
+gsl::span<const AudioBusSendProperties> AudioBusProperties::getSends() const
+{
+	return sends;
+}
+
 void AudioBusProperties::collectBusIds(Vector<String>& output) const
 {
 	output.push_back(id);
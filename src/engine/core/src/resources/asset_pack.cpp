@@ -3,6 +3,7 @@
 #include "halley/resources/resource_data.h"
 #include "halley/bytes/byte_serializer.h"
 #include "halley/bytes/compression.h"
+#include "halley/file/memory_mapped_file.h"
 #include "halley/maths/random.h"
 #include "halley/utils/encrypt.h"
 
@@ -33,7 +34,7 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	, hasReader(true)
 {
 	// Read header
-	size_t totalSize = reader->size();
+	const size_t totalSize = reader->size();
 	if (totalSize < sizeof(AssetPackHeader)) {
 		throw Exception("Asset pack is invalid (too small)", HalleyExceptions::Resources);
 	}
@@ -42,11 +43,7 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	if (nRead != int(sizeof(header))) {
 		throw Exception("Unable to read header", HalleyExceptions::Resources);
 	}
-	if (memcmp(header.identifier.data(), "HALLEYPK", 8) != 0) {
-		throw Exception("Asset pack is invalid (invalid identifier)", HalleyExceptions::Resources);
-	}
-	iv = header.iv;
-	dataOffset = size_t(header.dataStartPos);
+	readHeader(header, totalSize);
 
 	// Read asset database
 	{
@@ -56,14 +53,10 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 		if (nRead != int(assetDbBytes.size())) {
 			throw Exception("Unable to read header", HalleyExceptions::Resources);
 		}
-		assetDb = std::make_unique<AssetDatabase>();
-		Deserializer::fromBytes<AssetDatabase>(*assetDb, Compression::decompress(assetDbBytes));
+		loadAssetDatabase(gsl::as_bytes(gsl::span<const Byte>(assetDbBytes)));
 	}
 
-	std::array<char, 16> ivEmpty;
-	memset(ivEmpty.data(), 0, ivEmpty.size());
-	const bool hasCrypt = memcmp(iv.data(), ivEmpty.data(), iv.size()) != 0 && !encryptionKey.isEmpty();
-
+	const bool hasCrypt = isEncrypted(encryptionKey);
 	if (preLoad || hasCrypt) {
 		readToMemory();
 	}
@@ -73,10 +66,58 @@ AssetPack::AssetPack(std::unique_ptr<ResourceDataReader> _reader, const String&
 	}
 }
 
+AssetPack::AssetPack(std::shared_ptr<MemoryMappedFile> file, const String& encryptionKey)
+	: hasReader(false)
+{
+	const auto bytes = file->getSpan();
+	if (size_t(bytes.size()) < sizeof(AssetPackHeader)) {
+		throw Exception("Asset pack is invalid (too small)", HalleyExceptions::Resources);
+	}
+	AssetPackHeader header;
+	memcpy(&header, bytes.data(), sizeof(header));
+	readHeader(header, bytes.size());
+
+	loadAssetDatabase(bytes.subspan(size_t(header.assetDbStartPos), size_t(header.dataStartPos - header.assetDbStartPos)));
+
+	mappedData = bytes.subspan(dataOffset);
+	mappedFile = std::move(file);
+
+	if (isEncrypted(encryptionKey)) {
+		// Can't decrypt in place, so this is no better than reading it in
+		readToMemory();
+		decrypt(encryptionKey);
+	}
+}
+
 AssetPack::~AssetPack()
 {
 }
 
+void AssetPack::readHeader(const AssetPackHeader& header, size_t totalSize)
+{
+	if (memcmp(header.identifier.data(), "HALLEYPK", 8) != 0) {
+		throw Exception("Asset pack is invalid (invalid identifier)", HalleyExceptions::Resources);
+	}
+	if (header.assetDbStartPos > header.dataStartPos || header.dataStartPos > totalSize) {
+		throw Exception("Asset pack is invalid (bad header)", HalleyExceptions::Resources);
+	}
+	iv = header.iv;
+	dataOffset = size_t(header.dataStartPos);
+}
+
+void AssetPack::loadAssetDatabase(gsl::span<const gsl::byte> assetDbBytes)
+{
+	assetDb = std::make_unique<AssetDatabase>();
+	Deserializer::fromBytes<AssetDatabase>(*assetDb, Compression::decompress(assetDbBytes));
+}
+
+bool AssetPack::isEncrypted(const String& encryptionKey) const
+{
+	std::array<char, 16> ivEmpty;
+	memset(ivEmpty.data(), 0, ivEmpty.size());
+	return memcmp(iv.data(), ivEmpty.data(), iv.size()) != 0 && !encryptionKey.isEmpty();
+}
+
 AssetPack& AssetPack::operator=(AssetPack&& other) noexcept
 {
 	std::unique_lock<std::mutex> lock(other.readerMutex);
@@ -85,8 +126,13 @@ AssetPack& AssetPack::operator=(AssetPack&& other) noexcept
 	dataOffset = other.dataOffset;
 	reader = std::move(other.reader);
 	data = std::move(other.data);
+	mappedFile = std::move(other.mappedFile);
+	mappedData = other.mappedData;
+	iv = other.iv;
 	hasReader = !!reader;
 
+	other.mappedData = {};
+
 	other.hasReader = false;
 	other.reader.reset();
 
@@ -120,10 +166,11 @@ Bytes AssetPack::writeOut() const
 	header.init(assetDbBytes.size());
 	header.iv = iv;
 
-	auto result = Bytes(size_t(header.dataStartPos + data.size()));
+	const auto packData = mappedFile ? mappedData : gsl::as_bytes(gsl::span<const Byte>(data));
+	auto result = Bytes(size_t(header.dataStartPos + packData.size()));
 	memcpy(result.data(), &header, sizeof(AssetPackHeader));
 	memcpy(result.data() + header.assetDbStartPos, assetDbBytes.data(), assetDbBytes.size());
-	memcpy(result.data() + header.dataStartPos, data.data(), data.size());
+	memcpy(result.data() + header.dataStartPos, packData.data(), packData.size());
 	return result;
 }
 
@@ -138,6 +185,14 @@ std::unique_ptr<ResourceData> AssetPack::getData(const String& asset, AssetType
 		return std::make_unique<ResourceDataStream>(path, [=] () -> std::unique_ptr<ResourceDataReader> {
 			return std::make_unique<PackDataReader>(*this, pos, size);
 		});
+	} else if (mappedFile) {
+		if (pos + size > size_t(mappedData.size())) {
+			throw Exception("Asset \"" + asset + "\" is out of pack bounds.", HalleyExceptions::Resources);
+		}
+
+		// Points straight into the mapping, which it keeps alive
+		const auto* start = reinterpret_cast<const char*>(mappedData.data() + pos);
+		return std::make_unique<ResourceDataStatic>(std::shared_ptr<const char>(mappedFile, start), size, path);
 	} else {
 		if (hasReader) {
 			auto result = new char[size];
@@ -161,6 +216,13 @@ std::unique_ptr<ResourceData> AssetPack::getData(const String& asset, AssetType
 
 void AssetPack::readToMemory()
 {
+	if (mappedFile) {
+		data = Bytes(reinterpret_cast<const Byte*>(mappedData.data()), reinterpret_cast<const Byte*>(mappedData.data()) + mappedData.size());
+		mappedData = {};
+		mappedFile.reset();
+		return;
+	}
+
 	std::unique_lock<std::mutex> lock(readerMutex);
 	reader->seek(dataOffset, SEEK_SET);
 	data = reader->readAll();
@@ -188,6 +250,14 @@ void AssetPack::decrypt(const String& key)
 
 void AssetPack::readData(size_t pos, gsl::span<gsl::byte> dst)
 {
+	if (mappedFile) {
+		if (pos + size_t(dst.size()) > size_t(mappedData.size())) {
+			throw Exception("Asset data is out of pack bounds.", HalleyExceptions::Resources);
+		}
+		memcpy(dst.data(), mappedData.data() + pos, dst.size());
+		return;
+	}
+
 	if (hasReader) {
 		std::unique_lock<std::mutex> lock(readerMutex);
 		if (reader) {
@@ -204,6 +274,11 @@ void AssetPack::readData(size_t pos, gsl::span<gsl::byte> dst)
 	memcpy(dst.data(), data.data() + pos, dst.size());
 }
 
+bool AssetPack::isMemoryMapped() const
+{
+	return !!mappedFile;
+}
+
 std::unique_ptr<ResourceDataReader> AssetPack::extractReader()
 {
 	std::unique_lock<std::mutex> lock(readerMutex);
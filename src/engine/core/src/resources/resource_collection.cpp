@@ -71,6 +71,40 @@ std::shared_ptr<Resource> ResourceCollectionBase::getUntyped(std::string_view na
 	return doGet(name, priority, true);
 }
 
+std::shared_ptr<ResourceRequest> ResourceCollectionBase::getAsyncUntyped(std::string_view assetId, ResourceLoadPriority priority)
+{
+	{
+		std::shared_lock lock(mutex);
+		const auto res = resources.find(assetId);
+		if (res != resources.end()) {
+			return std::make_shared<ResourceRequest>(res->second.res);
+		}
+	}
+
+	std::unique_lock lockWrite(mutex);
+	const auto res = resources.find(assetId);
+	if (res != resources.end()) {
+		return std::make_shared<ResourceRequest>(res->second.res);
+	}
+
+	// Already on its way, join that request instead
+	const auto iter = streaming.find(assetId);
+	if (iter != streaming.end()) {
+		if (auto request = iter->second.lock()) {
+			lockWrite.unlock();
+			parent.streamer->raisePriority(request, priority);
+			return request;
+		}
+	}
+
+	auto request = std::make_shared<ResourceRequest>(*this, String(assetId), priority);
+	streaming[String(assetId)] = request;
+	lockWrite.unlock();
+
+	parent.streamer->enqueue(request);
+	return request;
+}
+
 Vector<String> ResourceCollectionBase::enumerate() const
 {
 	if (resourceEnumerator) {
@@ -185,7 +219,7 @@ namespace {
 }
 #endif
 
-std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback)
+std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback, std::unique_ptr<ResourceDataStatic> prefetched)
 {
 #ifdef _WIN32
 	//assert(!isRunningFromDLL());
@@ -198,7 +232,8 @@ std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std
 		newRes = resourceLoader(assetId, priority);
 	} else {
 		// Normal loading
-		auto resLoader = ResourceLoader(*(parent.locator), assetId, type, priority, parent.api, parent);		
+		auto resLoader = ResourceLoader(*(parent.locator), assetId, type, priority, parent.api, parent);
+		resLoader.prefetched = std::move(prefetched);
 		newRes = loadResource(resLoader);
 		if (newRes) {
 			newRes->setMeta(resLoader.getMeta());
@@ -219,6 +254,55 @@ std::pair<std::shared_ptr<Resource>, bool> ResourceCollectionBase::loadAsset(std
 	return std::make_pair(newRes, true);
 }
 
+std::unique_ptr<ResourceDataStatic> ResourceCollectionBase::prefetchAsset(std::string_view assetId)
+{
+	// Overriding loaders and streamed assets read their own data
+	if (resourceLoader || type == AssetType::BinaryFile) {
+		return {};
+	}
+
+	auto resLoader = ResourceLoader(*(parent.locator), assetId, type, ResourceLoadPriority::Normal, parent.api, parent);
+	if (resLoader.metadata && resLoader.metadata->getBool("streaming", false)) {
+		return {};
+	}
+	return resLoader.getStatic(false);
+}
+
+std::shared_ptr<Resource> ResourceCollectionBase::finishStreaming(std::string_view assetId, std::shared_ptr<Resource> resource, bool cache)
+{
+	std::unique_lock lockWrite(mutex);
+	streaming.erase(assetId);
+	if (!cache) {
+		return resource;
+	}
+
+	// Someone might have loaded it synchronously in the meantime
+	const auto res = resources.find(assetId);
+	if (res != resources.end()) {
+		return res->second.res;
+	}
+
+	resource->setAssetId(assetId);
+	resources.emplace(assetId, Wrapper(resource, 0));
+	lockWrite.unlock();
+	resource->onLoaded(parent);
+
+	return resource;
+}
+
+void ResourceCollectionBase::abandonStreaming(std::string_view assetId, const ResourceRequest* request)
+{
+	// Only if nobody has started a new request for the same asset since
+	std::unique_lock lockWrite(mutex);
+	const auto iter = streaming.find(assetId);
+	if (iter != streaming.end()) {
+		const auto current = iter->second.lock();
+		if (!current || current.get() == request) {
+			streaming.erase(iter);
+		}
+	}
+}
+
 std::shared_ptr<Resource> ResourceCollectionBase::doGet(std::string_view assetId, ResourceLoadPriority priority, bool allowFallback)
 {
 	// Look in cache and return if it's there
@@ -2,6 +2,7 @@
 #include <utility>
 #include "resources/asset_pack.h"
 #include "api/system_api.h"
+#include "halley/file/memory_mapped_file.h"
 using namespace Halley;
 
 PackResourceLocator::PackResourceLocator(std::unique_ptr<ResourceDataReader> reader, Path path, String key, bool preLoad, std::optional<int> priority)
@@ -10,7 +11,7 @@ PackResourceLocator::PackResourceLocator(std::unique_ptr<ResourceDataReader> rea
 	, preLoad(preLoad)
 	, priority(priority)
 {
-	assetPack = std::make_unique<AssetPack>(std::move(reader), encryptionKey, preLoad);
+	open(std::move(reader));
 }
 
 PackResourceLocator::~PackResourceLocator()
@@ -41,7 +42,23 @@ void PackResourceLocator::purge(SystemAPI& sys)
 
 void PackResourceLocator::loadAfterPurge()
 {
-	assetPack = std::make_unique<AssetPack>(system->getDataReader(path.string()), encryptionKey, preLoad);
+	open({});
+}
+
+void PackResourceLocator::open(std::unique_ptr<ResourceDataReader> reader)
+{
+	// Map the pack if it's on the native filesystem, unless it was explicitly asked to be loaded into memory
+	if (!preLoad) {
+		if (auto file = MemoryMappedFile::open(path)) {
+			assetPack = std::make_unique<AssetPack>(std::move(file), encryptionKey);
+			return;
+		}
+	}
+
+	if (!reader) {
+		reader = system->getDataReader(path.string());
+	}
+	assetPack = std::make_unique<AssetPack>(std::move(reader), encryptionKey, preLoad);
 }
 
 int PackResourceLocator::getPriority() const
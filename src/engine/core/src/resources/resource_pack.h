@@ -20,6 +20,7 @@ namespace Halley {
 		
 	private:
 		void loadAfterPurge();
+		void open(std::unique_ptr<ResourceDataReader> reader);
 
 		std::unique_ptr<AssetPack> assetPack;
 
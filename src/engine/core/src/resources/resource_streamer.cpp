@@ -0,0 +1,285 @@
+#include "resources/resource_streamer.h"
+#include "resources/resource_collection.h"
+#include <halley/concurrency/concurrent.h>
+#include <halley/resources/resource.h>
+#include <halley/support/logger.h>
+#include <halley/time/stopwatch.h>
+#include <halley/utils/scoped_guard.h>
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+using namespace Halley;
+
+ResourceRequest::ResourceRequest(ResourceCollectionBase& collection, String assetId, ResourceLoadPriority priority)
+	: collection(&collection)
+	, assetId(std::move(assetId))
+	, priority(priority)
+	, state(State::Queued)
+{
+}
+
+ResourceRequest::ResourceRequest(std::shared_ptr<Resource> loaded)
+	: assetId(loaded->getAssetId())
+	, priority(ResourceLoadPriority::Normal)
+	, state(State::Loaded)
+	, resource(std::move(loaded))
+{
+}
+
+const String& ResourceRequest::getAssetId() const
+{
+	return assetId;
+}
+
+ResourceLoadPriority ResourceRequest::getPriority() const
+{
+	return priority;
+}
+
+ResourceRequest::State ResourceRequest::getState() const
+{
+	return state;
+}
+
+bool ResourceRequest::isDone() const
+{
+	const auto s = getState();
+	return s == State::Loaded || s == State::Failed;
+}
+
+std::shared_ptr<Resource> ResourceRequest::getResource() const
+{
+	return getState() == State::Loaded ? resource : std::shared_ptr<Resource>();
+}
+
+ResourceStreamer::PendingRequest::PendingRequest(const std::shared_ptr<ResourceRequest>& request)
+	: request(request)
+	, collection(request->collection)
+	, assetId(request->assetId)
+{
+}
+
+bool ResourceStreamer::QueueEntry::operator<(const QueueEntry& other) const
+{
+	// Heap order: highest priority first, then oldest first
+	if (priority != other.priority) {
+		return priority < other.priority;
+	}
+	return sequence > other.sequence;
+}
+
+ResourceStreamer::ResourceStreamer()
+	: state(std::make_shared<SharedState>())
+{
+	state->pending = 0;
+	state->running = 0;
+	state->aborted = false;
+}
+
+ResourceStreamer::~ResourceStreamer()
+{
+	// Tasks already queued on executors will see this and bail, but the ones currently running touch collections, so wait for them
+	state->aborted = true;
+	while (state->running > 0) {
+		std::this_thread::yield();
+	}
+}
+
+void ResourceStreamer::enqueue(const std::shared_ptr<ResourceRequest>& request)
+{
+	++state->pending;
+	push(request, request->getPriority());
+}
+
+void ResourceStreamer::raisePriority(const std::shared_ptr<ResourceRequest>& request, ResourceLoadPriority priority)
+{
+	if (priority <= request->getPriority()) {
+		return;
+	}
+	request->priority = priority;
+
+	std::unique_lock lock(state->mutex);
+	for (auto& entry: state->queue) {
+		if (entry.pending.request.lock() == request) {
+			entry.priority = priority;
+			std::make_heap(state->queue.begin(), state->queue.end());
+			break;
+		}
+	}
+}
+
+void ResourceStreamer::push(std::shared_ptr<ResourceRequest> request, ResourceLoadPriority priority)
+{
+	{
+		std::unique_lock lock(state->mutex);
+		state->queue.push_back(QueueEntry{ priority, state->nextSequence++, PendingRequest(request) });
+		std::push_heap(state->queue.begin(), state->queue.end());
+	}
+
+	// Each task reads whatever is at the top of the queue when the disk is free, not necessarily this request
+	Concurrent::execute(Executors::getDiskIO(), [s = state] ()
+	{
+		readNext(s);
+	});
+}
+
+void ResourceStreamer::readNext(const std::shared_ptr<SharedState>& state)
+{
+	++state->running;
+	auto guard = ScopedGuard([&] () { --state->running; });
+	if (state->aborted) {
+		return;
+	}
+
+	std::optional<PendingRequest> pending;
+	{
+		std::unique_lock lock(state->mutex);
+		if (state->queue.empty()) {
+			return;
+		}
+		std::pop_heap(state->queue.begin(), state->queue.end());
+		pending = std::move(state->queue.back().pending);
+		state->queue.pop_back();
+	}
+
+	auto request = pending->request.lock();
+	if (!request) {
+		// Cancelled before it got to the disk
+		cancel(*state, *pending);
+		return;
+	}
+
+	request->state = ResourceRequest::State::Reading;
+	try {
+		request->data = request->collection->prefetchAsset(request->assetId);
+	} catch (...) {
+		// Let the decoder try again and report the error
+		request->data.reset();
+	}
+	request->state = ResourceRequest::State::Decoding;
+
+	if (canDecodeOnWorker(request->collection->getAssetType())) {
+		Concurrent::execute(Executors::getCPU(), [s = state, pending = PendingRequest(request)] ()
+		{
+			++s->running;
+			auto guard = ScopedGuard([&] () { --s->running; });
+			if (s->aborted) {
+				return;
+			}
+
+			if (auto request = pending.request.lock()) {
+				decode(*s, request);
+				if (request->getState() != ResourceRequest::State::Failed) {
+					std::unique_lock lock(s->mutex);
+					s->toFinish.push_back(pending);
+				}
+			} else {
+				cancel(*s, pending);
+			}
+		});
+	} else {
+		std::unique_lock lock(state->mutex);
+		state->toDecode.push_back(PendingRequest(request));
+	}
+}
+
+void ResourceStreamer::decode(SharedState& state, const std::shared_ptr<ResourceRequest>& request)
+{
+	try {
+		auto [resource, loaded] = request->collection->loadAsset(request->assetId, request->getPriority(), true, std::move(request->data));
+		request->resource = std::move(resource);
+		request->fallback = !loaded;
+	} catch (std::exception& e) {
+		Logger::logException(e);
+		request->state = ResourceRequest::State::Failed;
+	} catch (...) {
+		Logger::logError("Unknown error while streaming " + request->assetId);
+		request->state = ResourceRequest::State::Failed;
+	}
+
+	if (request->getState() == ResourceRequest::State::Failed) {
+		// So that asking for it again retries, rather than handing back this failed request
+		request->collection->abandonStreaming(request->assetId, request.get());
+		--state.pending;
+	}
+}
+
+void ResourceStreamer::finish(SharedState& state, const std::shared_ptr<ResourceRequest>& request)
+{
+	request->resource = request->collection->finishStreaming(request->assetId, std::move(request->resource), !request->fallback);
+	request->state = ResourceRequest::State::Loaded;
+	--state.pending;
+}
+
+void ResourceStreamer::update(Time maxTime)
+{
+	Stopwatch timer;
+
+	do {
+		std::optional<PendingRequest> next;
+		bool needsDecode = false;
+		{
+			std::unique_lock lock(state->mutex);
+			if (!state->toFinish.empty()) {
+				next = std::move(state->toFinish.front());
+				state->toFinish.pop_front();
+			} else if (!state->toDecode.empty()) {
+				next = std::move(state->toDecode.front());
+				state->toDecode.pop_front();
+				needsDecode = true;
+			} else {
+				break;
+			}
+		}
+
+		auto request = next->request.lock();
+		if (!request) {
+			cancel(*state, *next);
+			continue;
+		}
+
+		if (needsDecode) {
+			decode(*state, request);
+		}
+		if (request->getState() != ResourceRequest::State::Failed) {
+			finish(*state, request);
+		}
+	} while (timer.elapsedSeconds() < maxTime);
+}
+
+void ResourceStreamer::cancel(SharedState& state, const PendingRequest& pending)
+{
+	pending.collection->abandonStreaming(pending.assetId, nullptr);
+	--state.pending;
+}
+
+size_t ResourceStreamer::getPendingCount() const
+{
+	return static_cast<size_t>(std::max(0, state->pending.load()));
+}
+
+bool ResourceStreamer::canDecodeOnWorker(AssetType type)
+{
+	// Types whose loaders don't create video resources, so they're safe to construct off the main thread
+	switch (type) {
+	case AssetType::BinaryFile:
+	case AssetType::TextFile:
+	case AssetType::ConfigFile:
+	case AssetType::GameProperties:
+	case AssetType::Shader:
+	case AssetType::Image:
+	case AssetType::AudioClip:
+	case AssetType::AudioObject:
+	case AssetType::AudioEvent:
+	case AssetType::VariableTable:
+	case AssetType::ScriptGraph:
+	case AssetType::NavmeshSet:
+	case AssetType::Prefab:
+	case AssetType::Scene:
+	case AssetType::UIDefinition:
+		return true;
+	default:
+		return false;
+	}
+}
@@ -9,6 +9,7 @@ Resources::Resources(std::unique_ptr<ResourceLocator> locator, const HalleyAPI&
 	: locator(std::move(locator))
 	, api(&api)
 	, options(options)
+	, streamer(std::make_unique<ResourceStreamer>())
 {
 }
 
@@ -39,7 +40,7 @@ void Resources::reloadAssets(const std::map<AssetType, Vector<String>>& byType)
 {
 	// Purge assets first, to force re-loading of any affected packs
 	for (auto& curType: byType) {
-		if (curType.first == AssetType::AudioClip) {
+		if (curType.first == AssetType::AudioClip && api->audio) {
 			api->audio->pausePlayback();
 		}
 
@@ -57,7 +58,7 @@ void Resources::reloadAssets(const std::map<AssetType, Vector<String>>& byType)
 			resources.reload(asset);
 		}
 
-		if (curType.first == AssetType::AudioClip) {
+		if (curType.first == AssetType::AudioClip && api->audio) {
 			api->audio->resumePlayback();
 		}
 	}
@@ -76,4 +77,14 @@ void Resources::generateMemoryReport()
 	}	
 }
 
+void Resources::update()
+{
+	streamer->update();
+}
+
+ResourceStreamer& Resources::getStreamer() const
+{
+	return *streamer;
+}
+
 Resources::~Resources() = default;
@@ -7,8 +7,17 @@ namespace Halley {
 
     	virtual const char* getName() const = 0;
     	virtual ConfigNode serialize(const EntitySerializationContext& context, const Component& component) const = 0;
+
+    	// Fields flagged as "replicated" in the component schema, encoded straight from component memory
+    	virtual size_t getReplicatedFieldCount() const { return 0; }
+    	virtual void serializeReplicatedField(Serializer&, const Component&, size_t) const {}
+    	virtual void deserializeReplicatedField(Deserializer&, Component&, size_t) const {}
     };
 
+	namespace Detail {
+		template <class T> using ReplicatedFieldCountMember = decltype(T::replicatedFieldCount);
+	}
+
 	template <typename T>
 	class ComponentReflectorImpl : public ComponentReflector {
 	public:
@@ -21,5 +30,28 @@ namespace Halley {
 		{
 			return static_cast<const T&>(component).serialize(context);
 		}
+
+		size_t getReplicatedFieldCount() const override
+		{
+			if constexpr (is_detected_v<Detail::ReplicatedFieldCountMember, T>) {
+				return T::replicatedFieldCount;
+			} else {
+				return 0;
+			}
+		}
+
+		void serializeReplicatedField(Serializer& s, const Component& component, size_t field) const override
+		{
+			if constexpr (is_detected_v<Detail::ReplicatedFieldCountMember, T>) {
+				static_cast<const T&>(component).serializeReplicatedField(s, field);
+			}
+		}
+
+		void deserializeReplicatedField(Deserializer& s, Component& component, size_t field) const override
+		{
+			if constexpr (is_detected_v<Detail::ReplicatedFieldCountMember, T>) {
+				static_cast<T&>(component).deserializeReplicatedField(s, field);
+			}
+		}
 	};
 }
@@ -123,7 +123,7 @@ namespace Halley {
 			return enabled;
 		}
 
-		void setEnabled(bool enabled);
+		void setEnabled(World& world, bool enabled);
 		
 		const UUID& getPrefabUUID() const
 		{
@@ -139,7 +139,7 @@ namespace Halley {
 		EntityId getEntityId() const;
 
 		void refresh(MaskStorage& storage, ComponentDeleterTable& table);
-		void destroy();
+		void destroy(World& world);
 		
 		void sortChildrenByInstanceUUIDs(const Vector<UUID>& uuids);
 
@@ -183,6 +183,7 @@ namespace Halley {
 		std::shared_ptr<const Prefab> prefab;
 
 		uint8_t hierarchyRevision = 0;
+		uint32_t worldIndex = 0; // Index in World::entities, only needed when removing
 
 		Entity();
 		void destroyComponents(ComponentDeleterTable& storage);
@@ -217,19 +218,19 @@ namespace Halley {
 		ComponentDeleterTable& getComponentDeleterTable(World& world);
 
 		Entity* getParent() const { return parent; }
-		void setParent(Entity* parent, bool propagate = true, size_t childIdx = -1);
+		void setParent(World& world, Entity* parent, bool propagate = true, size_t childIdx = -1);
 		const Vector<Entity*>& getChildren() const { return children; }
-		void addChild(Entity& child);
-		void detachChildren();
+		void addChild(World& world, Entity& child);
+		void detachChildren(World& world);
 		void markHierarchyDirty();
 		void propagateChildrenChange();
 		void propagateChildWorldPartition(uint8_t newWorldPartition);
-		void propagateEnabled(bool enabled, bool parentEnabled);
+		void propagateEnabled(World& world, bool enabled, bool parentEnabled);
 
 		DataInterpolatorSet& setupNetwork(EntityRef& ref, uint8_t peerId);
 		std::optional<uint8_t> getOwnerPeerId() const;
 
-		void doDestroy(bool updateParenting);
+		void doDestroy(World& world, bool updateParenting);
 
 		bool hasBit(const World& world, int index) const;
 	};
@@ -590,13 +591,13 @@ namespace Halley {
 		void setParent(EntityRef& parent, size_t childIdx = -1)
 		{
 			validate();
-			entity->setParent(parent.entity, true, childIdx);
+			entity->setParent(*world, parent.entity, true, childIdx);
 		}
 
 		void setParent()
 		{
 			validate();
-			entity->setParent(nullptr);
+			entity->setParent(*world, nullptr);
 		}
 
 		const Vector<Entity*>& getRawChildren() const
@@ -633,13 +634,13 @@ namespace Halley {
 		void addChild(EntityRef& child)
 		{
 			validate();
-			entity->addChild(*child.entity);
+			entity->addChild(*world, *child.entity);
 		}
 
 		void detachChildren()
 		{
 			validate();
-			entity->detachChildren();
+			entity->detachChildren(*world);
 		}
 
 		uint8_t getHierarchyRevision() const
@@ -692,7 +693,7 @@ namespace Halley {
 		void setEnabled(bool enabled)
 		{
 			validate();
-			entity->setEnabled(enabled);
+			entity->setEnabled(*world, enabled);
 		}
 
 		bool operator==(const EntityRef& other) const
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <memory>
+#include <limits>
 #include <gsl/gsl_assert>
 #include "family_type.h"
 #include "family_mask.h"
@@ -14,6 +16,26 @@ namespace Halley {
 	class Entity;
 	class FamilyBindingBase;
 
+	// Maps entity ids to their slot in a family (sparse set style)
+	// Paged, so that families with few entities spread over a large id range don't pay for the whole range
+	class FamilySlotIndex {
+	public:
+		constexpr static uint32_t invalidSlot = std::numeric_limits<uint32_t>::max();
+
+		uint32_t get(EntityId id) const;
+		void set(EntityId id, size_t slot);
+		void erase(EntityId id);
+		void clear();
+
+	private:
+		constexpr static size_t pageSize = 1024;
+		using Page = std::array<uint32_t, pageSize>;
+
+		Vector<std::unique_ptr<Page>> pages;
+
+		static size_t getIndex(EntityId id);
+	};
+
 	class Family {
 		friend class World;
 
@@ -31,6 +53,8 @@ namespace Halley {
 			return static_cast<char*>(elems) + (n * elemSize);
 		}
 
+		void* tryFindElement(EntityId id) const;
+
 		void addOnEntitiesAdded(FamilyBindingBase* bind);
 		void removeOnEntityAdded(FamilyBindingBase* bind);
 		void addOnEntitiesRemoved(FamilyBindingBase* bind);
@@ -55,6 +79,7 @@ namespace Halley {
 		size_t elemSize = 0;
 		Vector<EntityId> toRemove;
 		Vector<EntityId> toReload;
+		FamilySlotIndex slotIndex;
 
 		Vector<FamilyBindingBase*> addEntityCallbacks;
 		Vector<FamilyBindingBase*> removeEntityCallbacks;
@@ -119,17 +144,18 @@ namespace Halley {
 			auto& e = entities.emplace_back();
 			e.entityId = entity.getEntityId();
 			T::Type::loadComponents(entity, &e.data[0]);
+			slotIndex.set(e.entityId, entities.size() - 1);
 
 			dirty = true;
 		}
 		
 		void refreshEntity(Entity& entity) override
 		{
-			for (auto& e: entities) {
-				if (e.entityId == entity.getEntityId()) {
-					T::Type::loadComponents(entity, &e.data[0]);
-					break;
-				}
+			const auto slot = slotIndex.get(entity.getEntityId());
+			if (slot != FamilySlotIndex::invalidSlot) {
+				auto& e = entities[slot];
+				Expects(e.entityId == entity.getEntityId());
+				T::Type::loadComponents(entity, &e.data[0]);
 			}
 		}
 
@@ -153,9 +179,11 @@ namespace Halley {
 				// Notify reloads
 				HALLEY_DEBUG_TRACE();
 				Vector<StorageType*> reloadedEntities;
-				for (auto& entity : entities) {
-					if (std::find(toReload.begin(), toReload.end(), entity.entityId) != toReload.end()) {
-						reloadedEntities.push_back(&entity);
+				reloadedEntities.reserve(toReload.size());
+				for (const auto& id: toReload) {
+					const auto slot = slotIndex.get(id);
+					if (slot != FamilySlotIndex::invalidSlot) {
+						reloadedEntities.push_back(&entities[slot]);
 					}
 				}
 				notifyReload(reloadedEntities.data(), reloadedEntities.size());
@@ -170,6 +198,7 @@ namespace Halley {
 		{
 			notifyRemove(entities.data(), entities.size());
 			entities.clear();
+			slotIndex.clear();
 			updateElems();
 		}
 
@@ -187,43 +216,31 @@ namespace Halley {
 		void removeDeadEntities()
 		{
 			// Performance-critical code
-			// Benchmarks suggest that using a Vector is faster than std::set and std::unordered_set
 			if (!toRemove.empty()) {
 				HALLEY_DEBUG_TRACE();
-				size_t removeCount = toRemove.size();
-				Expects(removeCount > 0);
+				const size_t removeCount = toRemove.size();
 				Expects(removeCount <= entities.size());
-				std::sort(toRemove.begin(), toRemove.end());
 
-				for (size_t i = 1; i < toRemove.size(); ++i) {
-					Expects(toRemove[i - 1] != toRemove[i]);
-				}
-
-				// Move all entities to be removed to the back of the vector
+				// Move all entities to be removed to the back of the vector, swapping each one with the last living entity
 				{
-					int n = int(entities.size());
-					// Note: it's important to scan it forward. Scanning backwards would improve performance for short-lived entities,
-					// but it causes an issue where an entity is removed and added to the same family in one frame.
-					for (int i = 0; i < n; i++) {
-						EntityId id = entities[i].entityId;
-						auto iter = std::lower_bound(toRemove.begin(), toRemove.end(), id);
-						if (iter != toRemove.end() && id == *iter) {
-							toRemove.erase(iter);
-							if (i != n - 1) {
-								std::swap(entities[i], entities[n - 1]);
-								i--;
-							}
-							n--;
-							if (toRemove.empty()) {
-								break;
-							}
+					size_t n = entities.size();
+					for (const auto& id: toRemove) {
+						const auto slot = slotIndex.get(id);
+						Expects(slot != FamilySlotIndex::invalidSlot);
+						Expects(slot < n);
+						Expects(entities[slot].entityId == id);
+
+						--n;
+						if (slot != n) {
+							std::swap(entities[slot], entities[n]);
+							slotIndex.set(entities[slot].entityId, slot);
 						}
+						slotIndex.erase(id);
 					}
-					Ensures(size_t(n) + removeCount == entities.size());
+					toRemove.clear();
+					Ensures(n + removeCount == entities.size());
 				}
 
-				Expects(toRemove.empty());
-
 				// Notify removal
 				size_t newSize = entities.size() - removeCount;
 				Ensures(newSize < entities.size());
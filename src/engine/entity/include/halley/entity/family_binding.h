@@ -22,6 +22,7 @@ namespace Halley {
 		void doInit(FamilyMaskType readMask, FamilyMaskType writeMask) noexcept;
 		
 		void* getElement(size_t index) const noexcept { return family->getElement(index); }
+		void* tryFindElement(EntityId id) const noexcept { return family->tryFindElement(id); }
 		void setFamily(Family* family) noexcept;
 
 		void setOnEntitiesAdded(std::function<void(void*, size_t)> callback);
@@ -147,22 +148,12 @@ namespace Halley {
 
 		T* tryFind(EntityId id)
 		{
-			for (auto& e: *this) {
-				if (e.entityId == id) {
-					return &e;
-				}
-			}
-			return nullptr;
+			return reinterpret_cast<T*>(tryFindElement(id));
 		}
 
 		const T* tryFind(EntityId id) const
 		{
-			for (auto& e: *this) {
-				if (e.entityId == id) {
-					return &e;
-				}
-			}
-			return nullptr;
+			return reinterpret_cast<const T*>(tryFindElement(id));
 		}
 
 		T& find(EntityId id)
@@ -25,6 +25,7 @@ namespace Halley {
 			constexpr bool operator==(const Handle& h) const { return value == h.value; }
 			constexpr bool operator!=(const Handle& h) const { return value != h.value; }
 			constexpr bool operator<(const Handle& h) const { return value < h.value; }
+			size_t getHash() const { return std::hash<int>()(value); }
 
 			const RealType& getRealValue(MaskStorage& storage) const;
 			
@@ -98,13 +99,19 @@ namespace Halley {
 			}
 		};
 
+		template <typename T>
+		struct IsConstComponent : std::is_const<T> {};
+
+		template <typename T>
+		struct IsConstComponent<MaybeRef<T>> : std::is_const<T> {};
+
 		template <typename T, typename... Ts>
 		struct MutableEvaluator <T, Ts...> {
 			constexpr static void makeMask(RealType& mask) {
-				if constexpr (!std::is_const<T>::value) {
+				if constexpr (!IsConstComponent<T>::value) {
 					FamilyMask::setBit(mask, RetrieveComponentIndex<T>::componentIndex);
 				}
-				Evaluator<Ts...>::makeMask(mask);
+				MutableEvaluator<Ts...>::makeMask(mask);
 			}
 
 			constexpr static HandleType getMask(MaskStorage& storage) {
@@ -185,3 +192,14 @@ namespace Halley {
 
 	using FamilyMaskType = FamilyMask::HandleType;
 }
+
+namespace std {
+	template<>
+	struct hash<Halley::FamilyMask::Handle>
+	{
+		size_t operator()(const Halley::FamilyMask::Handle& v) const noexcept
+		{
+			return v.getHash();
+		}
+	};
+}
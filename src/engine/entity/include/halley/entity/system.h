@@ -3,6 +3,7 @@
 #include <halley/data_structures/vector.h>
 #include <halley/concurrency/concurrent.h>
 #include <initializer_list>
+#include <variant>
 
 #include "family_binding.h"
 #include "family_mask.h"
@@ -40,12 +41,42 @@ namespace Halley {
 		System* system = nullptr;
 	};
 	
+	// Messages and structural changes requested while entities are being updated in parallel.
+	// Each chunk of a parallel update records into its own buffer, and buffers are replayed on the update thread in chunk order, so the result doesn't depend on which thread ran what.
+	class SystemCommandBuffer
+	{
+	public:
+		void sendMessage(EntityId target, std::unique_ptr<Message> msg, int msgId);
+		void sendSystemMessage(SystemMessageContext context, const String& targetSystem, SystemMessageDestination destination);
+		void addCommand(std::function<void(World&)> command);
+
+		bool empty() const;
+		void clear();
+
+	private:
+		friend class System;
+
+		struct EntityMessageCommand {
+			EntityId target;
+			std::unique_ptr<Message> msg;
+			int msgId;
+		};
+
+		struct SystemMessageCommand {
+			SystemMessageContext context;
+			String targetSystem;
+			SystemMessageDestination destination;
+		};
+
+		Vector<std::variant<EntityMessageCommand, SystemMessageCommand, std::function<void(World&)>>> commands;
+	};
+
 	class System
 	{
 		friend class SystemMessageBridge;
 		
 	public:
-		System(Vector<FamilyBindingBase*> families, Vector<int> messageTypesReceived);
+		System(Vector<FamilyBindingBase*> families, Vector<int> messageTypesReceived, bool concurrent = false);
 		virtual ~System() {}
 
 		const String& getName() const { return name; }
@@ -53,6 +84,10 @@ namespace Halley {
 		size_t getEntityCount() const;
 		bool tryInit();
 
+		// Concurrent systems only touch the components declared in their families, so they can be updated alongside any other system that doesn't write to what they read (or vice-versa)
+		bool canUpdateConcurrently() const { return concurrent; }
+		bool hasAccessConflictWith(const System& other) const;
+
 		virtual bool canHandleSystemMessage(int messageId, const String& targetSystem) const { return false; }
 		void receiveSystemMessage(const SystemMessageContext& context);
 		void prepareSystemMessages();
@@ -89,13 +124,19 @@ namespace Halley {
 		}
 
 		template <typename F, typename V>
-		static void invokeParallel(F&& f, V& fam)
+		void invokeParallel(F&& f, V& fam)
 		{
-			Concurrent::foreach(std::begin(fam), std::end(fam), [&] (auto& e) {
-				f(e);
+			doInvokeParallel(fam.size(), [&] (size_t start, size_t end) {
+				for (size_t i = start; i < end; ++i) {
+					f(fam[i]);
+				}
 			});
 		}
 
+		// Runs command on the update thread. When called from inside a parallel update, it's deferred until every entity has been updated.
+		// Use this to spawn or destroy entities, or to touch anything else on the World, from a parallel system.
+		void deferCommand(std::function<void(World&)> command);
+
 		template <typename T>
 		void sendMessageGeneric(EntityId entityId, T msg)
 		{
@@ -194,6 +235,7 @@ namespace Halley {
 		Vector<std::pair<EntityId, MessageEntry>> outbox;
 		Vector<const SystemMessageContext*> systemMessageInbox;
 		Vector<const SystemMessageContext*> systemMessages;
+		Vector<SystemCommandBuffer> commandBuffers;
 
 		World* world = nullptr;
 		const HalleyAPI* api = nullptr;
@@ -201,6 +243,10 @@ namespace Halley {
 		String name;
 		int systemId = -1;
 		bool initialised = false;
+		bool concurrent = false;
+
+		FamilyMask::RealType componentsRead;
+		FamilyMask::RealType componentsWritten;
 
 		void doUpdate(Time time);
 		void doRender(RenderContext& rc);
@@ -210,6 +256,11 @@ namespace Halley {
 		void doSendMessage(EntityId target, std::unique_ptr<Message> msg, int msgId);
 		size_t doSendSystemMessage(SystemMessageContext context, const String& targetSystem, SystemMessageDestination destination);
 		void dispatchMessages();
+
+		void doInvokeParallel(size_t count, const std::function<void(size_t, size_t)>& f);
+		void runCommands(SystemCommandBuffer& buffer);
+
+		static thread_local SystemCommandBuffer* currentCommandBuffer;
 	};
 
 }
@@ -50,6 +50,12 @@ namespace Halley {
 		CreateSystemFunction createSystem;
 	};
 
+	enum class SystemScheduling {
+		Deterministic, // Every system runs on the update thread, in timeline order, and so do the entities of parallel systems. Use for debugging or lockstep.
+		Sequential, // Systems run one at a time, in timeline order; parallel systems spread their entities across the CPU executors
+		Parallel // Consecutive concurrent systems with no conflicting component access run simultaneously on the CPU executors
+	};
+
 	class World
 	{
 	public:
@@ -119,9 +125,9 @@ namespace Halley {
 
 		void spawnPending(); // Warning: use with care, will invalidate entities
 
-		void onEntityDirty();
+		void onEntityDirty(Entity& entity);
 
-		void setEntityReloaded();
+		void setEntityReloaded(Entity& entity);
 
 		template <typename T>
 		Family& getFamily() noexcept
@@ -161,18 +167,23 @@ namespace Halley {
 		void setEditor(bool isEditor);
 		bool isEditor() const;
 
+		void setSystemScheduling(SystemScheduling scheduling);
+		SystemScheduling getSystemScheduling() const;
+
 	private:
 		const HalleyAPI& api;
 		Resources& resources;
 		std::array<Vector<std::unique_ptr<System>>, static_cast<int>(TimeLine::NUMBER_OF_TIMELINES)> systems;
 		WorldReflection reflection;
 		bool entityDirty = false;
-		bool entityReloaded = false;
 		bool editor = false;
 		bool devMode = false;
+		SystemScheduling systemScheduling = SystemScheduling::Sequential;
 		
 		Vector<Entity*> entities;
 		Vector<Entity*> entitiesPendingCreation;
+		Vector<Entity*> dirtyEntities;
+		Vector<Entity*> reloadedEntities;
 		MappedPool<Entity*> entityMap;
 		HashMap<UUID, Entity*> uuidMap;
 
@@ -199,6 +210,8 @@ namespace Halley {
 		void deleteEntity(Entity* entity);
 
 		void updateSystems(TimeLine timeline, Time elapsed);
+		void updateSystemsParallel(TimeLine timeline, Time elapsed);
+		void updateSystemBatch(gsl::span<const std::unique_ptr<System>> batch, Time elapsed);
 		void renderSystems(RenderContext& rc) const;
 
 		NOINLINE Family& addFamily(std::unique_ptr<Family> family) noexcept;
@@ -269,7 +269,13 @@ void PerformanceStatsView::drawHeader(Painter& painter, bool simple)
 	strBuilder.append(toString(maxFPS, 10, 4, ' '), (updateAvgTime > renderAvgTime && updateAvgTime > gpuAvgTime) ? updateCol : (renderAvgTime > gpuAvgTime ? renderCol : gpuCol));
 	strBuilder.append(" FPS | ");
 	strBuilder.append(toString(painter.getPrevDrawCalls()));
-	strBuilder.append(" calls | ");
+	if (painter.getPrevBatchesSaved() > 0) {
+		strBuilder.append(" calls (");
+		strBuilder.append(toString(painter.getPrevBatchesSaved()));
+		strBuilder.append(" saved) | ");
+	} else {
+		strBuilder.append(" calls | ");
+	}
 	strBuilder.append(toString(painter.getPrevTriangles()));
 	strBuilder.append(" tris\n");
 	strBuilder.append(formatTime(updateAvgTime), updateCol);
@@ -289,6 +295,10 @@ void PerformanceStatsView::drawHeader(Painter& painter, bool simple)
 		strBuilder.append(" (");
 		strBuilder.append(toString(networkStats->getReceivedPacketsPerSecond()));
 		strBuilder.append(")");
+		if (const auto utilisation = networkStats->getBandwidthBudgetUtilisation()) {
+			strBuilder.append(" | budget: ");
+			strBuilder.append(toString(lroundl(*utilisation * 100)) + "%");
+		}
 	}
 
 	if (!simple) {
@@ -718,9 +728,14 @@ void PerformanceStatsView::drawNetworkStats(Painter& painter, Rect4f rect)
 		const Rect4f totalArea = Rect4f(rect.getTopLeft() + Vector2f(0, i * (boxHeight + spacing)), rect.getWidth(), boxHeight);
 		const Rect4f area = totalArea.grow(0, -20, 0, 0);
 
+		String connText = "Connection #" + toString(i + 1) + ": latency = " + toString(lroundl(networkSession->getLatency(i) * 1000)) + " ms.";
+		const auto& compressionStats = networkSession->getCompressionStats(i);
+		if (compressionStats.uncompressedBytes > 0) {
+			connText += " Compression = " + toString(lroundl(compressionStats.getRatio() * 100)) + "% (" + toString(std::chrono::duration<double, std::milli>(compressionStats.compressTime).count(), 1) + " ms).";
+		}
 		connLabel
 			.setPosition(totalArea.getTopLeft())
-			.setText("Connection #" + toString(i + 1) + ": latency = " + toString(lroundl(networkSession->getLatency(i) * 1000)) + " ms.")
+			.setText(connText)
 			.draw(painter);
 
 		boxBg
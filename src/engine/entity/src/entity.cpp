@@ -114,7 +114,7 @@ void Entity::markDirty(World& world)
 {
 	if (!dirty) {
 		dirty = true;
-		world.onEntityDirty();
+		world.onEntityDirty(*this);
 	}
 }
 
@@ -123,7 +123,7 @@ ComponentDeleterTable& Entity::getComponentDeleterTable(World& world)
 	return world.getComponentDeleterTable();
 }
 
-void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
+void Entity::setParent(World& world, Entity* newParent, bool propagate, size_t childIdx)
 {
 	Expects(newParent != this);
 	Expects(isAlive());
@@ -145,7 +145,7 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 			if (worldPartition != newParent->worldPartition) {
 				propagateChildWorldPartition(newParent->worldPartition);
 			}
-			propagateEnabled(enabled, newParent->enabled && newParent->parentEnabled);
+			propagateEnabled(world, enabled, newParent->enabled && newParent->parentEnabled);
 			if (childIdx >= parent->children.size()) {
 				parent->children.push_back(this);
 			} else {
@@ -153,7 +153,7 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 			}
 			parent->propagateChildrenChange();
 		} else {
-			propagateEnabled(enabled, true);
+			propagateEnabled(world, enabled, true);
 		}
 
 		if (propagate) {
@@ -162,16 +162,16 @@ void Entity::setParent(Entity* newParent, bool propagate, size_t childIdx)
 	}
 }
 
-void Entity::addChild(Entity& child)
+void Entity::addChild(World& world, Entity& child)
 {
-	child.setParent(this);
+	child.setParent(world, this);
 }
 
-void Entity::detachChildren()
+void Entity::detachChildren(World& world)
 {
 	auto childrenCopy = std::move(children);
 	for (auto& child : childrenCopy) {
-		child->setParent(nullptr);
+		child->setParent(world, nullptr);
 	}
 	children.clear();
 }
@@ -207,7 +207,7 @@ void Entity::propagateChildWorldPartition(uint8_t newWorldPartition)
 	}
 }
 
-void Entity::propagateEnabled(bool enabledStatus, bool parentStatus)
+void Entity::propagateEnabled(World& world, bool enabledStatus, bool parentStatus)
 {
 	const bool oldStatus = enabled && parentEnabled;
 	enabled = enabledStatus;
@@ -216,16 +216,16 @@ void Entity::propagateEnabled(bool enabledStatus, bool parentStatus)
 
 	if (oldStatus != newStatus) {
 		for (auto& child: children) {
-			child->propagateEnabled(child->enabled, newStatus);
+			child->propagateEnabled(world, child->enabled, newStatus);
 		}
-		dirty = true;
+		markDirty(world);
 		markHierarchyDirty();
 	}
 }
 
-void Entity::setEnabled(bool enabled)
+void Entity::setEnabled(World& world, bool enabled)
 {
-	propagateEnabled(enabled, parentEnabled);
+	propagateEnabled(world, enabled, parentEnabled);
 }
 
 FamilyMaskType Entity::getMask() const
@@ -268,9 +268,9 @@ EntityId Entity::getEntityId() const
 	return entityId;
 }
 
-void Entity::destroy()
+void Entity::destroy(World& world)
 {
-	doDestroy(true);
+	doDestroy(world, true);
 }
 
 void Entity::sortChildrenByInstanceUUIDs(const Vector<UUID>& uuids)
@@ -353,21 +353,21 @@ std::optional<uint8_t> Entity::getOwnerPeerId() const
 	}
 }
 
-void Entity::doDestroy(bool updateParenting)
+void Entity::doDestroy(World& world, bool updateParenting)
 {
 	Expects(alive);
 	
 	if (updateParenting) {
-		setParent(nullptr, false);
+		setParent(world, nullptr, false);
 	}
 
 	for (auto& c: children) {
-		c->doDestroy(false);
+		c->doDestroy(world, false);
 	}
 	children.clear();
 	
 	alive = false;
-	dirty = true;
+	markDirty(world);
 }
 
 bool Entity::hasBit(const World& world, int index) const
@@ -378,7 +378,5 @@ bool Entity::hasBit(const World& world, int index) const
 void EntityRef::setReloaded()
 {
 	Expects(entity);
-	entity->reloaded = true;
-
-	world->setEntityReloaded();
+	world->setEntityReloaded(*entity);
 }
@@ -3,12 +3,68 @@
 
 using namespace Halley;
 
+uint32_t FamilySlotIndex::get(EntityId id) const
+{
+	const size_t idx = getIndex(id);
+	const size_t pageIdx = idx / pageSize;
+	if (pageIdx >= pages.size() || !pages[pageIdx]) {
+		return invalidSlot;
+	}
+	return (*pages[pageIdx])[idx % pageSize];
+}
+
+void FamilySlotIndex::set(EntityId id, size_t slot)
+{
+	const size_t idx = getIndex(id);
+	const size_t pageIdx = idx / pageSize;
+	if (pageIdx >= pages.size()) {
+		pages.resize(pageIdx + 1);
+	}
+	auto& page = pages[pageIdx];
+	if (!page) {
+		page = std::make_unique<Page>();
+		page->fill(invalidSlot);
+	}
+	(*page)[idx % pageSize] = static_cast<uint32_t>(slot);
+}
+
+void FamilySlotIndex::erase(EntityId id)
+{
+	const size_t idx = getIndex(id);
+	const size_t pageIdx = idx / pageSize;
+	if (pageIdx < pages.size() && pages[pageIdx]) {
+		(*pages[pageIdx])[idx % pageSize] = invalidSlot;
+	}
+}
+
+void FamilySlotIndex::clear()
+{
+	pages.clear();
+}
+
+size_t FamilySlotIndex::getIndex(EntityId id)
+{
+	// The lower 32 bits are the entity's index in the world's pool, the upper bits are its revision
+	return static_cast<size_t>(id.value & 0xFFFFFFFFll);
+}
+
 Family::Family(FamilyMaskType inclusionMask, FamilyMaskType optionalMask)
 	: inclusionMask(inclusionMask)
 	, optionalMask(optionalMask)
 {
 }
 
+void* Family::tryFindElement(EntityId id) const
+{
+	const auto slot = slotIndex.get(id);
+	if (slot >= elemCount) {
+		return nullptr;
+	}
+
+	void* elem = getElement(slot);
+	return static_cast<FamilyBase*>(elem)->entityId == id ? elem : nullptr;
+}
+
 void Family::addOnEntitiesAdded(FamilyBindingBase* bind)
 {
 	addEntityCallbacks.push_back(bind);
@@ -7,6 +7,33 @@
 
 using namespace Halley;
 
+thread_local SystemCommandBuffer* System::currentCommandBuffer = nullptr;
+
+void SystemCommandBuffer::sendMessage(EntityId target, std::unique_ptr<Message> msg, int msgId)
+{
+	commands.emplace_back(EntityMessageCommand{ target, std::move(msg), msgId });
+}
+
+void SystemCommandBuffer::sendSystemMessage(SystemMessageContext context, const String& targetSystem, SystemMessageDestination destination)
+{
+	commands.emplace_back(SystemMessageCommand{ std::move(context), targetSystem, destination });
+}
+
+void SystemCommandBuffer::addCommand(std::function<void(World&)> command)
+{
+	commands.emplace_back(std::move(command));
+}
+
+bool SystemCommandBuffer::empty() const
+{
+	return commands.empty();
+}
+
+void SystemCommandBuffer::clear()
+{
+	commands.clear();
+}
+
 SystemMessageBridge::SystemMessageBridge(System& system)
 	: system(&system)
 {
@@ -32,9 +59,10 @@ void SystemMessageBridge::sendMessageToSystem(const String& targetSystem, int me
 	system->sendSystemMessage(targetSystem, messageType, data, std::move(callback));
 }
 
-System::System(Vector<FamilyBindingBase*> uninitializedFamilies, Vector<int> messageTypesReceived)
+System::System(Vector<FamilyBindingBase*> uninitializedFamilies, Vector<int> messageTypesReceived, bool concurrent)
 	: families(std::move(uninitializedFamilies))
 	, messageTypesReceived(std::move(messageTypesReceived))
+	, concurrent(concurrent)
 {
 }
 
@@ -57,11 +85,22 @@ bool System::tryInit()
 	return false;
 }
 
+bool System::hasAccessConflictWith(const System& other) const
+{
+	return (componentsWritten & other.componentsRead).any() || (componentsRead & other.componentsWritten).any();
+}
+
 void System::onAddedToWorld(World& w, int id) {
 	world = &w;
 	systemId = id;
+
+	auto& storage = w.getMaskStorage();
+	componentsRead.reset();
+	componentsWritten.reset();
 	for (auto f : families) {
 		f->bindFamily(*f, w);
+		componentsRead |= f->readMask.getRealValue(storage);
+		componentsWritten |= f->writeMask.getRealValue(storage);
 	}
 }
 
@@ -117,6 +156,11 @@ void System::doProcessMessages(FamilyBindingBase& family, gsl::span<const int> t
 
 void System::doSendMessage(EntityId entityId, std::unique_ptr<Message> msg, int id)
 {
+	if (currentCommandBuffer) {
+		currentCommandBuffer->sendMessage(entityId, std::move(msg), id);
+		return;
+	}
+
 	const auto e = world->tryGetEntity(entityId);
 	if (!e.isValid()) {
 		return;
@@ -145,6 +189,12 @@ void System::dispatchMessages()
 
 size_t System::doSendSystemMessage(SystemMessageContext context, const String& targetSystem, SystemMessageDestination destination)
 {
+	if (currentCommandBuffer) {
+		// Can't know how many systems will receive it until it's replayed
+		currentCommandBuffer->sendSystemMessage(std::move(context), targetSystem, destination);
+		return 0;
+	}
+
 	return world->sendSystemMessage(std::move(context), targetSystem, destination);
 }
 
@@ -236,3 +286,70 @@ void System::doRender(RenderContext& rc) {
 
 	HALLEY_DEBUG_TRACE_COMMENT(name.c_str());
 }
+
+void System::deferCommand(std::function<void(World&)> command)
+{
+	if (currentCommandBuffer) {
+		currentCommandBuffer->addCommand(std::move(command));
+	} else {
+		command(*world);
+	}
+}
+
+void System::doInvokeParallel(size_t count, const std::function<void(size_t, size_t)>& f)
+{
+	// Deterministic mode records everything into a single buffer; the replay order is the same, as chunks are replayed in entity order
+	auto& queue = Executors::getCPU();
+	const bool deterministic = world->getSystemScheduling() == SystemScheduling::Deterministic;
+	const size_t chunkSize = deterministic ? std::max(count, size_t(1)) : Concurrent::getParallelChunkSize(queue, count);
+	const size_t nChunks = (count + chunkSize - 1) / chunkSize;
+	if (commandBuffers.size() < nChunks) {
+		commandBuffers.resize(nChunks);
+	}
+
+	auto runChunk = [&] (size_t chunk, size_t start, size_t end)
+	{
+		auto* prevBuffer = currentCommandBuffer;
+		currentCommandBuffer = &commandBuffers[chunk];
+		try {
+			f(start, end);
+		} catch (...) {
+			currentCommandBuffer = prevBuffer;
+			throw;
+		}
+		currentCommandBuffer = prevBuffer;
+	};
+
+	try {
+		if (deterministic) {
+			if (count > 0) {
+				runChunk(0, 0, count);
+			}
+		} else {
+			Concurrent::parallelFor(queue, count, chunkSize, runChunk);
+		}
+	} catch (...) {
+		for (size_t i = 0; i < nChunks; ++i) {
+			commandBuffers[i].clear();
+		}
+		throw;
+	}
+
+	for (size_t i = 0; i < nChunks; ++i) {
+		runCommands(commandBuffers[i]);
+	}
+}
+
+void System::runCommands(SystemCommandBuffer& buffer)
+{
+	for (auto& command: buffer.commands) {
+		if (auto* msg = std::get_if<SystemCommandBuffer::EntityMessageCommand>(&command)) {
+			doSendMessage(msg->target, std::move(msg->msg), msg->msgId);
+		} else if (auto* sysMsg = std::get_if<SystemCommandBuffer::SystemMessageCommand>(&command)) {
+			doSendSystemMessage(std::move(sysMsg->context), sysMsg->targetSystem, sysMsg->destination);
+		} else {
+			std::get<std::function<void(World&)>>(command)(*world);
+		}
+	}
+	buffer.clear();
+}
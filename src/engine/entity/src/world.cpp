@@ -17,6 +17,7 @@
 #include "halley/core/graphics/render_context.h"
 #include "halley/support/logger.h"
 #include "halley/support/profiler.h"
+#include "halley/concurrency/concurrent.h"
 
 using namespace Halley;
 
@@ -256,8 +257,7 @@ void World::doDestroyEntity(EntityId id)
 
 void World::doDestroyEntity(Entity* e)
 {
-	e->destroy();
-	entityDirty = true;
+	e->destroy(*this);
 }
 
 EntityRef World::getEntity(EntityId id)
@@ -373,14 +373,18 @@ Vector<ConstEntityRef> World::getTopLevelEntities() const
 	return result;
 }
 
-void World::onEntityDirty()
+void World::onEntityDirty(Entity& entity)
 {
+	dirtyEntities.push_back(&entity);
 	entityDirty = true;
 }
 
-void World::setEntityReloaded()
+void World::setEntityReloaded(Entity& entity)
 {
-	entityReloaded = true;
+	if (!entity.reloaded) {
+		entity.reloaded = true;
+		reloadedEntities.push_back(&entity);
+	}
 	entityDirty = true;
 }
 
@@ -469,6 +473,16 @@ bool World::isEditor() const
 	return editor;
 }
 
+void World::setSystemScheduling(SystemScheduling scheduling)
+{
+	systemScheduling = scheduling;
+}
+
+SystemScheduling World::getSystemScheduling() const
+{
+	return systemScheduling;
+}
+
 void World::deleteEntity(Entity* entity)
 {
 	Expects (entity);
@@ -515,7 +529,11 @@ void World::spawnPending()
 		for (auto& e : entitiesPendingCreation) {
 			e->onReady();
 		}
-		std::move(entitiesPendingCreation.begin(), entitiesPendingCreation.end(), std::insert_iterator<decltype(entities)>(entities, entities.end()));
+		entities.reserve(entities.size() + entitiesPendingCreation.size());
+		for (auto& e : entitiesPendingCreation) {
+			e->worldIndex = static_cast<uint32_t>(entities.size());
+			entities.push_back(e);
+		}
 		entitiesPendingCreation.clear();
 		entityDirty = true;
 		HALLEY_DEBUG_TRACE();
@@ -533,32 +551,38 @@ void World::updateEntities()
 	entityDirty = false;
 
 	HALLEY_DEBUG_TRACE();
-	size_t nEntities = entities.size();
 
-	Vector<size_t> entitiesRemoved;
+	// Take the queues, as family callbacks below might dirty more entities, which will be handled on the next update
+	Vector<Entity*> curDirty = std::move(dirtyEntities);
+	Vector<Entity*> curReloaded = std::move(reloadedEntities);
+	dirtyEntities.clear();
+	reloadedEntities.clear();
+
+	Vector<Entity*> entitiesRemoved;
 
 	struct FamilyTodo {
 		Vector<std::pair<FamilyMaskType, Entity*>> toAdd;
 		Vector<std::pair<FamilyMaskType, Entity*>> toRemove;
 		Vector<std::pair<FamilyMaskType, Entity*>> toReload;
 	};
-	std::map<FamilyMaskType, FamilyTodo> pending;
+	HashMap<FamilyMaskType, FamilyTodo> pending;
 
-	// Update all entities
+	// Update all dirty entities
 	// This loop should be as fast as reasonably possible
-	for (size_t i = 0; i < nEntities; i++) {
-		auto& entity = *entities[i];
-		if (i + 20 < nEntities) { // Watch out for sign! Don't subtract!
-			prefetchL2(entities[i + 20]);
+	const size_t nDirty = curDirty.size();
+	for (size_t i = 0; i < nDirty; i++) {
+		auto& entity = *curDirty[i];
+		if (i + 20 < nDirty) { // Watch out for sign! Don't subtract!
+			prefetchL2(curDirty[i + 20]);
 		}
 
-		// Check if it needs any sort of updating
+		// Check if it still needs any sort of updating
 		if (entity.needsRefresh()) {
 			// First of all, let's check if it's dead
 			if (!entity.isAlive()) {
 				// Remove from systems
 				pending[entity.getMask()].toRemove.emplace_back(FamilyMaskType(), &entity);
-				entitiesRemoved.push_back(i);
+				entitiesRemoved.push_back(&entity);
 			} else {
 				// It's alive, so check old and new system inclusions
 				FamilyMaskType oldMask = entity.getMask();
@@ -574,18 +598,14 @@ void World::updateEntities()
 		}
 	}
 
-	if (entityReloaded) {
-		for (size_t i = 0; i < nEntities; i++) {
-			auto& entity = *entities[i];
-			if (entity.reloaded && entity.isAlive()) {
-				pending[entity.getMask()].toReload.emplace_back(entity.getMask(), &entity);
-				entity.reloaded = false;
-			}
+	for (auto* e: curReloaded) {
+		auto& entity = *e;
+		if (entity.reloaded && entity.isAlive()) {
+			pending[entity.getMask()].toReload.emplace_back(entity.getMask(), &entity);
+			entity.reloaded = false;
 		}
 	}
 
-	entityReloaded = false;
-
 	HALLEY_DEBUG_TRACE();
 	// Go through every family adding/removing entities as needed
 	for (auto& todo: pending) {
@@ -628,20 +648,26 @@ void World::updateEntities()
 	HALLEY_DEBUG_TRACE();
 	// Actually remove dead entities
 	if (!entitiesRemoved.empty()) {
-		size_t livingEntityCount = entities.size();
-		for (int i = int(entitiesRemoved.size()); --i >= 0; ) {
-			size_t idx = entitiesRemoved[i];
-			auto& entity = *entities[idx];
+		for (auto* e: entitiesRemoved) {
+			auto& entity = *e;
+
+			// Swap with the last entity, so it's removed when the array gets resized
+			const auto idx = entity.worldIndex;
+			Expects(entities[idx] == &entity);
+			entities[idx] = entities.back();
+			entities[idx]->worldIndex = idx;
+			entities.pop_back();
+
+			// Make sure it's not referenced by the next update
+			if (entity.reloaded) {
+				reloadedEntities.erase(std::remove(reloadedEntities.begin(), reloadedEntities.end(), &entity), reloadedEntities.end());
+			}
 
 			// Remove
 			entityMap.freeId(entity.getEntityId().value);
 			uuidMap.erase(entity.getInstanceUUID());
 			deleteEntity(&entity);
-
-			// Put it at the back of the array, so it's removed when the array gets resized
-			std::swap(entities[idx], entities[--livingEntityCount]);
 		}
-		entities.resize(livingEntityCount);
 	}
 
 	HALLEY_DEBUG_TRACE();
@@ -661,12 +687,83 @@ void World::initSystems(gsl::span<const TimeLine> timelines)
 
 void World::updateSystems(TimeLine timeline, Time elapsed)
 {
+	if (systemScheduling == SystemScheduling::Parallel && Executors::getCPU().threadCount() > 0) {
+		updateSystemsParallel(timeline, elapsed);
+		return;
+	}
+
 	for (auto& system : getSystems(timeline)) {
 		system->doUpdate(elapsed);
 		spawnPending();
 	}
 }
 
+void World::updateSystemsParallel(TimeLine timeline, Time elapsed)
+{
+	const auto& timelineSystems = getSystems(timeline);
+	const size_t n = timelineSystems.size();
+
+	size_t batchStart = 0;
+	while (batchStart < n) {
+		// Grow the batch with consecutive systems that don't conflict with any system already in it.
+		// Only consecutive systems are batched, so any two systems that do conflict still run in timeline order.
+		size_t batchEnd = batchStart + 1;
+		if (timelineSystems[batchStart]->canUpdateConcurrently()) {
+			for (; batchEnd < n; ++batchEnd) {
+				const auto& candidate = *timelineSystems[batchEnd];
+				const bool conflicts = !candidate.canUpdateConcurrently() || std::any_of(timelineSystems.begin() + batchStart, timelineSystems.begin() + batchEnd, [&] (const auto& s)
+				{
+					return s->hasAccessConflictWith(candidate);
+				});
+				if (conflicts) {
+					break;
+				}
+			}
+		}
+
+		updateSystemBatch(gsl::span<const std::unique_ptr<System>>(timelineSystems.data() + batchStart, batchEnd - batchStart), elapsed);
+		spawnPending();
+		batchStart = batchEnd;
+	}
+}
+
+void World::updateSystemBatch(gsl::span<const std::unique_ptr<System>> batch, Time elapsed)
+{
+	if (batch.size() == 1) {
+		batch[0]->doUpdate(elapsed);
+		return;
+	}
+
+	// Exceptions are captured and re-thrown on this thread, as the executors would otherwise swallow them
+	Vector<std::exception_ptr> errors(batch.size());
+	Vector<Future<void>> futures;
+	futures.reserve(batch.size() - 1);
+	for (size_t i = 1; i < batch.size(); ++i) {
+		futures.push_back(Concurrent::execute(Executors::getCPU(), [system = batch[i].get(), error = &errors[i], elapsed] ()
+		{
+			try {
+				system->doUpdate(elapsed);
+			} catch (...) {
+				*error = std::current_exception();
+			}
+		}));
+	}
+
+	// The update thread takes the first system in the batch instead of idling
+	try {
+		batch[0]->doUpdate(elapsed);
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	Concurrent::whenAll(futures.begin(), futures.end()).wait();
+
+	for (auto& error: errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+
 void World::renderSystems(RenderContext& rc) const
 {
 	for (auto& system : getSystems(TimeLine::Render)) {
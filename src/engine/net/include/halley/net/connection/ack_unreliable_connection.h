@@ -5,7 +5,6 @@
 #include <memory>
 #include "halley/data_structures/vector.h"
 #include <chrono>
-#include <deque>
 #include <limits>
 #include <cstdint>
 #include <optional>
@@ -34,25 +33,23 @@ namespace Halley
 	class AckUnreliableSubPacket
 	{
 	public:
-		Vector<gsl::byte> data;
+		OutboundNetworkPacket data;
 		int tag = -1;
 		//bool reliable = false;
 		bool resends = false;
 		uint16_t seq = std::numeric_limits<uint16_t>::max();
 		uint16_t resendSeq = 0;
 
-		AckUnreliableSubPacket()
-		{}
-
 		AckUnreliableSubPacket(AckUnreliableSubPacket&& other) = default;
+		AckUnreliableSubPacket& operator=(AckUnreliableSubPacket&& other) = default;
 
-		AckUnreliableSubPacket(Vector<gsl::byte>&& data)
-			: data(data)
+		AckUnreliableSubPacket(OutboundNetworkPacket data)
+			: data(std::move(data))
 			, resends(false)
 		{}
 
-		AckUnreliableSubPacket(Vector<gsl::byte>&& data, uint16_t resendSeq)
-			: data(data)
+		AckUnreliableSubPacket(OutboundNetworkPacket data, uint16_t resendSeq)
+			: data(std::move(data))
 			, resends(true)
 			, resendSeq(resendSeq)
 		{}
@@ -98,7 +95,7 @@ namespace Halley
 
 		Vector<char> receivedSeqs; // 0 = not received, 1 = received
 		Vector<SentPacketData> sentPackets;
-		std::deque<InboundNetworkPacket> pendingPackets;
+		NetworkPacketQueue<InboundNetworkPacket> pendingPackets;
 
 		Vector<IAckUnreliableConnectionListener*> ackListeners;
 		IAckUnreliableConnectionStatsListener* statsListener = nullptr;
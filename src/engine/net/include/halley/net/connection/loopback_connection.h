@@ -0,0 +1,32 @@
+#pragma once
+
+#include "iconnection.h"
+#include "network_packet.h"
+#include <memory>
+#include <utility>
+
+namespace Halley
+{
+	// In-process connection, where everything sent on one end is immediately available to receive on the other
+	class LoopbackConnection : public IConnection
+	{
+	public:
+		static std::pair<std::shared_ptr<LoopbackConnection>, std::shared_ptr<LoopbackConnection>> makePair();
+
+		void close() override;
+		ConnectionStatus getStatus() const override;
+		bool isSupported(TransmissionType type) const override;
+		void send(TransmissionType type, OutboundNetworkPacket packet) override;
+		bool receive(InboundNetworkPacket& packet) override;
+
+		size_t getBytesSent() const { return bytesSent; }
+		size_t getPacketsSent() const { return packetsSent; }
+
+	private:
+		std::weak_ptr<LoopbackConnection> remote;
+		NetworkPacketQueue<InboundNetworkPacket> pending;
+		ConnectionStatus status = ConnectionStatus::Connected;
+		size_t bytesSent = 0;
+		size_t packetsSent = 0;
+	};
+}
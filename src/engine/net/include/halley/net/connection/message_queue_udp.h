@@ -4,8 +4,7 @@
 #include <memory>
 #include "halley/data_structures/vector.h"
 #include "ack_unreliable_connection.h"
-#include <map>
-#include <list>
+#include "halley/data_structures/hash_map.h"
 #include <chrono>
 #include "message_queue.h"
 #include <cstdint>
@@ -50,6 +49,17 @@ namespace Halley
 		};
 
 	public:
+		struct CompressionStats {
+			size_t uncompressedBytes = 0;
+			size_t compressedBytes = 0;
+			size_t packetsCompressed = 0;
+			size_t packetsSentRaw = 0;
+			std::chrono::nanoseconds compressTime{ 0 };
+			std::chrono::nanoseconds decompressTime{ 0 };
+
+			float getRatio() const;
+		};
+
 		MessageQueueUDP(std::shared_ptr<AckUnreliableConnection> connection);
 		~MessageQueueUDP();
 		
@@ -66,20 +76,47 @@ namespace Halley
 
 		float getLatency() const;
 
+		// Packets are only compressed once the remote end reports that it has compression enabled with the same dictionary.
+		// Dictionaries set before are kept for decoding, so that packets the remote compressed before it heard about a change still go through.
+		void setCompression(bool enabled, Bytes dictionary = {});
+		bool isCompressionActive() const;
+		const CompressionStats& getCompressionStats() const;
+
 	private:
 		std::shared_ptr<AckUnreliableConnection> connection;
 		Vector<Channel> channels;
 
-		std::list<Outbound> outboundQueued;
-		std::map<int, PendingPacket> pendingPackets;
+		Vector<Outbound> outboundQueued;
+		HashMap<int, PendingPacket> pendingPackets;
 		int nextPacketId = 0;
 
+		Vector<AckUnreliableSubPacket> toSend;
+		Vector<int> expiredPackets;
+		Vector<Vector<Outbound>> spareMessageLists;
+
+		struct Dictionary {
+			uint32_t id = 0;
+			Bytes data;
+		};
+
+		bool compressionEnabled = false;
+		uint32_t remoteAcceptedDictionary = 0;
+		Vector<Dictionary> dictionaries; // Every dictionary ever set, most recent first, which is the one used for compressing
+		CompressionStats compressionStats;
+
 		void onPacketAcked(int tag) override;
 		void checkReSend(Vector<AckUnreliableSubPacket>& collect);
 
 		AckUnreliableSubPacket createPacket();
 		AckUnreliableSubPacket makeTaggedPacket(Vector<Outbound>& msgs, size_t size, bool resends = false, uint16_t resendSeq = 0);
-		Vector<gsl::byte> serializeMessages(const Vector<Outbound>& msgs, size_t size) const;
+		OutboundNetworkPacket serializeMessages(const Vector<Outbound>& msgs, size_t size) const;
+		OutboundNetworkPacket compressPacket(OutboundNetworkPacket data);
+		void decompressPacket(InboundNetworkPacket& packet);
+		uint32_t getDictionaryId() const;
+		const Dictionary* tryGetDictionary(uint32_t id) const;
+
+		Vector<Outbound> getMessageList();
+		void recycleMessageList(Vector<Outbound>& msgs);
 
 		void receiveMessages();
 	};
@@ -5,6 +5,31 @@
 
 namespace Halley
 {
+	// Reference-counted byte buffer, allocated from size-classed pools so that packets don't hit the heap in steady state
+	class NetworkPacketBuffer
+	{
+	public:
+		NetworkPacketBuffer() = default;
+		explicit NetworkPacketBuffer(size_t capacity);
+		NetworkPacketBuffer(const NetworkPacketBuffer& other);
+		NetworkPacketBuffer(NetworkPacketBuffer&& other) noexcept;
+		~NetworkPacketBuffer();
+
+		NetworkPacketBuffer& operator=(const NetworkPacketBuffer& other);
+		NetworkPacketBuffer& operator=(NetworkPacketBuffer&& other) noexcept;
+
+		gsl::span<gsl::byte> getSpan();
+		gsl::span<const gsl::byte> getSpan() const;
+		size_t getCapacity() const;
+		bool isShared() const;
+
+	private:
+		struct Block;
+		Block* block = nullptr;
+
+		void release();
+	};
+
 	class NetworkPacketBase
 	{
 	public:
@@ -12,25 +37,36 @@ namespace Halley
 		size_t getSize() const;
 		gsl::span<const gsl::byte> getBytes() const;
 
-		NetworkPacketBase(NetworkPacketBase&& other) = delete;
-		NetworkPacketBase& operator=(NetworkPacketBase&& other) = delete;
-
 	protected:
 		NetworkPacketBase();
 		NetworkPacketBase(gsl::span<const gsl::byte> data, size_t prePadding);
+		NetworkPacketBase(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd);
+		NetworkPacketBase(const NetworkPacketBase& other) = default;
+		NetworkPacketBase(NetworkPacketBase&& other) noexcept;
+
+		NetworkPacketBase& operator=(const NetworkPacketBase& other) = default;
+		NetworkPacketBase& operator=(NetworkPacketBase&& other) noexcept;
 
 		size_t dataStart;
-		Vector<gsl::byte> data;
+		size_t dataEnd;
+		NetworkPacketBuffer buffer;
 	};
 
 	class OutboundNetworkPacket : public NetworkPacketBase
 	{
 	public:
+		// Copies share the underlying buffer until one of them is written to
 		OutboundNetworkPacket(const OutboundNetworkPacket& other);
 		OutboundNetworkPacket(OutboundNetworkPacket&& other) noexcept;
 		explicit OutboundNetworkPacket(gsl::span<const gsl::byte> data);
 		explicit OutboundNetworkPacket(const Bytes& data);
-		
+
+		// Creates a packet with size uninitialized bytes, to be filled via getWritableBytes()
+		static OutboundNetworkPacket allocate(size_t size);
+
+		gsl::span<gsl::byte> getWritableBytes();
+		void resize(size_t size);
+
 		void addHeader(gsl::span<const gsl::byte> src);
 
 		template <typename T>
@@ -40,6 +76,11 @@ namespace Halley
 		}
 
 		OutboundNetworkPacket& operator=(OutboundNetworkPacket&& other) noexcept;
+
+	private:
+		OutboundNetworkPacket(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd);
+
+		void makeUnique();
 	};
 
 	class InboundNetworkPacket : public NetworkPacketBase
@@ -48,6 +89,8 @@ namespace Halley
 		InboundNetworkPacket();
 		InboundNetworkPacket(InboundNetworkPacket&& other) noexcept;
 		explicit InboundNetworkPacket(gsl::span<const gsl::byte> data);
+		InboundNetworkPacket(NetworkPacketBuffer buffer, size_t size);
+
 		void extractHeader(gsl::span<gsl::byte> dst);
 
 		template <typename T>
@@ -56,6 +99,45 @@ namespace Halley
 			extractHeader(gsl::as_writable_bytes(gsl::span<T>(&h, 1)));
 		}
 
+		// Returns a packet referencing a range of this one, without copying
+		InboundNetworkPacket slice(size_t offset, size_t size) const;
+
 		InboundNetworkPacket& operator=(InboundNetworkPacket&& other) noexcept;
+
+	private:
+		InboundNetworkPacket(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd);
+	};
+
+	// FIFO that reuses its storage, rather than allocating blocks as it goes like std::deque
+	template <typename T>
+	class NetworkPacketQueue
+	{
+	public:
+		bool empty() const { return head == entries.size(); }
+		size_t size() const { return entries.size() - head; }
+
+		T& front() { return entries[head]; }
+
+		void push_back(T value)
+		{
+			entries.push_back(std::move(value));
+		}
+
+		void pop_front()
+		{
+			Expects(!empty());
+			++head;
+			if (head == entries.size()) {
+				entries.clear();
+				head = 0;
+			} else if (head >= 32 && head * 2 >= entries.size()) {
+				entries.erase(entries.begin(), entries.begin() + head);
+				head = 0;
+			}
+		}
+
+	private:
+		Vector<T> entries;
+		size_t head = 0;
 	};
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <optional>
 #include <halley/text/halleystring.h>
 #include "iconnection.h"
 #include "halley/time/halleytime.h"
@@ -23,6 +24,9 @@ namespace Halley
 		virtual size_t getReceivedDataPerSecond() const = 0;
 		virtual size_t getSentPacketsPerSecond() const = 0;
 		virtual size_t getReceivedPacketsPerSecond() const = 0;
+
+		virtual void onBandwidthBudgetUsage(size_t usedBytes, size_t budgetBytes) = 0;
+		virtual std::optional<float> getBandwidthBudgetUtilisation() const = 0;
 	};
 
 	class NetworkService : public INetworkServiceStatsListener
@@ -87,12 +91,16 @@ namespace Halley
 		size_t getReceivedDataPerSecond() const override;
 		size_t getSentPacketsPerSecond() const override;
 		size_t getReceivedPacketsPerSecond() const override;
+		void onBandwidthBudgetUsage(size_t usedBytes, size_t budgetBytes) override;
+		std::optional<float> getBandwidthBudgetUtilisation() const override;
 
 	protected:
 		size_t sentSize = 0;
 		size_t receivedSize = 0;
 		size_t sentPackets = 0;
 		size_t receivedPackets = 0;
+		size_t budgetUsed = 0;
+		size_t budgetTotal = 0;
 
 		virtual void onUpdateStats();
 		virtual Time getStatUpdateInterval() const;
@@ -103,5 +111,6 @@ namespace Halley
 		size_t lastReceivedSize = 0;
 		size_t lastSentPackets = 0;
 		size_t lastReceivedPackets = 0;
+		std::optional<float> lastBudgetUtilisation;
 	};
 }
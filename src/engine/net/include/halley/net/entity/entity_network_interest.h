@@ -0,0 +1,57 @@
+#pragma once
+
+#include <gsl/span>
+
+#include "halley/data_structures/hash_map.h"
+#include "halley/data_structures/vector.h"
+#include "halley/maths/rect.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley {
+	// Entities within margin of a peer's view rect are replicated no more often than every sendInterval
+	struct EntityNetworkInterestTier {
+		int margin = 0;
+		Time sendInterval = 0;
+
+		EntityNetworkInterestTier() = default;
+		EntityNetworkInterestTier(int margin, Time sendInterval)
+			: margin(margin)
+			, sendInterval(sendInterval)
+		{}
+	};
+
+	// Loose grid: each entity lives in the cell containing its centre, and queries are grown by the largest half-size seen
+	class EntityNetworkInterestGrid {
+	public:
+		struct Relevant {
+			uint32_t index;
+			uint8_t tier;
+		};
+
+		// Cells are 2^cellSizeLog2 world units wide
+		explicit EntityNetworkInterestGrid(int cellSizeLog2 = 8);
+
+		void clear();
+		void add(uint32_t index, Rect4i bounds);
+
+		// Appends every entity relevant to viewRect, tagged with the first tier it falls into, sorted by index
+		void query(Rect4i viewRect, gsl::span<const EntityNetworkInterestTier> tiers, Vector<Relevant>& result) const;
+
+		size_t size() const;
+
+	private:
+		struct Entry {
+			Rect4i bounds;
+			uint32_t index;
+		};
+
+		int cellSizeLog2;
+		HashMap<Vector2i, Vector<Entry>> cells;
+		Vector<Vector2i> usedCells;
+		Vector2i maxHalfSize;
+		size_t count = 0;
+
+		Vector2i getCell(Vector2i pos) const;
+		void queryCell(const Vector<Entry>& cell, Rect4i viewRect, gsl::span<const EntityNetworkInterestTier> tiers, Vector<Relevant>& result) const;
+	};
+}
@@ -32,9 +32,10 @@ namespace Halley {
 	public:
         EntityNetworkId entityId;
         Bytes bytes;
+        Bytes replicatedBytes;
 
         EntityNetworkMessageCreate() = default;
-		EntityNetworkMessageCreate(EntityNetworkId id, Bytes bytes) : entityId(id), bytes(std::move(bytes)) {}
+		EntityNetworkMessageCreate(EntityNetworkId id, Bytes bytes, Bytes replicatedBytes = {}) : entityId(id), bytes(std::move(bytes)), replicatedBytes(std::move(replicatedBytes)) {}
 
         EntityNetworkHeaderType getType() const override { return EntityNetworkHeaderType::Create; }
         void serialize(Serializer& s) const override;
@@ -45,9 +46,10 @@ namespace Halley {
 	public:
         EntityNetworkId entityId;
         Bytes bytes;
+        Bytes replicatedBytes;
 
         EntityNetworkMessageUpdate() = default;
-		EntityNetworkMessageUpdate(EntityNetworkId id, Bytes bytes) : entityId(id), bytes(std::move(bytes)) {}
+		EntityNetworkMessageUpdate(EntityNetworkId id, Bytes bytes, Bytes replicatedBytes = {}) : entityId(id), bytes(std::move(bytes)), replicatedBytes(std::move(replicatedBytes)) {}
 
 		EntityNetworkHeaderType getType() const override { return EntityNetworkHeaderType::Update; }
 		void serialize(Serializer& s) const override;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <gsl/span>
+
+#include "halley/bytes/byte_serializer.h"
+#include "halley/data_structures/vector.h"
+#include "halley/file/path.h"
+#include "halley/text/halleystring.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley {
+	class SerializationDictionary;
+
+	class EntityNetworkRecording {
+	public:
+		enum class Direction : uint8_t {
+			Sent,
+			Received
+		};
+
+		struct Entry {
+			Time time = 0;
+			Direction direction = Direction::Sent;
+			int peerId = -1; // -1 is a broadcast
+			Bytes data; // Uncompressed Vector<EntityNetworkMessage>, as serialized by the session
+
+			void serialize(Serializer& s) const;
+			void deserialize(Deserializer& s);
+		};
+
+		Vector<String> dictionary;
+		Vector<Entry> entries;
+
+		Time getDuration() const;
+		void setupDictionary(SerializationDictionary& dict) const;
+
+		void save(const Path& path) const;
+		static EntityNetworkRecording load(const Path& path);
+
+		Bytes toBytes() const;
+		static EntityNetworkRecording fromBytes(gsl::span<const gsl::byte> bytes);
+
+		void serialize(Serializer& s) const;
+		void deserialize(Deserializer& s);
+	};
+
+	// Attach to an EntityNetworkSession to capture all entity network messages it sends and receives
+	class EntityNetworkRecorder {
+	public:
+		void start(const SerializationDictionary& dictionary);
+		void stop();
+		bool isRecording() const;
+
+		void record(EntityNetworkRecording::Direction direction, int peerId, gsl::span<const gsl::byte> data);
+
+		const EntityNetworkRecording& getRecording() const;
+		EntityNetworkRecording takeRecording();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		EntityNetworkRecording recording;
+		Clock::time_point startTime;
+		bool active = false;
+	};
+
+	// Replays a recording through entity message encoding, compression and a loopback connection, and then back through decoding
+	class EntityNetworkReplayBenchmark {
+	public:
+		struct Result {
+			size_t batches = 0;
+			size_t messages = 0;
+			size_t entities = 0; // Entity creates and updates
+			size_t uncompressedBytes = 0;
+			size_t wireBytes = 0;
+			Time recordedDuration = 0;
+			std::chrono::nanoseconds encodeTime{ 0 };
+			std::chrono::nanoseconds decodeTime{ 0 };
+
+			double getBytesPerSecond() const;
+			double getEncodeMicrosecondsPerEntity() const;
+			double getDecodeMicrosecondsPerEntity() const;
+			String toString() const;
+		};
+
+		static Result run(const EntityNetworkRecording& recording, int iterations = 1);
+	};
+}
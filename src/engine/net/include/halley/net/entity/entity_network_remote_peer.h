@@ -1,6 +1,9 @@
 #pragma once
 
+#include "entity_network_interest.h"
 #include "entity_network_message.h"
+#include "entity_network_scheduler.h"
+#include "entity_network_snapshot.h"
 #include "halley/data_structures/hash_map.h"
 #include "halley/entity/entity.h"
 #include "../session/network_session.h"
@@ -23,16 +26,32 @@ namespace Halley {
         bool isAlive() const;
     	void destroy();
 
-    	void sendEntities(Time t, gsl::span<const std::pair<EntityId, uint8_t>> entityIds, const EntityClientSharedData& clientData);
+    	void sendEntities(Time t, gsl::span<const std::pair<EntityId, uint8_t>> entityIds, gsl::span<const EntityNetworkInterestGrid::Relevant> relevant);
         void receiveNetworkMessage(NetworkSession::PeerId fromPeerId, EntityNetworkMessage msg);
 
+        size_t getEntityBytesSentLastTick() const;
+
     private:
         class OutboundEntity {
         public:
             bool alive = true;
             Time timeSinceSend = 0;
+            float priority = 0;
             EntityNetworkId networkId = 0;
-            EntityData data;
+            std::shared_ptr<const EntityNetworkSnapshot> data;
+            std::shared_ptr<const EntityNetworkSnapshot> replicated;
+        };
+
+        class PendingUpdate {
+        public:
+            EntityId entityId;
+            std::shared_ptr<const EntityNetworkSnapshot> snapshot;
+            bool dataChanged = false;
+            Bytes bytes;
+            Bytes replicatedBytes;
+            float score = 0;
+
+            size_t getSize() const { return bytes.size() + replicatedBytes.size(); }
         };
 
         class InboundEntity {
@@ -53,14 +72,26 @@ namespace Halley {
         uint16_t nextId = 0;
 
         Time timeSinceSend = 0;
+        size_t entityBytesSent = 0;
+
+        Vector<EntityRef> pendingCreates;
+        Vector<PendingUpdate> pendingUpdates;
+        Vector<EntityNetworkScheduler::Candidate> updateCandidates;
+        Vector<uint32_t> scheduledUpdates;
+        Vector<std::pair<const EntityNetworkSnapshot::ReplicatedComponent*, uint64_t>> replicationChanges;
 
         uint16_t assignId();
         void sendCreateEntity(EntityRef entity);
-        void sendUpdateEntity(Time t, OutboundEntity& remote, EntityRef entity);
+        std::optional<PendingUpdate> prepareUpdateEntity(OutboundEntity& remote, EntityRef entity);
+        void sendUpdateEntity(OutboundEntity& remote, PendingUpdate& update);
+        void sendPendingUpdates(std::optional<size_t> budget);
         void sendDestroyEntity(OutboundEntity& remote);
         void sendKeepAlive();
         void send(EntityNetworkMessage message);
 
+        Bytes encodeReplicatedDelta(const EntityNetworkSnapshot* baseline, const EntityNetworkSnapshot& current);
+        void applyReplicatedComponents(EntityRef entity, const Bytes& bytes);
+
         void receiveCreateEntity(const EntityNetworkMessageCreate& msg);
         void receiveUpdateEntity(const EntityNetworkMessageUpdate& msg);
         void receiveDestroyEntity(const EntityNetworkMessageDestroy& msg);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <gsl/span>
+#include <optional>
+
+#include "halley/data_structures/vector.h"
+#include "halley/time/halleytime.h"
+
+namespace Halley {
+	// Decides which of a peer's due entity updates go out on a tick
+	class EntityNetworkScheduler {
+	public:
+		struct Candidate {
+			uint32_t index;
+			float score;
+			size_t size;
+		};
+
+		// Priority accumulates with time since the last send, faster for entities closer to the view
+		static float accumulatePriority(float priority, Time t, uint8_t tier);
+
+		// Weighs accumulated priority by how many components changed
+		static float getScore(float priority, size_t changedComponents);
+
+		// Appends the indices of the candidates to send to result, highest score first, fitting them in what's left of budget after bytesSent.
+		// Candidates that don't fit are skipped, but a smaller one further down can still take the space.
+		// The top candidate is always sent, even if that overshoots the budget, so that one larger than the whole budget can't starve.
+		static void schedule(gsl::span<Candidate> candidates, size_t bytesSent, std::optional<size_t> budget, Vector<uint32_t>& result);
+	};
+}
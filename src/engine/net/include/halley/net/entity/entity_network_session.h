@@ -5,6 +5,7 @@
 
 #include "halley/time/halleytime.h"
 #include "../session/network_session.h"
+#include "entity_network_recorder.h"
 #include "entity_network_remote_peer.h"
 #include "halley/bytes/serialization_dictionary.h"
 #include "halley/entity/system.h"
@@ -38,6 +39,7 @@ namespace Halley {
 			virtual void onRemoteEntityCreated(EntityRef entity, NetworkSession::PeerId peerId) {}
 			virtual void setupInterpolators(DataInterpolatorSet& interpolatorSet, EntityRef entity, bool remote) = 0;
 			virtual bool isEntityInView(EntityRef entity, const EntityClientSharedData& clientData) = 0;
+			virtual std::optional<Rect4i> getEntityInterestBounds(EntityRef entity) { return {}; } // Entities with bounds are indexed spatially instead of going through isEntityInView
 		};
 		
 		EntityNetworkSession(std::shared_ptr<NetworkSession> session, Resources& resources, std::set<String> ignoreComponents, IEntityNetworkSessionListener* listener);
@@ -56,9 +58,19 @@ namespace Halley {
 		const EntityFactory::SerializationOptions& getEntitySerializationOptions() const;
 		const EntityDataDelta::Options& getEntityDeltaOptions() const;
 		const SerializerOptions& getByteSerializationOptions() const;
+		bool isComponentReplicated(int componentId);
+		EntityNetworkSnapshotCache& getSnapshotCache();
+		const EntityNetworkSnapshotCache::Stats& getSnapshotCacheStats() const;
 		SerializationDictionary& getSerializationDictionary();
 
 		Time getMinSendInterval() const;
+		void setInterestTiers(Vector<EntityNetworkInterestTier> tiers);
+		const Vector<EntityNetworkInterestTier>& getInterestTiers() const;
+		void setPeerBandwidthBudget(std::optional<size_t> bytesPerTick); // Uncompressed entity create/update bytes per peer per tick
+		std::optional<size_t> getPeerBandwidthBudget() const;
+
+		void setRecorder(std::shared_ptr<EntityNetworkRecorder> recorder); // Starts recording with this session's dictionary
+		const std::shared_ptr<EntityNetworkRecorder>& getRecorder() const;
 
 		void onRemoteEntityCreated(EntityRef entity, NetworkSession::PeerId peerId);
 		void requestSetupInterpolators(DataInterpolatorSet& interpolatorSet, EntityRef entity, bool remote);
@@ -105,6 +117,15 @@ namespace Halley {
 		EntityDataDelta::Options deltaOptions;
 		SerializerOptions byteSerializationOptions;
 		SerializationDictionary serializationDictionary;
+		Vector<std::optional<bool>> replicatedComponents;
+		EntityNetworkSnapshotCache snapshotCache;
+
+		EntityNetworkInterestGrid interestGrid;
+		Vector<EntityNetworkInterestTier> interestTiers;
+		Vector<uint32_t> unindexedEntities;
+		Vector<EntityNetworkInterestGrid::Relevant> relevantEntities;
+		std::optional<size_t> peerBandwidthBudget;
+		std::shared_ptr<EntityNetworkRecorder> recorder;
 
 		std::shared_ptr<NetworkSession> session;
 		Vector<EntityNetworkRemotePeer> peers;
@@ -126,5 +147,8 @@ namespace Halley {
 		void sendMessages();
 		
 		void setupDictionary();
+
+		void updateInterestGrid(gsl::span<const std::pair<EntityId, uint8_t>> entityIds);
+		void updateRelevantEntities(NetworkSession::PeerId peerId, gsl::span<const std::pair<EntityId, uint8_t>> entityIds);
 	};
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <gsl/span>
+
+#include "halley/data_structures/hash_map.h"
+#include "halley/entity/entity.h"
+#include "halley/entity/entity_data.h"
+
+namespace Halley {
+	class EntityNetworkSession;
+
+	class EntityNetworkSnapshot {
+	public:
+		class ReplicatedComponent {
+		public:
+			int componentId = 0;
+			Vector<uint32_t> fieldEnds;
+			Bytes data;
+
+			gsl::span<const gsl::byte> getField(size_t idx) const;
+		};
+
+		EntityData data;
+		Vector<ReplicatedComponent> replicated;
+
+		const ReplicatedComponent* tryGetReplicated(int componentId) const;
+	};
+
+	// Serializes each entity at most once per tick, so that every peer diffs against the same shared snapshot
+	class EntityNetworkSnapshotCache {
+	public:
+		struct Stats {
+			size_t hits = 0;
+			size_t misses = 0;
+
+			float getHitRate() const;
+		};
+
+		explicit EntityNetworkSnapshotCache(EntityNetworkSession& session);
+
+		std::shared_ptr<const EntityNetworkSnapshot> getSnapshot(EntityRef entity);
+		void endTick();
+
+		const Stats& getLastTickStats() const;
+
+	private:
+		EntityNetworkSession& session;
+		HashMap<EntityId, std::shared_ptr<const EntityNetworkSnapshot>> snapshots;
+		Stats stats;
+		Stats lastTickStats;
+
+		void encodeReplicatedComponents(EntityRef entity, Vector<EntityNetworkSnapshot::ReplicatedComponent>& dst) const;
+	};
+}
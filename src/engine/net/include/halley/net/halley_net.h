@@ -8,12 +8,14 @@ namespace Halley {}
 #include <halley/net/connection/iconnection.h>
 #include <halley/net/connection/imessage_stream.h>
 #include <halley/net/connection/instability_simulator.h>
+#include <halley/net/connection/loopback_connection.h>
 #include <halley/net/connection/message_queue.h>
 #include <halley/net/connection/network_message.h>
 #include <halley/net/connection/network_packet.h>
 #include <halley/net/connection/network_service.h>
 #include <halley/net/connection/standard_message_stream.h>
 
+#include <halley/net/entity/entity_network_recorder.h>
 #include <halley/net/entity/entity_network_session.h>
 
 #include <halley/net/session/network_session.h>
@@ -6,11 +6,11 @@
 #include "network_session_messages.h"
 #include "shared_data.h"
 #include "network_session_control_messages.h"
+#include "../connection/message_queue_udp.h"
 #include "../connection/network_service.h"
 
 namespace Halley {
 	class AckUnreliableConnectionStats;
-	class MessageQueueUDP;
 	class NetworkService;
 
 	class NetworkSession {
@@ -65,6 +65,9 @@ namespace Halley {
 		size_t getNumConnections() const;
 		const AckUnreliableConnectionStats& getConnectionStats(size_t idx) const;
 		float getLatency(size_t idx) const;
+		const MessageQueueUDP::CompressionStats& getCompressionStats(size_t idx) const;
+
+		void setPacketCompression(bool enabled, Bytes dictionary = {});
 
 		template <typename T>
 		T& getMySharedData()
@@ -125,6 +128,8 @@ namespace Halley {
 		String userName;
 
 		uint16_t maxClients = 0;
+		bool packetCompression = false;
+		Bytes packetCompressionDictionary;
 		std::optional<PeerId> myPeerId;
 
 		std::unique_ptr<SharedData> sessionSharedData;
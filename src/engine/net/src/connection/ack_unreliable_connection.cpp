@@ -61,11 +61,7 @@ bool AckUnreliableConnection::isSupported(TransmissionType type) const
 
 void AckUnreliableConnection::send(TransmissionType type, OutboundNetworkPacket packet)
 {
-	AckUnreliableSubPacket subPacket;
-	subPacket.data.resize(packet.getSize());
-	packet.copyTo(subPacket.data);
-	subPacket.resends = false;
-	subPacket.tag = -1;
+	AckUnreliableSubPacket subPacket(std::move(packet));
 
 	const auto seq = sendTagged(gsl::span<AckUnreliableSubPacket>(&subPacket, 1));
 	static_cast<void>(seq);
@@ -97,10 +93,14 @@ bool AckUnreliableConnection::receive(InboundNetworkPacket& packet)
 
 uint16_t AckUnreliableConnection::sendTagged(gsl::span<const AckUnreliableSubPacket> subPackets)
 {
-	std::array<gsl::byte, 4096> buffer;
-	const auto dst = gsl::span<gsl::byte>(buffer);
+	constexpr size_t maxSubPacketHeaderSize = 6;
+	size_t maxSize = sizeof(AckUnreliableHeader);
+	for (const auto& subPacket: subPackets) {
+		maxSize += maxSubPacketHeaderSize + subPacket.data.getSize();
+	}
+	auto packet = OutboundNetworkPacket::allocate(maxSize);
 
-	auto s = Serializer(dst, SerializerOptions(SerializerOptions::maxVersion));
+	auto s = Serializer(packet.getWritableBytes(), SerializerOptions(SerializerOptions::maxVersion));
 
 	// Add header
 	const auto seq = nextSequenceToSend++;
@@ -111,16 +111,16 @@ uint16_t AckUnreliableConnection::sendTagged(gsl::span<const AckUnreliableSubPac
 	s << header;
 
 	auto& sent = sentPackets[seq % BUFFER_SIZE];
-	sent = SentPacketData{};
+	sent.tags.clear();
 
 	// Add subpackets
 	for (auto& subPacket : subPackets) {
-		const uint16_t sizeAndResend = static_cast<uint16_t>(subPacket.data.size() << 1) | static_cast<uint16_t>(subPacket.resends ? 1 : 0);
+		const uint16_t sizeAndResend = static_cast<uint16_t>(subPacket.data.getSize() << 1) | static_cast<uint16_t>(subPacket.resends ? 1 : 0);
 		s << sizeAndResend;
 		if (subPacket.resends) {
 			s << subPacket.resendSeq;
 		}
-		s << gsl::span<const gsl::byte>(subPacket.data);
+		s << subPacket.data.getBytes();
 
 		sent.tags.push_back(subPacket.tag);
 
@@ -134,8 +134,10 @@ uint16_t AckUnreliableConnection::sendTagged(gsl::span<const AckUnreliableSubPac
 	lastSend = sent.timestamp = Clock::now();
 
 	// Send
-	parent->send(TransmissionType::Unreliable, OutboundNetworkPacket(dst.subspan(0, s.getSize())));
-	notifySend(header.sequence, s.getSize());
+	const auto size = s.getSize();
+	packet.resize(size);
+	parent->send(TransmissionType::Unreliable, std::move(packet));
+	notifySend(header.sequence, size);
 	earliestUnackedMsg = {};
 
 	return seq;
@@ -181,16 +183,15 @@ void AckUnreliableConnection::processReceivedPacket(InboundNetworkPacket& packet
 				s >> resendOf;
 			}
 
-			// Extract data
-			std::array<char, 4096> buffer;
-			if (size > buffer.size() || size > s.getBytesLeft()) {
+			// Extract data, sharing the buffer of the packet it came in
+			if (size > s.getBytesLeft()) {
 				throw Exception("Unexpected sub-packet size: " + toString(size) + " bytes, " + toString(s.getBytesLeft()) + " bytes remaining.", HalleyExceptions::Network);
 			}
-			auto subPacketData = gsl::as_writable_bytes(gsl::span<char>(buffer).subspan(0, size));
-			s >> subPacketData;
+			const auto subPacketStart = s.getPosition();
+			s.skip(size);
 			
 			if (!resend || onSeqReceived(resendOf, true)) {
-				pendingPackets.emplace_back(subPacketData);
+				pendingPackets.push_back(packet.slice(subPacketStart, size));
 			}
 
 			notifyReceive(seq, size, resend);
@@ -0,0 +1,54 @@
+#include "connection/loopback_connection.h"
+
+using namespace Halley;
+
+std::pair<std::shared_ptr<LoopbackConnection>, std::shared_ptr<LoopbackConnection>> LoopbackConnection::makePair()
+{
+	auto a = std::make_shared<LoopbackConnection>();
+	auto b = std::make_shared<LoopbackConnection>();
+	a->remote = b;
+	b->remote = a;
+	return { std::move(a), std::move(b) };
+}
+
+void LoopbackConnection::close()
+{
+	status = ConnectionStatus::Closed;
+	if (auto r = remote.lock()) {
+		r->status = ConnectionStatus::Closed;
+	}
+}
+
+ConnectionStatus LoopbackConnection::getStatus() const
+{
+	return status;
+}
+
+bool LoopbackConnection::isSupported(TransmissionType) const
+{
+	return true;
+}
+
+void LoopbackConnection::send(TransmissionType, OutboundNetworkPacket packet)
+{
+	if (status != ConnectionStatus::Connected) {
+		return;
+	}
+
+	bytesSent += packet.getSize();
+	++packetsSent;
+	if (auto r = remote.lock()) {
+		r->pending.push_back(InboundNetworkPacket(packet.getBytes()));
+	}
+}
+
+bool LoopbackConnection::receive(InboundNetworkPacket& packet)
+{
+	if (pending.empty()) {
+		return false;
+	}
+
+	packet = std::move(pending.front());
+	pending.pop_front();
+	return true;
+}
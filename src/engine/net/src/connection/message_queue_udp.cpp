@@ -1,10 +1,27 @@
 #include "halley/net/connection/message_queue_udp.h"
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <utility>
 
+#include "halley/bytes/compression.h"
 #include "halley/support/logger.h"
+#include "halley/utils/algorithm.h"
+#include "halley/utils/hash.h"
 using namespace Halley;
 
+namespace {
+	// First byte of every packet: bit 0 = compressed, bit 1 = sender accepts compression.
+	// If either is set, it's followed by the id of the sender's dictionary, which is both the one it compressed with and the one it wants to receive.
+	constexpr uint8_t packetCompressedFlag = 1;
+	constexpr uint8_t packetAcceptsCompressionFlag = 2;
+}
+
+float MessageQueueUDP::CompressionStats::getRatio() const
+{
+	return uncompressedBytes > 0 ? static_cast<float>(compressedBytes) / static_cast<float>(uncompressedBytes) : 1.0f;
+}
+
 void MessageQueueUDP::Channel::getReadyMessages(Vector<InboundNetworkPacket>& out)
 {
 	if (settings.ordered) {
@@ -85,11 +102,12 @@ void MessageQueueUDP::setChannel(uint8_t channel, ChannelSettings settings)
 	c.initialized = true;
 }
 
-Vector<gsl::byte> MessageQueueUDP::serializeMessages(const Vector<Outbound>& msgs, size_t size) const
+OutboundNetworkPacket MessageQueueUDP::serializeMessages(const Vector<Outbound>& msgs, size_t size) const
 {
-	Vector<gsl::byte> result(size);
-	auto s = Serializer(result, SerializerOptions(SerializerOptions::maxVersion));
-	
+	// The header is added by compressPacket
+	auto result = OutboundNetworkPacket::allocate(size);
+	auto s = Serializer(result.getWritableBytes(), SerializerOptions(SerializerOptions::maxVersion));
+
 	for (auto& msg: msgs) {
 		const uint8_t channelN = msg.channel;
 		const auto& channel = channels[channelN];
@@ -108,11 +126,107 @@ Vector<gsl::byte> MessageQueueUDP::serializeMessages(const Vector<Outbound>& msg
 	return result;
 }
 
+OutboundNetworkPacket MessageQueueUDP::compressPacket(OutboundNetworkPacket data)
+{
+	constexpr size_t maxHeaderSize = 16;
+	const auto dictionaryId = getDictionaryId();
+	auto writeHeader = [&] (gsl::span<gsl::byte> dst, uint8_t flags, std::optional<uint32_t> uncompressedSize)
+	{
+		auto s = Serializer(dst, SerializerOptions(SerializerOptions::maxVersion));
+		s << flags;
+		if (flags != 0) {
+			s << dictionaryId;
+		}
+		if (uncompressedSize) {
+			s << *uncompressedSize;
+		}
+		return s.getSize();
+	};
+
+	if (isCompressionActive()) {
+		const auto start = std::chrono::steady_clock::now();
+
+		const auto payload = data.getBytes();
+		auto result = OutboundNetworkPacket::allocate(maxHeaderSize + Compression::lz4CompressBound(payload.size()));
+		const auto dst = result.getWritableBytes();
+		const auto headerSize = writeHeader(dst, packetAcceptsCompressionFlag | packetCompressedFlag, static_cast<uint32_t>(payload.size()));
+		const auto compressedSize = Compression::lz4Compress(payload, dst.subspan(headerSize), gsl::as_bytes(gsl::span<const Byte>(dictionaries.front().data)));
+
+		compressionStats.compressTime += std::chrono::steady_clock::now() - start;
+		compressionStats.uncompressedBytes += data.getSize();
+
+		if (compressedSize > 0 && headerSize + compressedSize < data.getSize()) {
+			result.resize(headerSize + compressedSize);
+			compressionStats.compressedBytes += result.getSize();
+			++compressionStats.packetsCompressed;
+			return result;
+		}
+
+		// Not worth it, send raw
+		compressionStats.compressedBytes += data.getSize();
+		++compressionStats.packetsSentRaw;
+	}
+
+	// Raw, but still letting the remote know which dictionary (if any) it can compress with
+	std::array<gsl::byte, maxHeaderSize> header;
+	const auto headerSize = writeHeader(header, dictionaryId != 0 ? packetAcceptsCompressionFlag : 0, std::nullopt);
+	data.addHeader(gsl::span<const gsl::byte>(header).subspan(0, headerSize));
+	return data;
+}
+
+void MessageQueueUDP::decompressPacket(InboundNetworkPacket& inbound)
+{
+	const auto packet = inbound.getBytes();
+	if (packet.empty()) {
+		throw Exception("Empty packet", HalleyExceptions::Network);
+	}
+
+	auto s = Deserializer(packet, SerializerOptions(SerializerOptions::maxVersion));
+	uint8_t header;
+	s >> header;
+	uint32_t remoteDictionary = 0;
+	if ((header & (packetCompressedFlag | packetAcceptsCompressionFlag)) != 0) {
+		s >> remoteDictionary;
+	}
+	remoteAcceptedDictionary = (header & packetAcceptsCompressionFlag) != 0 ? remoteDictionary : 0;
+
+	if ((header & packetCompressedFlag) == 0) {
+		inbound = inbound.slice(s.getPosition(), packet.size() - s.getPosition());
+		return;
+	}
+
+	// The remote only compresses with a dictionary this end offered at some point, and those are never forgotten
+	const auto* dictionary = tryGetDictionary(remoteDictionary);
+	if (!dictionary) {
+		throw Exception("Received packet compressed with a dictionary that was never offered", HalleyExceptions::Network);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	uint32_t size;
+	s >> size;
+	constexpr uint32_t maxPacketSize = 1024 * 1024;
+	if (size > maxPacketSize) {
+		throw Exception("Compressed packet is too large", HalleyExceptions::Network);
+	}
+
+	auto buffer = NetworkPacketBuffer(size);
+	const auto compressed = packet.subspan(s.getPosition());
+	const auto result = Compression::lz4Decompress(compressed, buffer.getSpan().subspan(0, size), gsl::as_bytes(gsl::span<const Byte>(dictionary->data)));
+	if (result != size) {
+		throw Exception("Unable to decompress packet", HalleyExceptions::Network);
+	}
+
+	compressionStats.decompressTime += std::chrono::steady_clock::now() - start;
+	inbound = InboundNetworkPacket(std::move(buffer), size);
+}
+
 void MessageQueueUDP::receiveMessages()
 {
 	try {
 		InboundNetworkPacket packet;
 		while (connection->receive(packet)) {
+			decompressPacket(packet);
 			auto s = Deserializer(packet.getBytes(), SerializerOptions(SerializerOptions::maxVersion));
 
 			while (s.getBytesLeft() > 0) {
@@ -125,11 +239,13 @@ void MessageQueueUDP::receiveMessages()
 					s >> sequence;
 				}
 
-				Bytes msgData;
-				s >> msgData;
+				uint32_t msgSize = 0;
+				s >> msgSize;
+				const auto msgStart = s.getPosition();
+				s.skip(msgSize);
 
-				// Read message
-				channel.receiveQueue.emplace_back(Inbound{ InboundNetworkPacket(gsl::as_bytes(gsl::span<const Byte>(msgData))), sequence, channelN });
+				// Read message, sharing the packet's buffer
+				channel.receiveQueue.emplace_back(Inbound{ packet.slice(msgStart, msgSize), sequence, channelN });
 			}
 		}
 	} catch (std::exception& e) {
@@ -166,7 +282,7 @@ void MessageQueueUDP::enqueue(OutboundNetworkPacket packet, uint8_t channelNumbe
 void MessageQueueUDP::sendAll()
 {
 	//int firstTag = nextPacketId;
-	Vector<AckUnreliableSubPacket> toSend;
+	toSend.clear();
 
 	// Add packets which need to be re-sent
 	checkReSend(toSend);
@@ -209,6 +325,44 @@ float MessageQueueUDP::getLatency() const
 	return connection->getLatency();
 }
 
+void MessageQueueUDP::setCompression(bool enabled, Bytes dictionary)
+{
+	compressionEnabled = enabled;
+	if (!enabled && dictionary.empty()) {
+		// Just stop compressing, the remote might not have noticed yet
+		return;
+	}
+
+	// Zero is reserved for "no dictionary", so ids are never zero
+	const auto hash = Hash::hash(dictionary);
+	const auto id = std::max(static_cast<uint32_t>(hash ^ (hash >> 32)), uint32_t(1));
+
+	std_ex::erase_if(dictionaries, [&] (const Dictionary& d) { return d.id == id; });
+	dictionaries.insert(dictionaries.begin(), Dictionary{ id, std::move(dictionary) });
+}
+
+bool MessageQueueUDP::isCompressionActive() const
+{
+	const auto id = getDictionaryId();
+	return id != 0 && remoteAcceptedDictionary == id;
+}
+
+uint32_t MessageQueueUDP::getDictionaryId() const
+{
+	return compressionEnabled && !dictionaries.empty() ? dictionaries.front().id : 0;
+}
+
+const MessageQueueUDP::Dictionary* MessageQueueUDP::tryGetDictionary(uint32_t id) const
+{
+	const auto iter = std::find_if(dictionaries.begin(), dictionaries.end(), [&] (const Dictionary& d) { return d.id == id; });
+	return iter != dictionaries.end() ? &*iter : nullptr;
+}
+
+const MessageQueueUDP::CompressionStats& MessageQueueUDP::getCompressionStats() const
+{
+	return compressionStats;
+}
+
 void MessageQueueUDP::onPacketAcked(int tag)
 {
 	auto i = pendingPackets.find(tag);
@@ -227,44 +381,54 @@ void MessageQueueUDP::onPacketAcked(int tag)
 		}
 
 		// Remove pending
-		pendingPackets.erase(tag);
+		recycleMessageList(packet.msgs);
+		pendingPackets.erase(i);
 	}
 }
 
 void MessageQueueUDP::checkReSend(Vector<AckUnreliableSubPacket>& collect)
 {
-	auto next = pendingPackets.begin();
-	for (auto iter = pendingPackets.begin(); iter != pendingPackets.end(); iter = next) {
-		++next;
-		auto& pending = iter->second;
-
+	const auto now = std::chrono::steady_clock::now();
+	expiredPackets.clear();
+	for (const auto& [tag, pending]: pendingPackets) {
 		// Check how long it's been waiting
-		const float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - pending.timeSent).count();
+		const float elapsed = std::chrono::duration<float>(now - pending.timeSent).count();
 		if (elapsed > 0.01f && elapsed > connection->getLatency() * 1.8f) {
-			// Re-send if it's reliable
-			if (pending.reliable) {
-				//Logger::logDev("Resending " + toString(pending.seq));
-				collect.push_back(makeTaggedPacket(pending.msgs, pending.size, true, pending.seq));
-			}
-			pendingPackets.erase(iter);
+			expiredPackets.push_back(tag);
+		}
+	}
+
+	// Oldest first
+	std::sort(expiredPackets.begin(), expiredPackets.end());
+
+	for (const int tag: expiredPackets) {
+		const auto iter = pendingPackets.find(tag);
+		auto pending = std::move(iter->second);
+		pendingPackets.erase(iter);
+
+		// Re-send if it's reliable
+		if (pending.reliable) {
+			//Logger::logDev("Resending " + toString(pending.seq));
+			collect.push_back(makeTaggedPacket(pending.msgs, pending.size, true, pending.seq));
+		} else {
+			recycleMessageList(pending.msgs);
 		}
 	}
 }
 
 AckUnreliableSubPacket MessageQueueUDP::createPacket()
 {
-	Vector<Outbound> sentMsgs;
+	auto sentMsgs = getMessageList();
 	const size_t maxSize = 1350;
 	size_t size = 0;
 	bool first = true;
 	bool packetReliable = false;
 	bool allowMaxSizeViolation = true; // Hmm
 
-	// Figure out what messages are going in this packet
-	auto next = outboundQueued.begin();
-	for (auto iter = outboundQueued.begin(); iter != outboundQueued.end(); iter = next) {
-		++next;
-		const auto& msg = *iter;
+	// Figure out what messages are going in this packet, compacting the rest of the queue in place
+	size_t nKept = 0;
+	for (size_t i = 0; i < outboundQueued.size(); ++i) {
+		auto& msg = outboundQueued[i];
 
 		// Check if this message is compatible
 		const auto& channel = channels[msg.channel];
@@ -272,7 +436,7 @@ AckUnreliableSubPacket MessageQueueUDP::createPacket()
 		const bool isOrdered = channel.settings.ordered;
 		if (first || isReliable == packetReliable) {
 			// Check if the message fits
-			const size_t msgSize = (*iter).packet.getSize();
+			const size_t msgSize = msg.packet.getSize();
 			const size_t headerSize = 8; // Max header size
 			const size_t totalSize = msgSize + headerSize;
 
@@ -284,14 +448,20 @@ AckUnreliableSubPacket MessageQueueUDP::createPacket()
 				// It fits, so add it
 				size += totalSize;
 
-				sentMsgs.push_back(std::move(*iter));
-				outboundQueued.erase(iter);
+				sentMsgs.push_back(std::move(msg));
 
 				first = false;
 				packetReliable = isReliable;
+				continue;
 			}
 		}
+
+		if (nKept != i) {
+			outboundQueued[nKept] = std::move(msg);
+		}
+		++nKept;
 	}
+	outboundQueued.erase(outboundQueued.begin() + nKept, outboundQueued.end());
 
 	if (sentMsgs.empty()) {
 		throw Exception("Was not able to fit any messages into packet!", HalleyExceptions::Network);
@@ -304,7 +474,7 @@ AckUnreliableSubPacket MessageQueueUDP::makeTaggedPacket(Vector<Outbound>& msgs,
 {
 	const bool reliable = !msgs.empty() && channels[msgs[0].channel].settings.reliable;
 
-	auto data = serializeMessages(msgs, size);
+	auto data = compressPacket(serializeMessages(msgs, size));
 
 	const int tag = nextPacketId++;
 	auto& pendingData = pendingPackets[tag];
@@ -319,3 +489,19 @@ AckUnreliableSubPacket MessageQueueUDP::makeTaggedPacket(Vector<Outbound>& msgs,
 	result.resendSeq = resendSeq;
 	return result;
 }
+
+Vector<MessageQueueUDP::Outbound> MessageQueueUDP::getMessageList()
+{
+	if (spareMessageLists.empty()) {
+		return {};
+	}
+	auto result = std::move(spareMessageLists.back());
+	spareMessageLists.pop_back();
+	return result;
+}
+
+void MessageQueueUDP::recycleMessageList(Vector<Outbound>& msgs)
+{
+	msgs.clear();
+	spareMessageLists.push_back(std::move(msgs));
+}
@@ -1,18 +1,178 @@
 #include "connection/network_packet.h"
 #include <halley/support/exception.h>
+#include "halley/data_structures/memory_pool.h"
+#include "halley/text/string_converter.h"
+#include <atomic>
+#include <array>
+#include <new>
 #include <cassert>
 
 using namespace Halley;
 
+struct NetworkPacketBuffer::Block {
+	std::atomic<uint32_t> refCount;
+	uint32_t capacity;
+	SizePool* pool;
+
+	gsl::byte* getData() { return reinterpret_cast<gsl::byte*>(this + 1); }
+};
+
+namespace {
+	constexpr size_t minBlockSizeLog2 = 8;
+	constexpr size_t numSizeClasses = 9; // 256 bytes to 64 KiB, anything larger goes to the heap
+
+	SizePool* getBlockPool(size_t blockSize, size_t& pooledSize)
+	{
+		static const std::array<SizePool*, numSizeClasses> pools = [] ()
+		{
+			std::array<SizePool*, numSizeClasses> result;
+			for (size_t i = 0; i < numSizeClasses; ++i) {
+				result[i] = PoolPool::getPool(size_t(1) << (minBlockSizeLog2 + i));
+			}
+			return result;
+		}();
+
+		for (size_t i = 0; i < numSizeClasses; ++i) {
+			const size_t classSize = size_t(1) << (minBlockSizeLog2 + i);
+			if (blockSize <= classSize) {
+				pooledSize = classSize;
+				return pools[i];
+			}
+		}
+		pooledSize = blockSize;
+		return nullptr;
+	}
+}
+
+NetworkPacketBuffer::NetworkPacketBuffer(size_t capacity)
+{
+	size_t blockSize;
+	auto* pool = getBlockPool(sizeof(Block) + capacity, blockSize);
+	void* mem = pool ? pool->alloc() : ::operator new(blockSize);
+	if (!mem) {
+		throw Exception("Unable to allocate network packet buffer of " + toString(capacity) + " bytes.", HalleyExceptions::Network);
+	}
+
+	block = new (mem) Block();
+	block->refCount = 1;
+	block->capacity = static_cast<uint32_t>(blockSize - sizeof(Block));
+	block->pool = pool;
+}
+
+NetworkPacketBuffer::NetworkPacketBuffer(const NetworkPacketBuffer& other)
+	: block(other.block)
+{
+	if (block) {
+		block->refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+NetworkPacketBuffer::NetworkPacketBuffer(NetworkPacketBuffer&& other) noexcept
+	: block(other.block)
+{
+	other.block = nullptr;
+}
+
+NetworkPacketBuffer::~NetworkPacketBuffer()
+{
+	release();
+}
+
+NetworkPacketBuffer& NetworkPacketBuffer::operator=(const NetworkPacketBuffer& other)
+{
+	if (block != other.block) {
+		release();
+		block = other.block;
+		if (block) {
+			block->refCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return *this;
+}
+
+NetworkPacketBuffer& NetworkPacketBuffer::operator=(NetworkPacketBuffer&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		block = other.block;
+		other.block = nullptr;
+	}
+	return *this;
+}
+
+gsl::span<gsl::byte> NetworkPacketBuffer::getSpan()
+{
+	return block ? gsl::span<gsl::byte>(block->getData(), block->capacity) : gsl::span<gsl::byte>();
+}
+
+gsl::span<const gsl::byte> NetworkPacketBuffer::getSpan() const
+{
+	return block ? gsl::span<const gsl::byte>(block->getData(), block->capacity) : gsl::span<const gsl::byte>();
+}
+
+size_t NetworkPacketBuffer::getCapacity() const
+{
+	return block ? block->capacity : 0;
+}
+
+bool NetworkPacketBuffer::isShared() const
+{
+	return block && block->refCount.load(std::memory_order_acquire) > 1;
+}
+
+void NetworkPacketBuffer::release()
+{
+	if (block && block->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		auto* pool = block->pool;
+		block->~Block();
+		if (pool) {
+			pool->free(block);
+		} else {
+			::operator delete(block);
+		}
+	}
+	block = nullptr;
+}
+
 NetworkPacketBase::NetworkPacketBase()
 	: dataStart(0)
+	, dataEnd(0)
 {}
 
 NetworkPacketBase::NetworkPacketBase(gsl::span<const gsl::byte> src, size_t prePadding)
 	: dataStart(prePadding)
+	, dataEnd(prePadding + src.size_bytes())
+	, buffer(prePadding + src.size_bytes())
+{
+	if (!src.empty()) {
+		memcpy(buffer.getSpan().data() + prePadding, src.data(), src.size_bytes());
+	}
+}
+
+NetworkPacketBase::NetworkPacketBase(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd)
+	: dataStart(dataStart)
+	, dataEnd(dataEnd)
+	, buffer(std::move(buffer))
+{
+	Expects(dataStart <= dataEnd);
+	Expects(dataEnd <= this->buffer.getCapacity());
+}
+
+NetworkPacketBase::NetworkPacketBase(NetworkPacketBase&& other) noexcept
+	: dataStart(other.dataStart)
+	, dataEnd(other.dataEnd)
+	, buffer(std::move(other.buffer))
 {
-	data.resize(src.size_bytes() + prePadding);
-	memcpy(data.data() + prePadding, src.data(), src.size_bytes());
+	other.dataStart = other.dataEnd = 0;
+}
+
+NetworkPacketBase& NetworkPacketBase::operator=(NetworkPacketBase&& other) noexcept
+{
+	buffer = std::move(other.buffer);
+	dataStart = other.dataStart;
+	dataEnd = other.dataEnd;
+	other.dataStart = other.dataEnd = 0;
+	return *this;
 }
 
 size_t NetworkPacketBase::copyTo(gsl::span<gsl::byte> dst) const
@@ -24,33 +184,26 @@ size_t NetworkPacketBase::copyTo(gsl::span<gsl::byte> dst) const
 	if (dst.size() < signed(getSize())) {
 		throw Exception("Destination buffer is too small for network packet.", HalleyExceptions::Network);
 	}
-	memcpy(dst.data(), data.data() + dataStart, getSize());
+	memcpy(dst.data(), buffer.getSpan().data() + dataStart, getSize());
 	return getSize();
 }
 
 size_t NetworkPacketBase::getSize() const
 {
-	Expects(data.size() >= dataStart);
-	return data.size() - dataStart;
+	Expects(dataEnd >= dataStart);
+	return dataEnd - dataStart;
 }
 
 gsl::span<const gsl::byte> NetworkPacketBase::getBytes() const
 {
-	return gsl::span<const gsl::byte>(data).subspan(dataStart, getSize());
+	return buffer.getSpan().subspan(dataStart, getSize());
 }
 
-OutboundNetworkPacket::OutboundNetworkPacket(const OutboundNetworkPacket& other)
-	: NetworkPacketBase()
-{
-	data = other.data;
-	dataStart = other.dataStart;
-}
+OutboundNetworkPacket::OutboundNetworkPacket(const OutboundNetworkPacket& other) = default;
 
 OutboundNetworkPacket::OutboundNetworkPacket(OutboundNetworkPacket&& other) noexcept
+	: NetworkPacketBase(std::move(other))
 {
-	data = other.data;
-	dataStart = other.dataStart;
-	other.dataStart = 0;
 }
 
 OutboundNetworkPacket::OutboundNetworkPacket(gsl::span<const gsl::byte> data)
@@ -62,50 +215,89 @@ OutboundNetworkPacket::OutboundNetworkPacket(const Bytes& data)
 {
 }
 
+OutboundNetworkPacket::OutboundNetworkPacket(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd)
+	: NetworkPacketBase(std::move(buffer), dataStart, dataEnd)
+{
+}
+
+OutboundNetworkPacket OutboundNetworkPacket::allocate(size_t size)
+{
+	return OutboundNetworkPacket(NetworkPacketBuffer(128 + size), 128, 128 + size);
+}
+
+gsl::span<gsl::byte> OutboundNetworkPacket::getWritableBytes()
+{
+	makeUnique();
+	return buffer.getSpan().subspan(dataStart, getSize());
+}
+
+void OutboundNetworkPacket::resize(size_t size)
+{
+	Expects(dataStart + size <= buffer.getCapacity());
+	dataEnd = dataStart + size;
+}
+
 void OutboundNetworkPacket::addHeader(gsl::span<const gsl::byte> src)
 {
-	Expects(src.size_bytes() <= dataStart);
-	
+	Expects(size_t(src.size_bytes()) <= dataStart);
+
+	makeUnique();
 	dataStart -= src.size_bytes();
-	memcpy(data.data() + dataStart, src.data(), src.size_bytes());
+	memcpy(buffer.getSpan().data() + dataStart, src.data(), src.size_bytes());
 }
 
 OutboundNetworkPacket& OutboundNetworkPacket::operator=(OutboundNetworkPacket&& other) noexcept
 {
-	data = std::move(other.data);
-	dataStart = other.dataStart;
-	other.dataStart = 0;
+	NetworkPacketBase::operator=(std::move(other));
 	return *this;
 }
 
+void OutboundNetworkPacket::makeUnique()
+{
+	if (buffer.isShared()) {
+		auto newBuffer = NetworkPacketBuffer(dataEnd);
+		memcpy(newBuffer.getSpan().data(), buffer.getSpan().data(), dataEnd);
+		buffer = std::move(newBuffer);
+	}
+}
+
 InboundNetworkPacket::InboundNetworkPacket()
 	: NetworkPacketBase()
 {}
 
 InboundNetworkPacket::InboundNetworkPacket(InboundNetworkPacket&& other) noexcept
-	: NetworkPacketBase()
+	: NetworkPacketBase(std::move(other))
 {
-	data = std::move(other.data);
-	dataStart = other.dataStart;
-	other.dataStart = 0;
 }
 
 InboundNetworkPacket::InboundNetworkPacket(gsl::span<const gsl::byte> data)
 	: NetworkPacketBase(data, 0)
 {}
 
+InboundNetworkPacket::InboundNetworkPacket(NetworkPacketBuffer buffer, size_t size)
+	: NetworkPacketBase(std::move(buffer), 0, size)
+{}
+
+InboundNetworkPacket::InboundNetworkPacket(NetworkPacketBuffer buffer, size_t dataStart, size_t dataEnd)
+	: NetworkPacketBase(std::move(buffer), dataStart, dataEnd)
+{}
+
 void InboundNetworkPacket::extractHeader(gsl::span<gsl::byte> dst)
 {
-	Expects(dst.size_bytes() <= signed(data.size()));
+	Expects(size_t(dst.size_bytes()) <= getSize());
 
-	memcpy(dst.data(), data.data() + dataStart, dst.size_bytes());
+	memcpy(dst.data(), buffer.getSpan().data() + dataStart, dst.size_bytes());
 	dataStart += dst.size_bytes();
 }
 
+InboundNetworkPacket InboundNetworkPacket::slice(size_t offset, size_t size) const
+{
+	Expects(offset + size <= getSize());
+	return InboundNetworkPacket(buffer, dataStart + offset, dataStart + offset + size);
+}
+
 InboundNetworkPacket& InboundNetworkPacket::operator=(InboundNetworkPacket&& other) noexcept
 {
-	data = other.data;
-	dataStart = other.dataStart;
-	other.dataStart = 0;
+	NetworkPacketBase::operator=(std::move(other));
 	return *this;
 }
@@ -50,10 +50,13 @@ void NetworkServiceWithStats::update(Time t)
 		lastReceivedSize = receivedSize;
 		lastSentPackets = sentPackets;
 		lastReceivedPackets = receivedPackets;
+		lastBudgetUtilisation = budgetTotal > 0 ? static_cast<float>(budgetUsed) / static_cast<float>(budgetTotal) : std::optional<float>();
 		sentSize = 0;
 		receivedSize = 0;
 		sentPackets = 0;
 		receivedPackets = 0;
+		budgetUsed = 0;
+		budgetTotal = 0;
 	}
 }
 
@@ -88,3 +91,14 @@ size_t NetworkServiceWithStats::getReceivedPacketsPerSecond() const
 {
 	return lastReceivedPackets;
 }
+
+void NetworkServiceWithStats::onBandwidthBudgetUsage(size_t usedBytes, size_t budgetBytes)
+{
+	budgetUsed += usedBytes;
+	budgetTotal += budgetBytes;
+}
+
+std::optional<float> NetworkServiceWithStats::getBandwidthBudgetUtilisation() const
+{
+	return lastBudgetUtilisation;
+}
@@ -0,0 +1,95 @@
+#include "entity/entity_network_interest.h"
+
+#include <algorithm>
+
+using namespace Halley;
+
+namespace {
+	// Inclusive, so that point-sized bounds still count
+	bool touches(Rect4i a, Rect4i b)
+	{
+		return !(a.getBottomRight().x < b.getTopLeft().x || b.getBottomRight().x < a.getTopLeft().x || a.getBottomRight().y < b.getTopLeft().y || b.getBottomRight().y < a.getTopLeft().y);
+	}
+}
+
+EntityNetworkInterestGrid::EntityNetworkInterestGrid(int cellSizeLog2)
+	: cellSizeLog2(cellSizeLog2)
+{
+	Expects(cellSizeLog2 >= 0 && cellSizeLog2 < 31);
+}
+
+void EntityNetworkInterestGrid::clear()
+{
+	// Keep the cell vectors around, entities rarely move far between ticks
+	for (const auto& c: usedCells) {
+		cells[c].clear();
+	}
+	usedCells.clear();
+	maxHalfSize = Vector2i();
+	count = 0;
+}
+
+void EntityNetworkInterestGrid::add(uint32_t index, Rect4i bounds)
+{
+	const auto halfSize = (bounds.getSize() + Vector2i(1, 1)) / 2;
+	maxHalfSize = Vector2i(std::max(maxHalfSize.x, halfSize.x), std::max(maxHalfSize.y, halfSize.y));
+
+	const auto cellPos = getCell(bounds.getCenter());
+	auto& cell = cells[cellPos];
+	if (cell.empty()) {
+		usedCells.push_back(cellPos);
+	}
+	cell.push_back(Entry{ bounds, index });
+	++count;
+}
+
+void EntityNetworkInterestGrid::query(Rect4i viewRect, gsl::span<const EntityNetworkInterestTier> tiers, Vector<Relevant>& result) const
+{
+	Expects(!tiers.empty());
+
+	const auto start = result.size();
+	const auto area = viewRect.grow(tiers.back().margin).grow(maxHalfSize.x, maxHalfSize.y, maxHalfSize.x, maxHalfSize.y);
+	const auto c0 = getCell(area.getTopLeft());
+	const auto c1 = getCell(area.getBottomRight());
+
+	const auto nCellsInArea = int64_t(c1.x - c0.x + 1) * int64_t(c1.y - c0.y + 1);
+	if (nCellsInArea > int64_t(usedCells.size())) {
+		for (const auto& c: usedCells) {
+			if (c.x >= c0.x && c.x <= c1.x && c.y >= c0.y && c.y <= c1.y) {
+				queryCell(cells.at(c), viewRect, tiers, result);
+			}
+		}
+	} else {
+		for (int y = c0.y; y <= c1.y; ++y) {
+			for (int x = c0.x; x <= c1.x; ++x) {
+				if (const auto iter = cells.find(Vector2i(x, y)); iter != cells.end()) {
+					queryCell(iter->second, viewRect, tiers, result);
+				}
+			}
+		}
+	}
+
+	std::sort(result.begin() + start, result.end(), [] (const Relevant& a, const Relevant& b) { return a.index < b.index; });
+}
+
+size_t EntityNetworkInterestGrid::size() const
+{
+	return count;
+}
+
+Vector2i EntityNetworkInterestGrid::getCell(Vector2i pos) const
+{
+	return Vector2i(pos.x >> cellSizeLog2, pos.y >> cellSizeLog2);
+}
+
+void EntityNetworkInterestGrid::queryCell(const Vector<Entry>& cell, Rect4i viewRect, gsl::span<const EntityNetworkInterestTier> tiers, Vector<Relevant>& result) const
+{
+	for (const auto& e: cell) {
+		for (size_t i = 0; i < tiers.size(); ++i) {
+			if (touches(e.bounds, viewRect.grow(tiers[i].margin))) {
+				result.push_back(Relevant{ e.index, static_cast<uint8_t>(i) });
+				break;
+			}
+		}
+	}
+}
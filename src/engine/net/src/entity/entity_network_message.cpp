@@ -10,24 +10,28 @@ void EntityNetworkMessageCreate::serialize(Serializer& s) const
 {
 	s << entityId;
 	s << bytes;
+	s << replicatedBytes;
 }
 
 void EntityNetworkMessageCreate::deserialize(Deserializer& s)
 {
 	s >> entityId;
 	s >> bytes;
+	s >> replicatedBytes;
 }
 
 void EntityNetworkMessageUpdate::serialize(Serializer& s) const
 {
 	s << entityId;
 	s << bytes;
+	s << replicatedBytes;
 }
 
 void EntityNetworkMessageUpdate::deserialize(Deserializer& s)
 {
 	s >> entityId;
 	s >> bytes;
+	s >> replicatedBytes;
 }
 
 void EntityNetworkMessageDestroy::serialize(Serializer& s) const
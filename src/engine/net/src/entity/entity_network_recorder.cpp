@@ -0,0 +1,249 @@
+#include "entity/entity_network_recorder.h"
+
+#include "connection/loopback_connection.h"
+#include "entity/entity_network_message.h"
+#include "halley/bytes/compression.h"
+#include "halley/bytes/serialization_dictionary.h"
+#include "halley/entity/entity_data_delta.h"
+#include "halley/support/exception.h"
+#include "halley/text/string_converter.h"
+
+using namespace Halley;
+
+namespace {
+	constexpr uint32_t recordingMagic = 0x43524E48; // "HNRC"
+	constexpr int recordingVersion = 1;
+}
+
+void EntityNetworkRecording::Entry::serialize(Serializer& s) const
+{
+	s << time;
+	s << direction;
+	s << peerId;
+	s << data;
+}
+
+void EntityNetworkRecording::Entry::deserialize(Deserializer& s)
+{
+	s >> time;
+	s >> direction;
+	s >> peerId;
+	s >> data;
+}
+
+Time EntityNetworkRecording::getDuration() const
+{
+	if (entries.size() < 2) {
+		return 0;
+	}
+	return entries.back().time - entries.front().time;
+}
+
+void EntityNetworkRecording::setupDictionary(SerializationDictionary& dict) const
+{
+	for (size_t i = 0; i < dictionary.size(); ++i) {
+		if (!dictionary[i].isEmpty()) {
+			dict.addEntry(i, dictionary[i]);
+		}
+	}
+}
+
+void EntityNetworkRecording::save(const Path& path) const
+{
+	Path::writeFile(path, toBytes());
+}
+
+EntityNetworkRecording EntityNetworkRecording::load(const Path& path)
+{
+	const auto bytes = Path::readFile(path);
+	if (bytes.empty()) {
+		throw Exception("Unable to read network recording from " + path.getString(), HalleyExceptions::Network);
+	}
+	return fromBytes(gsl::as_bytes(gsl::span<const Byte>(bytes)));
+}
+
+Bytes EntityNetworkRecording::toBytes() const
+{
+	return Serializer::toBytes(*this, SerializerOptions(SerializerOptions::maxVersion));
+}
+
+EntityNetworkRecording EntityNetworkRecording::fromBytes(gsl::span<const gsl::byte> bytes)
+{
+	return Deserializer::fromBytes<EntityNetworkRecording>(bytes, SerializerOptions(SerializerOptions::maxVersion));
+}
+
+void EntityNetworkRecording::serialize(Serializer& s) const
+{
+	s << recordingMagic;
+	s << recordingVersion;
+	s << dictionary;
+	s << entries;
+}
+
+void EntityNetworkRecording::deserialize(Deserializer& s)
+{
+	uint32_t magic = 0;
+	int version = 0;
+	s >> magic;
+	s >> version;
+	if (magic != recordingMagic || version != recordingVersion) {
+		throw Exception("Invalid network recording", HalleyExceptions::Network);
+	}
+	s >> dictionary;
+	s >> entries;
+}
+
+
+void EntityNetworkRecorder::start(const SerializationDictionary& dictionary)
+{
+	recording = {};
+	recording.dictionary = dictionary.getEntries();
+	startTime = Clock::now();
+	active = true;
+}
+
+void EntityNetworkRecorder::stop()
+{
+	active = false;
+}
+
+bool EntityNetworkRecorder::isRecording() const
+{
+	return active;
+}
+
+void EntityNetworkRecorder::record(EntityNetworkRecording::Direction direction, int peerId, gsl::span<const gsl::byte> data)
+{
+	if (!active) {
+		return;
+	}
+
+	auto& entry = recording.entries.emplace_back();
+	entry.time = std::chrono::duration<double>(Clock::now() - startTime).count();
+	entry.direction = direction;
+	entry.peerId = peerId;
+	entry.data = Bytes(reinterpret_cast<const Byte*>(data.data()), reinterpret_cast<const Byte*>(data.data()) + data.size());
+}
+
+const EntityNetworkRecording& EntityNetworkRecorder::getRecording() const
+{
+	return recording;
+}
+
+EntityNetworkRecording EntityNetworkRecorder::takeRecording()
+{
+	active = false;
+	return std::move(recording);
+}
+
+
+double EntityNetworkReplayBenchmark::Result::getBytesPerSecond() const
+{
+	return recordedDuration > 0 ? static_cast<double>(wireBytes) / recordedDuration : 0.0;
+}
+
+double EntityNetworkReplayBenchmark::Result::getEncodeMicrosecondsPerEntity() const
+{
+	return entities > 0 ? std::chrono::duration<double, std::micro>(encodeTime).count() / static_cast<double>(entities) : 0.0;
+}
+
+double EntityNetworkReplayBenchmark::Result::getDecodeMicrosecondsPerEntity() const
+{
+	return entities > 0 ? std::chrono::duration<double, std::micro>(decodeTime).count() / static_cast<double>(entities) : 0.0;
+}
+
+String EntityNetworkReplayBenchmark::Result::toString() const
+{
+	using Halley::toString;
+	return toString(batches) + " batches, " + toString(messages) + " messages, " + toString(entities) + " entities\n"
+		+ "Bytes: " + toString(uncompressedBytes) + " uncompressed, " + toString(wireBytes) + " on the wire, " + toString(getBytesPerSecond(), 1) + " bytes/s\n"
+		+ "Encode: " + toString(getEncodeMicrosecondsPerEntity(), 3) + " us/entity\n"
+		+ "Decode: " + toString(getDecodeMicrosecondsPerEntity(), 3) + " us/entity";
+}
+
+EntityNetworkReplayBenchmark::Result EntityNetworkReplayBenchmark::run(const EntityNetworkRecording& recording, int iterations)
+{
+	using Clock = std::chrono::steady_clock;
+
+	SerializationDictionary dictionary;
+	recording.setupDictionary(dictionary);
+	auto options = SerializerOptions(SerializerOptions::maxVersion);
+	options.dictionary = &dictionary;
+
+	// Decode the recording up front, down to the entity deltas, so that encoding can be timed from the same point the session starts from
+	struct Batch {
+		Vector<EntityNetworkMessage> msgs;
+		Vector<std::pair<size_t, EntityDataDelta>> deltas;
+	};
+	Vector<Batch> batches;
+	batches.reserve(recording.entries.size());
+	for (const auto& entry: recording.entries) {
+		auto& batch = batches.emplace_back();
+		batch.msgs = Deserializer::fromBytes<Vector<EntityNetworkMessage>>(entry.data, options);
+		for (size_t j = 0; j < batch.msgs.size(); ++j) {
+			const auto& msg = batch.msgs[j];
+			if (msg.getType() == EntityNetworkHeaderType::Create) {
+				batch.deltas.emplace_back(j, Deserializer::fromBytes<EntityDataDelta>(msg.getMessage<EntityNetworkMessageCreate>().bytes, options));
+			} else if (msg.getType() == EntityNetworkHeaderType::Update && !msg.getMessage<EntityNetworkMessageUpdate>().bytes.empty()) {
+				batch.deltas.emplace_back(j, Deserializer::fromBytes<EntityDataDelta>(msg.getMessage<EntityNetworkMessageUpdate>().bytes, options));
+			}
+		}
+	}
+
+	auto [sender, receiver] = LoopbackConnection::makePair();
+
+	Result result;
+	result.recordedDuration = recording.getDuration();
+
+	for (int i = 0; i < iterations; ++i) {
+		for (auto& batch: batches) {
+			const auto encodeStart = Clock::now();
+			for (const auto& [idx, delta]: batch.deltas) {
+				auto& msg = batch.msgs[idx];
+				if (msg.getType() == EntityNetworkHeaderType::Create) {
+					msg.getMessage<EntityNetworkMessageCreate>().bytes = Serializer::toBytes(delta, options);
+				} else {
+					msg.getMessage<EntityNetworkMessageUpdate>().bytes = Serializer::toBytes(delta, options);
+				}
+			}
+			const auto data = Serializer::toBytes(batch.msgs, options);
+			const auto compressed = Compression::compressRaw(gsl::as_bytes(gsl::span<const Byte>(data)), false);
+			sender->send(IConnection::TransmissionType::Reliable, OutboundNetworkPacket(compressed));
+			const auto decodeStart = Clock::now();
+
+			InboundNetworkPacket packet;
+			while (receiver->receive(packet)) {
+				const auto bytes = Compression::decompressRaw(packet.getBytes(), 256 * 1024);
+				const auto received = Deserializer::fromBytes<Vector<EntityNetworkMessage>>(bytes, options);
+
+				for (const auto& msg: received) {
+					if (msg.getType() == EntityNetworkHeaderType::Create) {
+						const auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.getMessage<EntityNetworkMessageCreate>().bytes, options);
+						++result.entities;
+					} else if (msg.getType() == EntityNetworkHeaderType::Update) {
+						const auto& update = msg.getMessage<EntityNetworkMessageUpdate>();
+						if (!update.bytes.empty()) {
+							const auto delta = Deserializer::fromBytes<EntityDataDelta>(update.bytes, options);
+						}
+						++result.entities;
+					}
+				}
+				result.messages += received.size();
+			}
+			const auto decodeEnd = Clock::now();
+
+			result.encodeTime += decodeStart - encodeStart;
+			result.decodeTime += decodeEnd - decodeStart;
+			result.uncompressedBytes += data.size();
+			++result.batches;
+		}
+	}
+
+	result.wireBytes = sender->getBytesSent();
+	if (iterations > 1) {
+		// Bandwidth is reported for a single real-time playback of the recording
+		result.recordedDuration *= iterations;
+	}
+
+	return result;
+}
@@ -1,7 +1,9 @@
 #include "entity/entity_network_remote_peer.h"
 
 #include "entity/entity_network_session.h"
+#include "halley/entity/component_reflector.h"
 #include "halley/entity/entity_factory.h"
+#include "halley/entity/registry.h"
 #include "halley/entity/world.h"
 #include "halley/support/logger.h"
 #include "halley/utils/algorithm.h"
@@ -20,10 +22,16 @@ NetworkSession::PeerId EntityNetworkRemotePeer::getPeerId() const
 	return peerId;
 }
 
-void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const std::pair<EntityId, uint8_t>> entityIds, const EntityClientSharedData& clientData)
+size_t EntityNetworkRemotePeer::getEntityBytesSentLastTick() const
+{
+	return entityBytesSent;
+}
+
+void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const std::pair<EntityId, uint8_t>> entityIds, gsl::span<const EntityNetworkInterestGrid::Relevant> relevant)
 {
 	Expects(isAlive());
 
+	entityBytesSent = 0;
 	if (!isRemoteReady()) {
 		return;
 	}
@@ -35,23 +43,46 @@ void EntityNetworkRemotePeer::sendEntities(Time t, gsl::span<const std::pair<Ent
 		e.second.alive = false;
 	}
 	
-	for (auto [entityId, ownerId]: entityIds) {
+	// Creations come first, in order; updates are queued and scheduled by priority below
+	const auto& tiers = parent->getInterestTiers();
+	pendingCreates.clear();
+	pendingUpdates.clear();
+	for (const auto& r: relevant) {
+		const auto [entityId, ownerId] = entityIds[r.index];
 		if (ownerId == peerId) {
 			// Don't send updates back to the owner
 			continue;
 		}
 
 		const auto entity = parent->getWorld().getEntity(entityId);
-		if (peerId == 0 || parent->isEntityInView(entity, clientData)) { // Always send to host
-			if (const auto iter = outboundEntities.find(entityId); iter == outboundEntities.end()) {
-				parent->setupOutboundInterpolators(entity);
-				sendCreateEntity(entity);
-			} else {
-				sendUpdateEntity(t, iter->second, entity);
+		if (const auto iter = outboundEntities.find(entityId); iter == outboundEntities.end()) {
+			pendingCreates.push_back(entity);
+		} else {
+			auto& remote = iter->second;
+			remote.alive = true; // Important: mark it back alive
+			remote.timeSinceSend += t;
+
+			remote.priority = EntityNetworkScheduler::accumulatePriority(remote.priority, t, r.tier);
+
+			if (remote.timeSinceSend >= std::max(parent->getMinSendInterval(), tiers[r.tier].sendInterval)) {
+				if (auto update = prepareUpdateEntity(remote, entity)) {
+					pendingUpdates.push_back(std::move(update.value()));
+				}
 			}
 		}
 	}
 
+	const auto budget = parent->getPeerBandwidthBudget();
+	for (auto& entity: pendingCreates) {
+		if (budget && entityBytesSent >= *budget) {
+			// Will be retried next tick
+			break;
+		}
+		parent->setupOutboundInterpolators(entity);
+		sendCreateEntity(entity);
+	}
+	sendPendingUpdates(budget);
+
 	// Destroy dead entities
 	for (auto& e: outboundEntities) {
 		if (!e.second.alive) {
@@ -122,42 +153,82 @@ void EntityNetworkRemotePeer::sendCreateEntity(EntityRef entity)
 	OutboundEntity result;
 
 	result.networkId = assignId();
-	result.data = parent->getFactory().serializeEntity(entity, parent->getEntitySerializationOptions());
+	result.data = parent->getSnapshotCache().getSnapshot(entity);
+	result.replicated = result.data;
 
-	auto deltaData = parent->getFactory().entityDataToPrefabDelta(result.data, entity.getPrefab(), parent->getEntityDeltaOptions());
+	auto deltaData = parent->getFactory().entityDataToPrefabDelta(result.data->data, entity.getPrefab(), parent->getEntityDeltaOptions());
 	auto bytes = Serializer::toBytes(deltaData, parent->getByteSerializationOptions());
 	//Logger::logDev("Send Create: " + entity.getName() + " (" + entity.getInstanceUUID() + ") to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B):\n" + EntityData(deltaData).toYAML() + "\n");
 
-	send(EntityNetworkMessageCreate(result.networkId, std::move(bytes)));
+	auto replicatedBytes = encodeReplicatedDelta(nullptr, *result.replicated);
+	entityBytesSent += bytes.size() + replicatedBytes.size();
+
+	send(EntityNetworkMessageCreate(result.networkId, std::move(bytes), std::move(replicatedBytes)));
 	
 	outboundEntities[entity.getEntityId()] = std::move(result);
 }
 
-void EntityNetworkRemotePeer::sendUpdateEntity(Time t, OutboundEntity& remote, EntityRef entity)
+std::optional<EntityNetworkRemotePeer::PendingUpdate> EntityNetworkRemotePeer::prepareUpdateEntity(OutboundEntity& remote, EntityRef entity)
 {
-	remote.alive = true; // Important: mark it back alive
-	remote.timeSinceSend += t;
-	if (remote.timeSinceSend < parent->getMinSendInterval()) {
-		return;
-	}
-
 	// Encode delta using interpolators
-	auto newData = parent->getFactory().serializeEntity(entity, parent->getEntitySerializationOptions());
+	auto snapshot = parent->getSnapshotCache().getSnapshot(entity);
 	auto retriever = DataInterpolatorSetRetriever(entity, true);
 	auto options = parent->getEntityDeltaOptions();
 	options.interpolatorSet = &retriever;
-	auto deltaData = EntityDataDelta(remote.data, newData, options);
-	
-	if (deltaData.hasChange()) {
-		remote.data = std::move(newData);
-		remote.timeSinceSend = 0;
+	auto deltaData = EntityDataDelta(remote.data->data, snapshot->data, options);
+	auto replicatedBytes = encodeReplicatedDelta(remote.replicated.get(), *snapshot);
 
-		auto bytes = Serializer::toBytes(deltaData, parent->getByteSerializationOptions());
-		//Logger::logDev("Send Update " + entity.getName() + " to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B):\n" + deltaData.toYAML() + "\n");
-		//Logger::logDev("Send Update " + entity.getName() + " to peer " + toString(static_cast<int>(peerId)) + " (" + toString(bytes.size()) + " B)");
-		
-		send(EntityNetworkMessageUpdate(remote.networkId, std::move(bytes)));
+	if (!deltaData.hasChange() && replicatedBytes.empty()) {
+		// Peer is up to date
+		remote.priority = 0;
+		return {};
+	}
+
+	PendingUpdate result;
+	result.entityId = entity.getEntityId();
+	result.dataChanged = deltaData.hasChange();
+	if (result.dataChanged) {
+		result.bytes = Serializer::toBytes(deltaData, parent->getByteSerializationOptions());
+	}
+	result.replicatedBytes = std::move(replicatedBytes);
+	result.snapshot = std::move(snapshot);
+
+	result.score = EntityNetworkScheduler::getScore(remote.priority, replicationChanges.size() + (result.dataChanged ? 1 : 0));
+
+	return result;
+}
+
+void EntityNetworkRemotePeer::sendUpdateEntity(OutboundEntity& remote, PendingUpdate& update)
+{
+	remote.timeSinceSend = 0;
+	remote.priority = 0;
+	remote.replicated = update.snapshot;
+	if (update.dataChanged) {
+		remote.data = std::move(update.snapshot);
 	}
+	entityBytesSent += update.getSize();
+
+	//Logger::logDev("Send Update to peer " + toString(static_cast<int>(peerId)) + " (" + toString(update.getSize()) + " B)");
+	send(EntityNetworkMessageUpdate(remote.networkId, std::move(update.bytes), std::move(update.replicatedBytes)));
+}
+
+void EntityNetworkRemotePeer::sendPendingUpdates(std::optional<size_t> budget)
+{
+	updateCandidates.clear();
+	for (size_t i = 0; i < pendingUpdates.size(); ++i) {
+		updateCandidates.push_back({ static_cast<uint32_t>(i), pendingUpdates[i].score, pendingUpdates[i].getSize() });
+	}
+
+	// Updates left out keep their priority and their baseline, so they'll win a later tick
+	scheduledUpdates.clear();
+	EntityNetworkScheduler::schedule(updateCandidates, entityBytesSent, budget, scheduledUpdates);
+	for (const auto i: scheduledUpdates) {
+		auto& update = pendingUpdates[i];
+		const auto iter = outboundEntities.find(update.entityId);
+		Expects(iter != outboundEntities.end());
+		sendUpdateEntity(iter->second, update);
+	}
+	pendingUpdates.clear();
 }
 
 void EntityNetworkRemotePeer::sendDestroyEntity(OutboundEntity& remote)
@@ -180,6 +251,77 @@ void EntityNetworkRemotePeer::send(EntityNetworkMessage message)
 	timeSinceSend = 0;
 }
 
+Bytes EntityNetworkRemotePeer::encodeReplicatedDelta(const EntityNetworkSnapshot* baseline, const EntityNetworkSnapshot& current)
+{
+	// Diff against the baseline last sent to this peer, one bit per changed field
+	replicationChanges.clear();
+	for (const auto& cur: current.replicated) {
+		const auto* prev = baseline ? baseline->tryGetReplicated(cur.componentId) : nullptr;
+
+		uint64_t mask = 0;
+		for (size_t j = 0; j < cur.fieldEnds.size(); ++j) {
+			if (!prev) {
+				mask |= uint64_t(1) << j;
+			} else {
+				const auto a = cur.getField(j);
+				const auto b = prev->getField(j);
+				if (!std::equal(a.begin(), a.end(), b.begin(), b.end())) {
+					mask |= uint64_t(1) << j;
+				}
+			}
+		}
+		if (mask != 0) {
+			replicationChanges.emplace_back(&cur, mask);
+		}
+	}
+
+	if (replicationChanges.empty()) {
+		return {};
+	}
+
+	return Serializer::toBytes([&] (Serializer& s)
+	{
+		s << static_cast<uint32_t>(replicationChanges.size());
+		for (const auto& [cur, mask]: replicationChanges) {
+			s << cur->componentId;
+			s << mask;
+			for (size_t j = 0; j < cur->fieldEnds.size(); ++j) {
+				if (mask & (uint64_t(1) << j)) {
+					s << cur->getField(j);
+				}
+			}
+		}
+	}, parent->getByteSerializationOptions());
+}
+
+void EntityNetworkRemotePeer::applyReplicatedComponents(EntityRef entity, const Bytes& bytes)
+{
+	auto s = Deserializer(bytes, parent->getByteSerializationOptions());
+
+	uint32_t count;
+	s >> count;
+	for (uint32_t i = 0; i < count; ++i) {
+		int componentId;
+		uint64_t mask;
+		s >> componentId;
+		s >> mask;
+
+		const auto& reflector = getComponentReflector(componentId);
+		const auto iter = std::find_if(entity.begin(), entity.end(), [&] (const std::pair<int, Component*>& c) { return c.first == componentId; });
+		if (iter == entity.end()) {
+			// Field sizes aren't known without the component, so the rest of the message can't be read
+			Logger::logWarning("Replicated component " + String(reflector.getName()) + " not found in network entity \"" + entity.getName() + "\"");
+			return;
+		}
+
+		for (size_t j = 0; j < reflector.getReplicatedFieldCount(); ++j) {
+			if (mask & (uint64_t(1) << j)) {
+				reflector.deserializeReplicatedField(s, *iter->second, j);
+			}
+		}
+	}
+}
+
 void EntityNetworkRemotePeer::receiveCreateEntity(const EntityNetworkMessageCreate& msg)
 {
 	const auto iter = inboundEntities.find(msg.entityId);
@@ -202,6 +344,10 @@ void EntityNetworkRemotePeer::receiveCreateEntity(const EntityNetworkMessageCrea
 		}
 	}
 
+	if (!msg.replicatedBytes.empty()) {
+		applyReplicatedComponents(entity, msg.replicatedBytes);
+	}
+
 	InboundEntity remote;
 	remote.data = std::move(entityData);
 	remote.worldId = entity.getEntityId();
@@ -227,13 +373,19 @@ void EntityNetworkRemotePeer::receiveUpdateEntity(const EntityNetworkMessageUpda
 		return;
 	}
 	
-	auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.bytes, parent->getByteSerializationOptions());
+	if (!msg.bytes.empty()) {
+		auto delta = Deserializer::fromBytes<EntityDataDelta>(msg.bytes, parent->getByteSerializationOptions());
 
-	auto retriever = DataInterpolatorSetRetriever(entity, false);
+		auto retriever = DataInterpolatorSetRetriever(entity, false);
 
-	//Logger::logDev("Updating entity:\n" + delta.toYAML());
-	parent->getFactory().updateEntity(entity, delta, EntitySerialization::makeMask(EntitySerialization::Type::Network), nullptr, &retriever);
-	remote.data.applyDelta(delta);
+		//Logger::logDev("Updating entity:\n" + delta.toYAML());
+		parent->getFactory().updateEntity(entity, delta, EntitySerialization::makeMask(EntitySerialization::Type::Network), nullptr, &retriever);
+		remote.data.applyDelta(delta);
+	}
+
+	if (!msg.replicatedBytes.empty()) {
+		applyReplicatedComponents(entity, msg.replicatedBytes);
+	}
 }
 
 void EntityNetworkRemotePeer::receiveDestroyEntity(const EntityNetworkMessageDestroy& msg)
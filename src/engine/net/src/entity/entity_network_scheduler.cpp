@@ -0,0 +1,34 @@
+#include "entity/entity_network_scheduler.h"
+
+#include <algorithm>
+
+using namespace Halley;
+
+float EntityNetworkScheduler::accumulatePriority(float priority, Time t, uint8_t tier)
+{
+	return priority + static_cast<float>(t) / static_cast<float>(1 + tier);
+}
+
+float EntityNetworkScheduler::getScore(float priority, size_t changedComponents)
+{
+	return priority * static_cast<float>(1 + changedComponents);
+}
+
+void EntityNetworkScheduler::schedule(gsl::span<Candidate> candidates, size_t bytesSent, std::optional<size_t> budget, Vector<uint32_t>& result)
+{
+	// Ties go to the lower index, so the order doesn't depend on the sort
+	std::sort(candidates.begin(), candidates.end(), [] (const Candidate& a, const Candidate& b)
+	{
+		return a.score > b.score || (a.score == b.score && a.index < b.index);
+	});
+
+	bool sentAny = false;
+	for (const auto& candidate: candidates) {
+		if (budget && sentAny && bytesSent + candidate.size > *budget) {
+			continue;
+		}
+		result.push_back(candidate.index);
+		bytesSent += candidate.size;
+		sentAny = true;
+	}
+}
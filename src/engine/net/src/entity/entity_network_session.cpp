@@ -4,7 +4,9 @@
 
 #include "halley/bytes/compression.h"
 #include "halley/entity/data_interpolator.h"
+#include "halley/entity/component_reflector.h"
 #include "halley/entity/entity_factory.h"
+#include "halley/entity/registry.h"
 #include "halley/entity/system.h"
 #include "halley/entity/world.h"
 #include "halley/support/logger.h"
@@ -16,6 +18,7 @@ using namespace Halley;
 EntityNetworkSession::EntityNetworkSession(std::shared_ptr<NetworkSession> session, Resources& resources, std::set<String> ignoreComponents, IEntityNetworkSessionListener* listener)
 	: resources(resources)
 	, listener(listener)
+	, snapshotCache(*this)
 	, session(std::move(session))
 {
 	Expects(this->session);
@@ -34,6 +37,8 @@ EntityNetworkSession::EntityNetworkSession(std::shared_ptr<NetworkSession> sessi
 	setupDictionary();
 	byteSerializationOptions.version = SerializerOptions::maxVersion;
 	byteSerializationOptions.dictionary = &serializationDictionary;
+
+	interestTiers.emplace_back(0, 0.0);
 }
 
 EntityNetworkSession::~EntityNetworkSession()
@@ -68,9 +73,17 @@ void EntityNetworkSession::sendUpdates(Time t, Rect4i viewRect, gsl::span<const
 	}
 
 	// Update entities
+	updateInterestGrid(entityIds);
+	size_t bytesUsed = 0;
 	for (auto& peer: peers) {
-		peer.sendEntities(t, entityIds, session->getClientSharedData<EntityClientSharedData>(peer.getPeerId()));
+		updateRelevantEntities(peer.getPeerId(), entityIds);
+		peer.sendEntities(t, entityIds, relevantEntities);
+		bytesUsed += peer.getEntityBytesSentLastTick();
+	}
+	if (peerBandwidthBudget && !peers.empty()) {
+		session->getService().onBandwidthBudgetUsage(bytesUsed, *peerBandwidthBudget * peers.size());
 	}
+	snapshotCache.endTick();
 
 	sendMessages();
 	session->update(t);
@@ -90,6 +103,9 @@ void EntityNetworkSession::sendMessages()
 {
 	for (const auto& [peerId, msgs]: outbox) {
 		auto data = Serializer::toBytes(msgs, byteSerializationOptions);
+		if (recorder) {
+			recorder->record(EntityNetworkRecording::Direction::Sent, peerId, gsl::as_bytes(gsl::span<const Byte>(data)));
+		}
 		auto compressed = Compression::compressRaw(gsl::as_bytes(gsl::span<const Byte>(data)), false);
 		auto packet = OutboundNetworkPacket(std::move(compressed));
 
@@ -111,6 +127,9 @@ void EntityNetworkSession::receiveUpdates()
 		auto& packet = result->second;
 
 		auto bytes = Compression::decompressRaw(packet.getBytes(), 256 * 1024);
+		if (recorder) {
+			recorder->record(EntityNetworkRecording::Direction::Received, fromPeerId, gsl::as_bytes(gsl::span<const Byte>(bytes)));
+		}
 		auto msgs = Deserializer::fromBytes<Vector<EntityNetworkMessage>>(bytes, byteSerializationOptions);
 
 		for (auto& msg: msgs) {
@@ -286,6 +305,29 @@ const SerializerOptions& EntityNetworkSession::getByteSerializationOptions() con
 	return byteSerializationOptions;
 }
 
+bool EntityNetworkSession::isComponentReplicated(int componentId)
+{
+	if (componentId >= static_cast<int>(replicatedComponents.size())) {
+		replicatedComponents.resize(componentId + 1);
+	}
+	auto& result = replicatedComponents[componentId];
+	if (!result) {
+		const auto& reflector = getComponentReflector(componentId);
+		result = reflector.getReplicatedFieldCount() > 0 && !std_ex::contains(deltaOptions.ignoreComponents, String(reflector.getName()));
+	}
+	return *result;
+}
+
+EntityNetworkSnapshotCache& EntityNetworkSession::getSnapshotCache()
+{
+	return snapshotCache;
+}
+
+const EntityNetworkSnapshotCache::Stats& EntityNetworkSession::getSnapshotCacheStats() const
+{
+	return snapshotCache.getLastTickStats();
+}
+
 SerializationDictionary& EntityNetworkSession::getSerializationDictionary()
 {
 	return serializationDictionary;
@@ -296,6 +338,89 @@ Time EntityNetworkSession::getMinSendInterval() const
 	return 0.05;
 }
 
+void EntityNetworkSession::setInterestTiers(Vector<EntityNetworkInterestTier> tiers)
+{
+	Expects(!tiers.empty());
+	Expects(tiers.size() <= 256);
+	Expects(std::is_sorted(tiers.begin(), tiers.end(), [] (const EntityNetworkInterestTier& a, const EntityNetworkInterestTier& b) { return a.margin < b.margin; }));
+	interestTiers = std::move(tiers);
+}
+
+const Vector<EntityNetworkInterestTier>& EntityNetworkSession::getInterestTiers() const
+{
+	return interestTiers;
+}
+
+void EntityNetworkSession::setPeerBandwidthBudget(std::optional<size_t> bytesPerTick)
+{
+	peerBandwidthBudget = bytesPerTick;
+}
+
+std::optional<size_t> EntityNetworkSession::getPeerBandwidthBudget() const
+{
+	return peerBandwidthBudget;
+}
+
+void EntityNetworkSession::setRecorder(std::shared_ptr<EntityNetworkRecorder> recorder)
+{
+	this->recorder = std::move(recorder);
+	if (this->recorder) {
+		this->recorder->start(serializationDictionary);
+	}
+}
+
+const std::shared_ptr<EntityNetworkRecorder>& EntityNetworkSession::getRecorder() const
+{
+	return recorder;
+}
+
+void EntityNetworkSession::updateInterestGrid(gsl::span<const std::pair<EntityId, uint8_t>> entityIds)
+{
+	interestGrid.clear();
+	unindexedEntities.clear();
+
+	auto& world = getWorld();
+	for (size_t i = 0; i < entityIds.size(); ++i) {
+		const auto entity = world.getEntity(entityIds[i].first);
+		if (const auto bounds = listener->getEntityInterestBounds(entity)) {
+			interestGrid.add(static_cast<uint32_t>(i), *bounds);
+		} else {
+			unindexedEntities.push_back(static_cast<uint32_t>(i));
+		}
+	}
+}
+
+void EntityNetworkSession::updateRelevantEntities(NetworkSession::PeerId peerId, gsl::span<const std::pair<EntityId, uint8_t>> entityIds)
+{
+	relevantEntities.clear();
+
+	if (peerId == 0) {
+		// Always send everything to host
+		for (size_t i = 0; i < entityIds.size(); ++i) {
+			relevantEntities.push_back(EntityNetworkInterestGrid::Relevant{ static_cast<uint32_t>(i), 0 });
+		}
+		return;
+	}
+
+	const auto* clientData = session->tryGetClientSharedData<EntityClientSharedData>(peerId);
+	if (!clientData || !clientData->viewRect) {
+		return;
+	}
+
+	interestGrid.query(*clientData->viewRect, interestTiers, relevantEntities);
+
+	if (!unindexedEntities.empty()) {
+		const auto nIndexed = relevantEntities.size();
+		auto& world = getWorld();
+		for (const auto i: unindexedEntities) {
+			if (isEntityInView(world.getEntity(entityIds[i].first), *clientData)) {
+				relevantEntities.push_back(EntityNetworkInterestGrid::Relevant{ i, 0 });
+			}
+		}
+		std::inplace_merge(relevantEntities.begin(), relevantEntities.begin() + nIndexed, relevantEntities.end(), [] (const EntityNetworkInterestGrid::Relevant& a, const EntityNetworkInterestGrid::Relevant& b) { return a.index < b.index; });
+	}
+}
+
 void EntityNetworkSession::onRemoteEntityCreated(EntityRef entity, NetworkSession::PeerId peerId)
 {
 	if (listener) {
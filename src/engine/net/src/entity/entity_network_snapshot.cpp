@@ -0,0 +1,92 @@
+#include "entity/entity_network_snapshot.h"
+
+#include "entity/entity_network_session.h"
+#include "halley/entity/component_reflector.h"
+#include "halley/entity/entity_factory.h"
+#include "halley/entity/registry.h"
+
+using namespace Halley;
+
+gsl::span<const gsl::byte> EntityNetworkSnapshot::ReplicatedComponent::getField(size_t idx) const
+{
+	const auto start = idx == 0 ? 0 : fieldEnds[idx - 1];
+	return gsl::as_bytes(gsl::span<const Byte>(data)).subspan(start, fieldEnds[idx] - start);
+}
+
+const EntityNetworkSnapshot::ReplicatedComponent* EntityNetworkSnapshot::tryGetReplicated(int componentId) const
+{
+	for (const auto& c: replicated) {
+		if (c.componentId == componentId) {
+			return &c;
+		}
+	}
+	return nullptr;
+}
+
+float EntityNetworkSnapshotCache::Stats::getHitRate() const
+{
+	const auto total = hits + misses;
+	return total > 0 ? static_cast<float>(hits) / static_cast<float>(total) : 0.0f;
+}
+
+EntityNetworkSnapshotCache::EntityNetworkSnapshotCache(EntityNetworkSession& session)
+	: session(session)
+{}
+
+std::shared_ptr<const EntityNetworkSnapshot> EntityNetworkSnapshotCache::getSnapshot(EntityRef entity)
+{
+	auto& snapshot = snapshots[entity.getEntityId()];
+	if (snapshot) {
+		++stats.hits;
+		return snapshot;
+	}
+
+	++stats.misses;
+	auto result = std::make_shared<EntityNetworkSnapshot>();
+	result->data = session.getFactory().serializeEntity(entity, session.getEntitySerializationOptions());
+	encodeReplicatedComponents(entity, result->replicated);
+	snapshot = std::move(result);
+	return snapshot;
+}
+
+void EntityNetworkSnapshotCache::endTick()
+{
+	// Peers keep the snapshots they use as baselines alive, the cache itself only lasts one tick
+	snapshots.clear();
+	lastTickStats = stats;
+	stats = {};
+}
+
+const EntityNetworkSnapshotCache::Stats& EntityNetworkSnapshotCache::getLastTickStats() const
+{
+	return lastTickStats;
+}
+
+void EntityNetworkSnapshotCache::encodeReplicatedComponents(EntityRef entity, Vector<EntityNetworkSnapshot::ReplicatedComponent>& dst) const
+{
+	const auto& options = session.getByteSerializationOptions();
+
+	// Encode every replicated field straight from component memory
+	for (auto [componentId, component]: entity) {
+		if (!session.isComponentReplicated(componentId)) {
+			continue;
+		}
+		const auto& reflector = getComponentReflector(componentId);
+		const auto fieldCount = reflector.getReplicatedFieldCount();
+
+		auto& cur = dst.emplace_back();
+		cur.componentId = componentId;
+		cur.fieldEnds.resize(fieldCount);
+
+		auto dry = Serializer(options);
+		for (size_t i = 0; i < fieldCount; ++i) {
+			reflector.serializeReplicatedField(dry, *component, i);
+			cur.fieldEnds[i] = static_cast<uint32_t>(dry.getSize());
+		}
+		cur.data.resize(dry.getSize());
+		auto s = Serializer(gsl::as_writable_bytes(gsl::span<Byte>(cur.data)), options);
+		for (size_t i = 0; i < fieldCount; ++i) {
+			reflector.serializeReplicatedField(s, *component, i);
+		}
+	}
+}
@@ -564,6 +564,20 @@ float NetworkSession::getLatency(size_t idx) const
 	return peers.at(idx).connection->getLatency();
 }
 
+const MessageQueueUDP::CompressionStats& NetworkSession::getCompressionStats(size_t idx) const
+{
+	return peers.at(idx).connection->getCompressionStats();
+}
+
+void NetworkSession::setPacketCompression(bool enabled, Bytes dictionary)
+{
+	packetCompression = enabled;
+	packetCompressionDictionary = std::move(dictionary);
+	for (auto& peer: peers) {
+		peer.connection->setCompression(packetCompression, packetCompressionDictionary);
+	}
+}
+
 NetworkSession::Peer& NetworkSession::getPeer(PeerId id)
 {
 	return *std::find_if(peers.begin(), peers.end(), [&](const Peer& peer) { return peer.peerId == id; });
@@ -665,6 +679,7 @@ NetworkSession::Peer NetworkSession::makePeer(PeerId peerId, std::shared_ptr<ICo
 
 	auto messageQueue = std::make_shared<MessageQueueUDP>(ackConn);
 	messageQueue->setChannel(0, ChannelSettings(true, true));
+	messageQueue->setCompression(packetCompression, packetCompressionDictionary);
 
 	return Peer{ peerId, true, std::move(messageQueue), std::move(stats) };
 }
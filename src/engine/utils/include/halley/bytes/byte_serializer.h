@@ -526,6 +526,7 @@ namespace Halley {
 
 		size_t getPosition() const { return pos; }
 		size_t getBytesLeft() const { return src.size() - pos; }
+		void skip(size_t bytes);
 
 	private:
 		size_t pos = 0;
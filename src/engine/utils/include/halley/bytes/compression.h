@@ -21,5 +21,10 @@ namespace Halley {
 		static std::optional<size_t> lz4Decompress(gsl::span<const gsl::byte> src, gsl::span<gsl::byte> dst);
 		static std::optional<size_t> lz4Decompress(gsl::span<const char> src, gsl::span<char> dst);
 		static std::optional<size_t> lz4Decompress(gsl::span<const Byte> src, gsl::span<Byte> dst);
+
+		// Dictionary variants; the same dictionary (up to 64 KB, only the tail is used beyond that) must be used on both ends
+		static size_t lz4Compress(gsl::span<const gsl::byte> src, gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> dictionary);
+		static std::optional<size_t> lz4Decompress(gsl::span<const gsl::byte> src, gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> dictionary);
+		static size_t lz4CompressBound(size_t srcSize);
 	};
 }
@@ -21,9 +21,13 @@ namespace Halley {
         void addEntry(String str);
         void addEntry(size_t idx, String str);
         void addEntries(gsl::span<const String> strings);
+        const Vector<String>& getEntries() const;
 
         void setLogMissingStrings(bool enabled, int minMissing, int freq);
         void notifyMissingString(const String& string) override;
+
+        // Raw bytes to prime packet compression with, derived only from the entries so that both ends build the same dictionary
+        Bytes makeCompressionDictionary(size_t maxSize = 16 * 1024) const;
     
     private:
         Vector<String> strings;
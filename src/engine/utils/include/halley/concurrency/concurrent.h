@@ -1,6 +1,10 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <halley/text/halleystring.h>
 #include "executor.h"
 #include "future.h"
@@ -41,28 +45,101 @@ namespace Halley
 			return future.getFuture();
 		}
 
+		namespace Detail {
+			class ParallelForState {
+			public:
+				ParallelForState(size_t nChunks, std::function<void(size_t)> body)
+					: nChunks(nChunks)
+					, body(std::move(body))
+				{}
+
+				void run()
+				{
+					for (size_t chunk = next++; chunk < nChunks; chunk = next++) {
+						if (!failed) {
+							try {
+								body(chunk);
+							} catch (...) {
+								std::lock_guard<std::mutex> lock(mutex);
+								if (!exception) {
+									exception = std::current_exception();
+								}
+								failed = true;
+							}
+						}
+
+						if (++done == nChunks) {
+							std::lock_guard<std::mutex> lock(mutex);
+							condition.notify_all();
+						}
+					}
+				}
+
+				void wait()
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [&] { return done == nChunks; });
+					if (exception) {
+						std::rethrow_exception(exception);
+					}
+				}
+
+			private:
+				const size_t nChunks;
+				std::function<void(size_t)> body;
+				std::atomic<size_t> next = 0;
+				std::atomic<size_t> done = 0;
+				std::atomic<bool> failed = false;
+				std::mutex mutex;
+				std::condition_variable condition;
+				std::exception_ptr exception;
+			};
+		}
+
+		// Splits [0, count) into chunks of chunkSize, which are claimed one at a time by whichever thread is free, so uneven per-element cost doesn't leave threads idle.
+		// The calling thread participates, and the call only returns once every chunk is done. f is invoked as f(chunkIndex, start, end).
+		template <typename F>
+		void parallelFor(ExecutionQueue& e, size_t count, size_t chunkSize, F f)
+		{
+			chunkSize = std::max(chunkSize, size_t(1));
+			const size_t nChunks = (count + chunkSize - 1) / chunkSize;
+			const size_t nHelpers = std::min(e.threadCount(), nChunks > 0 ? nChunks - 1 : 0);
+
+			if (nHelpers == 0) {
+				for (size_t i = 0; i < nChunks; ++i) {
+					f(i, i * chunkSize, std::min((i + 1) * chunkSize, count));
+				}
+				return;
+			}
+
+			// Helpers can start after this returns; they'll find no chunks left and never touch f
+			auto state = std::make_shared<Detail::ParallelForState>(nChunks, [&] (size_t i) {
+				f(i, i * chunkSize, std::min((i + 1) * chunkSize, count));
+			});
+			for (size_t i = 0; i < nHelpers; ++i) {
+				execute(e, [state] () { state->run(); });
+			}
+			state->run();
+			state->wait();
+		}
+
+		// Roughly how many chunks each thread gets, when the chunk size is picked automatically
+		constexpr size_t parallelChunksPerThread = 8;
+
+		inline size_t getParallelChunkSize(const ExecutionQueue& e, size_t count)
+		{
+			return std::max(size_t(1), count / ((e.threadCount() + 1) * parallelChunksPerThread));
+		}
+
 		template <typename T, typename F>
 		void foreach(ExecutionQueue& e, T begin, T end, F f)
 		{
 			const size_t n = end - begin;
-			constexpr size_t maxThreads = 8;
-			size_t nThreads = std::max(size_t(1), std::min(maxThreads, e.threadCount()));
-			std::array<Future<void>, maxThreads> futures;
-
-			size_t prevEnd = 0;
-			for (size_t j = 0; j < nThreads; ++j) {
-				size_t curStart = prevEnd;
-				size_t curEnd = n * (j + 1) / nThreads;
-				prevEnd = curEnd;
-
-				futures[j] = execute([begin, f, curStart, curEnd]() {
-					for (auto i = begin + curStart; i < begin + curEnd; ++i) {
-						f(*i);
-					}
-				});
-			}
-
-			whenAll(futures.data(), futures.data() + nThreads).wait();
+			parallelFor(e, n, getParallelChunkSize(e, n), [&] (size_t, size_t chunkStart, size_t chunkEnd) {
+				for (auto i = begin + chunkStart; i < begin + chunkEnd; ++i) {
+					f(*i);
+				}
+			});
 		}
 
 		template <typename T, typename F>
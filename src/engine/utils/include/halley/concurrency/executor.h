@@ -1,6 +1,8 @@
 #pragma once
-#include <deque>
+#include <array>
+#include <memory>
 #include <thread>
+#include <type_traits>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
@@ -10,32 +12,142 @@
 
 namespace Halley
 {
-	using TaskBase = std::function<void()>;
+	// Move-only callable that stores small functors (which covers most continuations and Concurrent::execute payloads) inline, without touching the heap
+	class TaskBase
+	{
+	public:
+		TaskBase() = default;
+
+		template <typename F, typename std::enable_if_t<!std::is_same_v<std::decay_t<F>, TaskBase>, int> = 0>
+		TaskBase(F&& f)
+		{
+			using T = std::decay_t<F>;
+			if constexpr (sizeof(T) <= inlineSize && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>) {
+				new (&storage) T(std::forward<F>(f));
+				vtable = &inlineVTable<T>;
+			} else {
+				*reinterpret_cast<T**>(&storage) = new T(std::forward<F>(f));
+				vtable = &heapVTable<T>;
+			}
+		}
+
+		TaskBase(TaskBase&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+
+		TaskBase& operator=(TaskBase&& other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				if (other.vtable) {
+					other.vtable->move(&storage, &other.storage);
+					vtable = other.vtable;
+					other.vtable = nullptr;
+				}
+			}
+			return *this;
+		}
+
+		TaskBase(const TaskBase& other) = delete;
+		TaskBase& operator=(const TaskBase& other) = delete;
+
+		~TaskBase()
+		{
+			reset();
+		}
+
+		void operator()()
+		{
+			vtable->invoke(&storage);
+		}
+
+		explicit operator bool() const
+		{
+			return vtable != nullptr;
+		}
+
+	private:
+		constexpr static size_t inlineSize = 48;
+
+		struct VTable {
+			void (*invoke)(void*);
+			void (*move)(void* dst, void* src);
+			void (*destroy)(void*);
+		};
+
+		template <typename T>
+		constexpr static VTable inlineVTable = {
+			[] (void* f) { (*static_cast<T*>(f))(); },
+			[] (void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); static_cast<T*>(src)->~T(); },
+			[] (void* f) { static_cast<T*>(f)->~T(); }
+		};
+
+		template <typename T>
+		constexpr static VTable heapVTable = {
+			[] (void* f) { (**static_cast<T**>(f))(); },
+			[] (void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+			[] (void* f) { delete *static_cast<T**>(f); }
+		};
+
+		std::aligned_storage_t<inlineSize, alignof(std::max_align_t)> storage;
+		const VTable* vtable = nullptr;
+
+		void reset()
+		{
+			if (vtable) {
+				vtable->destroy(&storage);
+				vtable = nullptr;
+			}
+		}
+	};
 
+	// Each attached executor owns a work-stealing deque: tasks queued from inside a worker go to its own deque, and idle workers steal from the others.
+	// Tasks queued from any other thread go through a shared injection queue. Only idle workers going to sleep ever take a lock.
+	// Queues with a single executor (or none) run everything in submission order, same as a plain FIFO.
 	class ExecutionQueue
 	{
 	public:
 		ExecutionQueue();
+		~ExecutionQueue();
+
 		void addToQueue(TaskBase task);
 
-		TaskBase getNext();
+		TaskBase getNext(size_t workerIndex);
 		Vector<TaskBase> getAll();
 
 		size_t threadCount() const;
-		void onAttached();
-		void onDetached();
+		size_t onAttached();
+		void onDetached(size_t workerIndex);
 		void abort();
 
 		static ExecutionQueue& getDefault();
 
 	private:
-		std::deque<TaskBase> queue;
-		std::mutex mutex;
+		class Worker;
+		class InjectionQueue;
+		class TaskPool;
+		struct TaskNode;
+
+		constexpr static size_t maxWorkers = 64;
+
+		std::unique_ptr<TaskPool> taskPool;
+		std::array<std::unique_ptr<Worker>, maxWorkers> workers;
+		std::unique_ptr<InjectionQueue> injection;
+		std::mutex workersMutex;
+
+		std::mutex sleepMutex;
 		std::condition_variable condition;
 
 		std::atomic<int> attachedCount;
-		std::atomic<bool> hasTasks;
+		std::atomic<size_t> workerSlotsUsed;
+		std::atomic<int64_t> queuedCount;
+		std::atomic<int> sleepingCount;
 		std::atomic<bool> aborted;
+
+		TaskNode* tryGetTask(Worker* self);
+		TaskNode* trySteal(Worker* self);
+		TaskBase takeTask(TaskNode* node);
 	};
 
 	class Executors
@@ -77,6 +189,7 @@ namespace Halley
 	private:
 		ExecutionQueue& queue;
 		std::atomic<bool> running;
+		size_t workerIndex;
 	};
 
 	class SingleThreadExecutor {
@@ -139,6 +139,40 @@ namespace Halley {
             numEntries.fetch_sub(numToRead);
     	}
 
+        // Copies entries out without consuming them
+        void peek(gsl::span<T> es, size_t offset = 0) const
+        {
+            const size_t numToRead = size_t(es.size());
+            Expects(canRead(offset + numToRead));
+            const size_t start = (readPos + offset) % entries.size();
+            const size_t spaceToEnd = entries.size() - start;
+            const size_t nToRead1 = std::min(spaceToEnd, numToRead);
+
+            for (size_t i = 0; i < nToRead1; ++i) {
+                es[i] = entries[start + i];
+            }
+
+            const size_t nToRead2 = numToRead - nToRead1;
+            for (size_t i = 0; i < nToRead2; ++i) {
+                es[i + nToRead1] = entries[i];
+            }
+        }
+
+        void skip(size_t n)
+        {
+            Expects(canRead(n));
+            for (size_t i = 0; i < n; ++i) {
+                entries[(readPos + i) % entries.size()] = T();
+            }
+            readPos = (readPos + n) % entries.size();
+            numEntries.fetch_sub(n);
+        }
+
+        void clear()
+        {
+            skip(availableToRead());
+        }
+
     private:
         size_t readPos = 0;
         size_t writePos = 0;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <gsl/gsl>
+
+#include "path.h"
+
+namespace Halley
+{
+	// Read-only view of a whole file mapped into the address space. The OS pages it in on demand, and it can be read from any thread.
+	// While mapped, the file must only be replaced by writing a new one and renaming it over (as Path::writeFile does), never rewritten in place:
+	// the mapping keeps the old contents alive through a rename, but truncating the file under it crashes whoever reads it next.
+	class MemoryMappedFile
+	{
+	public:
+		// Returns null if the file can't be mapped, e.g. it doesn't exist on the native filesystem, or the platform doesn't support it
+		static std::shared_ptr<MemoryMappedFile> open(const Path& path);
+
+		MemoryMappedFile(const MemoryMappedFile& other) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+		~MemoryMappedFile();
+
+		gsl::span<const gsl::byte> getSpan() const;
+		size_t getSize() const;
+
+	private:
+		MemoryMappedFile() = default;
+
+		const gsl::byte* data = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+}
@@ -59,6 +59,7 @@ namespace Halley {
 	public:
 		ResourceDataStatic(String path);
 		ResourceDataStatic(const void* data, size_t size, String path, bool owning = true);
+		ResourceDataStatic(std::shared_ptr<const char> data, size_t size, String path); // Shares ownership of data, e.g. to keep a file mapping alive
 
 		void set(const void* data, size_t size, bool owning = true);
 		bool isLoaded() const;
@@ -120,7 +121,7 @@ namespace Halley {
 
 		std::unique_ptr<ResourceDataStatic> getStatic(bool throwOnFail = true);
 		std::unique_ptr<ResourceDataStream> getStream(bool throwOnFail = true);
-		Future<std::unique_ptr<ResourceDataStatic>> getAsync(bool throwOnFail = true) const;
+		Future<std::unique_ptr<ResourceDataStatic>> getAsync(bool throwOnFail = true);
 		Resources& getResources() const;
 
 	private:
@@ -135,6 +136,7 @@ namespace Halley {
 		ResourceLoadPriority priority;
 		const HalleyAPI* api;
 		const Metadata* metadata;
+		std::unique_ptr<ResourceDataStatic> prefetched; // Already read (and inflated) by the resource streamer
 		bool loaded = false;
 	};
 
@@ -48,6 +48,7 @@ namespace Halley {
 		static void setErrorHandling(const String& dumpFilePath, std::function<void(const std::string&)> errorHandler);
 		static String getCallStack(int skip = 3);
 
+		// Traces are kept per thread, so systems running on worker threads don't trample each other's; the last ones are from the calling thread
 		static void trace(const char* filename, int line, const char* arg = nullptr);
 		static String getLastTraces();
 		static void printLastTraces();
@@ -55,8 +56,8 @@ namespace Halley {
 	private:
 		Debug();
 		static bool debugging;
-		static std::array<DebugTraceEntry, 16> lastTraces;
-		static int tracePos;
+		static thread_local std::array<DebugTraceEntry, 16> lastTraces;
+		static thread_local int tracePos;
 	};
 
 	#define HALLEY_DEBUG_TRACE() Halley::Debug::trace(__FILE__, __LINE__)
@@ -251,6 +251,12 @@ Deserializer& Deserializer::operator>>(Bytes& bytes)
 	return *this;
 }
 
+void Deserializer::skip(size_t bytes)
+{
+	ensureSufficientBytesRemaining(bytes);
+	pos += bytes;
+}
+
 void Deserializer::deserializeVariableInteger(uint64_t& val, bool& sign, bool isSigned)
 {
 	// 7  0sxxxxxx
@@ -213,3 +213,36 @@ std::optional<size_t> Compression::lz4Decompress(gsl::span<const Byte> src, gsl:
 {
 	return lz4Decompress(gsl::as_bytes(src), gsl::as_writable_bytes(dst));
 }
+
+size_t Compression::lz4Compress(gsl::span<const gsl::byte> src, gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> dictionary)
+{
+	if (dictionary.empty()) {
+		return lz4Compress(src, dst);
+	}
+
+	LZ4_stream_t stream;
+	LZ4_initStream(&stream, sizeof(stream));
+	LZ4_loadDict(&stream, reinterpret_cast<const char*>(dictionary.data()), static_cast<int>(dictionary.size_bytes()));
+	return LZ4_compress_fast_continue(&stream, reinterpret_cast<const char*>(src.data()), reinterpret_cast<char*>(dst.data()), static_cast<int>(src.size_bytes()), static_cast<int>(dst.size_bytes()), 1);
+}
+
+std::optional<size_t> Compression::lz4Decompress(gsl::span<const gsl::byte> src, gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> dictionary)
+{
+	// LZ4 only ever references the last 64 KB of the dictionary, matching LZ4_loadDict on the compression side
+	constexpr size_t maxDictionarySize = 64 * 1024;
+	if (dictionary.size_bytes() > maxDictionarySize) {
+		dictionary = dictionary.subspan(dictionary.size_bytes() - maxDictionarySize);
+	}
+
+	const auto result = LZ4_decompress_safe_usingDict(reinterpret_cast<const char*>(src.data()), reinterpret_cast<char*>(dst.data()), static_cast<int>(src.size_bytes()), static_cast<int>(dst.size_bytes()), reinterpret_cast<const char*>(dictionary.data()), static_cast<int>(dictionary.size_bytes()));
+	if (result >= 0) {
+		return result;
+	} else {
+		return std::nullopt;
+	}
+}
+
+size_t Compression::lz4CompressBound(size_t srcSize)
+{
+	return static_cast<size_t>(LZ4_compressBound(static_cast<int>(srcSize)));
+}
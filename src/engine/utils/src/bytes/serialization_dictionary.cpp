@@ -66,6 +66,11 @@ void SerializationDictionary::addEntries(gsl::span<const String> strings)
 	}
 }
 
+const Vector<String>& SerializationDictionary::getEntries() const
+{
+	return strings;
+}
+
 void SerializationDictionary::setLogMissingStrings(bool enabled, int min, int freq)
 {
 	logMissingStrings = enabled;
@@ -84,3 +89,22 @@ void SerializationDictionary::notifyMissingString(const String& string)
 		Logger::logWarning("Serialization dictionary missing string: " + string + " (" + toString(cur) + "x)");
 	}
 }
+
+Bytes SerializationDictionary::makeCompressionDictionary(size_t maxSize) const
+{
+	// Keep as many entries as fit, by priority, then lay them out with the highest priority last,
+	// since LZ4 finds matches at closer offsets more cheaply
+	size_t n = 0;
+	size_t totalSize = 0;
+	for (; n < strings.size() && totalSize + strings[n].size() <= maxSize; ++n) {
+		totalSize += strings[n].size();
+	}
+
+	Bytes result;
+	result.reserve(totalSize);
+	for (size_t i = n; i-- > 0;) {
+		const auto* str = reinterpret_cast<const Byte*>(strings[i].c_str());
+		result.insert(result.end(), str, str + strings[i].size());
+	}
+	return result;
+}
@@ -3,57 +3,412 @@
 #include <halley/support/exception.h>
 #include "halley/text/string_converter.h"
 #include "halley/support/logger.h"
+#include <deque>
 
 using namespace Halley;
 
 Executors* Executors::instance = nullptr;
 
-ExecutionQueue::ExecutionQueue()
-	: aborted(false)
-{
-	hasTasks.store(false);
+namespace {
+	thread_local ExecutionQueue* currentQueue = nullptr;
+	thread_local size_t currentWorkerIndex = 0;
 }
 
-TaskBase ExecutionQueue::getNext()
-{
-	std::unique_lock<std::mutex> lock(mutex);
-	while (queue.empty()) {
-		if (!aborted) {
-			condition.wait(lock);
+struct ExecutionQueue::TaskNode {
+	TaskBase task;
+	uint32_t index = 0;
+	std::atomic<uint32_t> nextFree = 0; // Index + 1 of the next free node, 0 for none
+};
+
+// Nodes are carved out of chunks that live as long as the queue, and recycled through a lock-free free list.
+// The list head packs a tag next to the node index, so a node that was popped and pushed back in between can't fool a stale CAS.
+class ExecutionQueue::TaskPool {
+public:
+	TaskNode* alloc()
+	{
+		uint64_t h = head.load(std::memory_order_acquire);
+		while (true) {
+			const auto index = uint32_t(h & 0xFFFFFFFFull);
+			if (index == 0) {
+				return grow();
+			}
+			TaskNode* node = get(index - 1);
+			const uint64_t next = makeHead(h, node->nextFree.load(std::memory_order_relaxed));
+			if (head.compare_exchange_weak(h, next, std::memory_order_acquire, std::memory_order_acquire)) {
+				return node;
+			}
 		}
-		if (aborted) {
-			queue.clear();
-			return TaskBase([] () {});
+	}
+
+	void free(TaskNode* node)
+	{
+		pushChain(node, node);
+	}
+
+private:
+	constexpr static size_t chunkSize = 1024;
+	constexpr static size_t maxChunks = 4096;
+
+	std::atomic<uint64_t> head = 0;
+	std::array<std::unique_ptr<TaskNode[]>, maxChunks> chunks;
+	size_t numChunks = 0;
+	std::mutex growMutex;
+
+	TaskNode* get(uint32_t index) const
+	{
+		return &chunks[index / chunkSize][index % chunkSize];
+	}
+
+	static uint64_t makeHead(uint64_t prev, uint32_t index)
+	{
+		return (((prev >> 32) + 1) << 32) | index;
+	}
+
+	void pushChain(TaskNode* first, TaskNode* last)
+	{
+		uint64_t h = head.load(std::memory_order_relaxed);
+		do {
+			last->nextFree.store(uint32_t(h & 0xFFFFFFFFull), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(h, makeHead(h, first->index + 1), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	TaskNode* grow()
+	{
+		std::unique_lock<std::mutex> lock(growMutex);
+		if (numChunks == maxChunks) {
+			throw Exception("Too many tasks queued on execution queue", HalleyExceptions::Concurrency);
 		}
+
+		auto& chunk = chunks[numChunks];
+		chunk.reset(new TaskNode[chunkSize]);
+		for (size_t i = 0; i < chunkSize; ++i) {
+			chunk[i].index = uint32_t(numChunks * chunkSize + i);
+			chunk[i].nextFree.store(chunk[i].index + 2, std::memory_order_relaxed);
+		}
+		++numChunks;
+
+		// Keep the first one, and hand the rest over to the free list
+		pushChain(&chunk[1], &chunk[chunkSize - 1]);
+		return &chunk[0];
 	}
+};
 
-	TaskBase value = queue.front();
-	queue.pop_front();
-	return value;
-}
+// Chase-Lev deque, as formulated for C11 atomics by Le, Pop, Cohen and Zappa Nardelli.
+// Only the owning worker pushes and pops at the bottom; anyone can steal from the top.
+class ExecutionQueue::Worker {
+public:
+	Worker()
+		: array(new Array(initialCapacity))
+	{
+		arrays.emplace_back(array.load());
+	}
 
-Vector<TaskBase> ExecutionQueue::getAll()
+	void push(TaskNode* task)
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		Array* a = array.load(std::memory_order_relaxed);
+		if (b - t > int64_t(a->capacity) - 1) {
+			a = grow(a, t, b);
+		}
+		a->put(b, task);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	TaskNode* pop()
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Array* a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		TaskNode* result = nullptr;
+		if (t <= b) {
+			result = a->get(b);
+			if (t == b) {
+				// Last element, race against thieves
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					result = nullptr;
+				}
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		} else {
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+	TaskNode* steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t < b) {
+			Array* a = array.load(std::memory_order_acquire);
+			TaskNode* result = a->get(t);
+			if (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				return result;
+			}
+		}
+		return nullptr;
+	}
+
+	std::atomic<bool> inUse = false;
+
+private:
+	constexpr static size_t initialCapacity = 256;
+
+	struct Array {
+		size_t capacity;
+		std::unique_ptr<std::atomic<TaskNode*>[]> slots;
+
+		Array(size_t capacity)
+			: capacity(capacity)
+			, slots(new std::atomic<TaskNode*>[capacity])
+		{}
+
+		TaskNode* get(int64_t i) const
+		{
+			return slots[size_t(i) & (capacity - 1)].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t i, TaskNode* task)
+		{
+			slots[size_t(i) & (capacity - 1)].store(task, std::memory_order_relaxed);
+		}
+	};
+
+	std::atomic<int64_t> top = 0;
+	std::atomic<int64_t> bottom = 0;
+	std::atomic<Array*> array;
+
+	// Thieves might still be reading from an old array after it grows, so they're only released with the worker
+	Vector<std::unique_ptr<Array>> arrays;
+
+	Array* grow(Array* a, int64_t t, int64_t b)
+	{
+		auto* newArray = new Array(a->capacity * 2);
+		for (int64_t i = t; i < b; ++i) {
+			newArray->put(i, a->get(i));
+		}
+		arrays.emplace_back(newArray);
+		array.store(newArray, std::memory_order_release);
+		return newArray;
+	}
+};
+
+// Bounded multi-producer multi-consumer ring (Vyukov), falling back to a locked list if producers ever outpace the workers by more than its capacity.
+// Once anything spills over, everything after it goes to the list too until it drains, so tasks still come out in the order they went in.
+class ExecutionQueue::InjectionQueue {
+public:
+	InjectionQueue()
+		: cells(new Cell[capacity])
+	{
+		for (size_t i = 0; i < capacity; ++i) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	void push(TaskNode* task)
+	{
+		if (hasOverflow) {
+			std::unique_lock<std::mutex> lock(overflowMutex);
+			if (!overflow.empty()) {
+				overflow.push_back(task);
+				return;
+			}
+		}
+
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = cells[pos & (capacity - 1)];
+			const size_t seq = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = intptr_t(seq) - intptr_t(pos);
+			if (diff == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.task = task;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return;
+				}
+			} else if (diff < 0) {
+				// Full
+				std::unique_lock<std::mutex> lock(overflowMutex);
+				overflow.push_back(task);
+				hasOverflow = true;
+				return;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	TaskNode* pop()
+	{
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = cells[pos & (capacity - 1)];
+			const size_t seq = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = intptr_t(seq) - intptr_t(pos + 1);
+			if (diff == 0) {
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					TaskNode* task = cell.task;
+					cell.sequence.store(pos + capacity, std::memory_order_release);
+					return task;
+				}
+			} else if (diff < 0) {
+				// Empty
+				return popOverflow();
+			} else {
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	constexpr static size_t capacity = 4096;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		TaskNode* task = nullptr;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	alignas(64) std::atomic<size_t> enqueuePos = 0;
+	alignas(64) std::atomic<size_t> dequeuePos = 0;
+
+	std::mutex overflowMutex;
+	std::deque<TaskNode*> overflow;
+	std::atomic<bool> hasOverflow = false;
+
+	TaskNode* popOverflow()
+	{
+		if (!hasOverflow) {
+			return nullptr;
+		}
+		std::unique_lock<std::mutex> lock(overflowMutex);
+		if (overflow.empty()) {
+			return nullptr;
+		}
+		auto* task = overflow.front();
+		overflow.pop_front();
+		hasOverflow = !overflow.empty();
+		return task;
+	}
+};
+
+ExecutionQueue::ExecutionQueue()
+	: taskPool(std::make_unique<TaskPool>())
+	, injection(std::make_unique<InjectionQueue>())
+	, attachedCount(0)
+	, workerSlotsUsed(0)
+	, queuedCount(0)
+	, sleepingCount(0)
+	, aborted(false)
 {
-	std::unique_lock<std::mutex> lock(mutex);
-	hasTasks.store(false);
-	Vector<TaskBase> tasks(queue.begin(), queue.end());
-	queue.clear();
-	return tasks;
 }
 
+ExecutionQueue::~ExecutionQueue() = default;
+
 void ExecutionQueue::addToQueue(TaskBase task)
 {
 #if HAS_THREADS
-	std::unique_lock<std::mutex> lock(mutex);
-	queue.emplace_back(task);
-	hasTasks.store(true);
+	auto* node = taskPool->alloc();
+	node->task = std::move(task);
+
+	// The local deque is popped newest-first, which is only fine when other workers can pick up the older tasks
+	if (currentQueue == this && attachedCount > 1) {
+		workers[currentWorkerIndex]->push(node);
+	} else {
+		injection->push(node);
+	}
 
-	condition.notify_one();
+	// Both sides are sequentially consistent: either we see the sleeper, or the sleeper sees the task
+	++queuedCount;
+	if (sleepingCount > 0) {
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		condition.notify_one();
+	}
 #else
 	task();
 #endif
 }
 
+ExecutionQueue::TaskNode* ExecutionQueue::tryGetTask(Worker* self)
+{
+	TaskNode* task = self ? self->pop() : nullptr;
+	if (!task) {
+		task = injection->pop();
+	}
+	if (!task) {
+		task = trySteal(self);
+	}
+	if (task) {
+		--queuedCount;
+	}
+	return task;
+}
+
+ExecutionQueue::TaskNode* ExecutionQueue::trySteal(Worker* self)
+{
+	const size_t n = workerSlotsUsed.load(std::memory_order_acquire);
+	if (n == 0) {
+		return nullptr;
+	}
+
+	// Start at a different victim on each worker, so thieves don't all pile on the same deque
+	const size_t start = self ? currentWorkerIndex + 1 : 0;
+	for (size_t i = 0; i < n; ++i) {
+		auto& victim = workers[(start + i) % n];
+		if (victim && victim.get() != self) {
+			if (auto* task = victim->steal()) {
+				return task;
+			}
+		}
+	}
+	return nullptr;
+}
+
+TaskBase ExecutionQueue::getNext(size_t workerIndex)
+{
+	Worker* self = workers[workerIndex].get();
+	currentQueue = this;
+	currentWorkerIndex = workerIndex;
+
+	while (!aborted) {
+		if (auto* task = tryGetTask(self)) {
+			return takeTask(task);
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		++sleepingCount;
+		if (queuedCount <= 0 && !aborted) {
+			condition.wait(lock);
+		}
+		--sleepingCount;
+	}
+
+	return TaskBase([] () {});
+}
+
+Vector<TaskBase> ExecutionQueue::getAll()
+{
+	Vector<TaskBase> tasks;
+	while (auto* task = tryGetTask(nullptr)) {
+		tasks.push_back(takeTask(task));
+	}
+	return tasks;
+}
+
+TaskBase ExecutionQueue::takeTask(TaskNode* node)
+{
+	TaskBase result = std::move(node->task);
+	taskPool->free(node);
+	return result;
+}
+
 Executors& Executors::get()
 {
 	if (!instance) {
@@ -72,20 +427,36 @@ size_t ExecutionQueue::threadCount() const
 	return attachedCount.load();
 }
 
-void ExecutionQueue::onAttached()
+size_t ExecutionQueue::onAttached()
 {
+	std::unique_lock<std::mutex> lock(workersMutex);
 	++attachedCount;
+
+	// Slots of detached executors are reused; their deques might still hold tasks, which the new owner will pick up
+	for (size_t i = 0; i < maxWorkers; ++i) {
+		if (!workers[i]) {
+			workers[i] = std::make_unique<Worker>();
+			workerSlotsUsed.store(i + 1, std::memory_order_release);
+		}
+		if (!workers[i]->inUse) {
+			workers[i]->inUse = true;
+			return i;
+		}
+	}
+	throw Exception("Too many executors attached to execution queue", HalleyExceptions::Concurrency);
 }
 
-void ExecutionQueue::onDetached()
+void ExecutionQueue::onDetached(size_t workerIndex)
 {
+	std::unique_lock<std::mutex> lock(workersMutex);
 	--attachedCount;
+	workers[workerIndex]->inUse = false;
 }
 
 void ExecutionQueue::abort()
 {
 	{
-		std::unique_lock<std::mutex> lock(mutex);
+		std::unique_lock<std::mutex> lock(sleepMutex);
 		if (aborted) {
 			return;
 		}
@@ -102,16 +473,17 @@ ExecutionQueue& ExecutionQueue::getDefault()
 Executor::Executor(ExecutionQueue& queue)
 	: queue(queue)
 	, running(true)
+	, workerIndex(0)
 {
 #if HAS_THREADS
-	queue.onAttached();
+	workerIndex = queue.onAttached();
 #endif
 }
 
 Executor::~Executor()
 {
 #if HAS_THREADS
-	queue.onDetached();
+	queue.onDetached(workerIndex);
 #endif
 }
 
@@ -131,7 +503,7 @@ void Executor::runForever()
 #if HAS_THREADS
 	try {
 		while (running)	{
-			auto next = queue.getNext();
+			auto next = queue.getNext(workerIndex);
 			if (running) {
 				next();
 			}
@@ -0,0 +1,114 @@
+#include "halley/file/memory_mapped_file.h"
+
+using namespace Halley;
+
+#if defined(_WIN32) && !defined(WINDOWS_STORE)
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+std::shared_ptr<MemoryMappedFile> MemoryMappedFile::open(const Path& path)
+{
+	auto result = std::shared_ptr<MemoryMappedFile>(new MemoryMappedFile());
+
+	// Sharing delete access lets the file be renamed over while mapped, which is how packs get replaced
+	const HANDLE file = CreateFileW(path.getNativeString().getUTF16().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return {};
+	}
+	result->fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		return {};
+	}
+	result->size = static_cast<size_t>(fileSize.QuadPart);
+
+	result->mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!result->mappingHandle) {
+		return {};
+	}
+
+	result->data = static_cast<const gsl::byte*>(MapViewOfFile(result->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!result->data) {
+		return {};
+	}
+
+	return result;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle) {
+		CloseHandle(fileHandle);
+	}
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::shared_ptr<MemoryMappedFile> MemoryMappedFile::open(const Path& path)
+{
+	const int fd = ::open(path.string().c_str(), O_RDONLY);
+	if (fd < 0) {
+		return {};
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0) {
+		::close(fd);
+		return {};
+	}
+
+	const auto size = static_cast<size_t>(fileStat.st_size);
+	void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps the file referenced
+	if (mapped == MAP_FAILED) {
+		return {};
+	}
+
+	auto result = std::shared_ptr<MemoryMappedFile>(new MemoryMappedFile());
+	result->data = static_cast<const gsl::byte*>(mapped);
+	result->size = size;
+	return result;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (data) {
+		munmap(const_cast<gsl::byte*>(data), size);
+	}
+}
+
+#else
+
+std::shared_ptr<MemoryMappedFile> MemoryMappedFile::open(const Path& path)
+{
+	return {};
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+}
+
+#endif
+
+gsl::span<const gsl::byte> MemoryMappedFile::getSpan() const
+{
+	return gsl::span<const gsl::byte>(data, size);
+}
+
+size_t MemoryMappedFile::getSize() const
+{
+	return size;
+}
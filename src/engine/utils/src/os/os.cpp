@@ -27,6 +27,7 @@
 #include "os_linux.h"
 #include "os_freebsd.h"
 #include "halley/support/exception.h"
+#include <cstdio>
 #include <fstream>
 
 using namespace Halley;
@@ -112,9 +113,18 @@ void OS::createDirectories(const Path& path)
 
 void OS::atomicWriteFile(const Path& path, gsl::span<const gsl::byte> data, std::optional<Path> backupOldVersionPath)
 {
-	std::ofstream fp(path.string(), std::ios::binary | std::ios::out);
-	fp.write(reinterpret_cast<const char*>(data.data()), data.size());
-	fp.close();
+	// Write next to it and rename over, so readers (including anyone who has it memory mapped) never see a half-written or truncated file
+	const auto temp = path.replaceExtension(path.getExtension() + ".tmp");
+	{
+		std::ofstream fp(temp.string(), std::ios::binary | std::ios::out);
+		fp.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	if (std::rename(temp.string().c_str(), path.string().c_str()) != 0) {
+		std::remove(temp.string().c_str());
+		std::ofstream fp(path.string(), std::ios::binary | std::ios::out);
+		fp.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
 }
 
 Vector<Path> OS::enumerateDirectory(const Path& path)
@@ -34,6 +34,14 @@ ResourceDataStatic::ResourceDataStatic(const void* _data, size_t _size, String p
 	set(_data, _size, owning);
 }
 
+ResourceDataStatic::ResourceDataStatic(std::shared_ptr<const char> data, size_t size, String path)
+	: ResourceData(path)
+	, data(std::move(data))
+	, size(size)
+	, loaded(true)
+{
+}
+
 static void deleter(const char* data)
 {
 	delete[] data;
@@ -122,6 +130,7 @@ ResourceLoader::ResourceLoader(ResourceLoader&& loader) noexcept
 	, name(std::move(loader.name))
 	, priority(loader.priority)
 	, api(loader.api)
+	, prefetched(std::move(loader.prefetched))
 {
 }
 
@@ -142,6 +151,11 @@ ResourceLoader::ResourceLoader(IResourceLocator& locator, const String& name, As
 
 std::unique_ptr<ResourceDataStatic> ResourceLoader::getStatic(bool throwOnFail)
 {
+	if (prefetched) {
+		loaded = true;
+		return std::move(prefetched);
+	}
+
 	auto result = locator.getStatic(name, type, throwOnFail);
 	if (result) {
 		if (metadata && metadata->getString("asset_compression", "") == "deflate") {
@@ -169,8 +183,12 @@ std::unique_ptr<ResourceDataStream> ResourceLoader::getStream(bool throwOnFail)
 	return result;
 }
 
-Future<std::unique_ptr<ResourceDataStatic>> ResourceLoader::getAsync(bool throwOnFail) const
+Future<std::unique_ptr<ResourceDataStatic>> ResourceLoader::getAsync(bool throwOnFail)
 {
+	if (prefetched) {
+		return Future<std::unique_ptr<ResourceDataStatic>>::makeImmediate(std::move(prefetched));
+	}
+
 	std::reference_wrapper<IResourceLocator> loc = locator;
 	auto n = name;
 	auto t = type;
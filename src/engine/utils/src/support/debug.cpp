@@ -250,5 +250,5 @@ void Debug::printLastTraces()
 	}
 }
 
-std::array<DebugTraceEntry, 16> Debug::lastTraces;
-int Debug::tracePos = 0;
+thread_local std::array<DebugTraceEntry, 16> Debug::lastTraces;
+thread_local int Debug::tracePos = 0;
@@ -64,7 +64,7 @@ void AsioUDPConnection::send(TransmissionType type, OutboundNetworkPacket packet
 		packet.addHeader(gsl::as_bytes(gsl::span<unsigned char>(id).subspan(0, len)));
 
 		bool needsSend = pendingSend.empty();
-		pendingSend.emplace_back(std::move(packet));
+		pendingSend.push_back(std::move(packet));
 		if (needsSend) {
 			sendNext();
 		}
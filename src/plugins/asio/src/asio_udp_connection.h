@@ -10,7 +10,6 @@
 #define BOOST_ERROR_CODE_HEADER_ONLY
 #include <boost/asio.hpp>
 
-#include <deque>
 #include <array>
 #include <string>
 #include <gsl/gsl>
@@ -47,8 +46,8 @@ namespace Halley
 		ConnectionStatus status;
 		short connectionId;
 
-		std::deque<OutboundNetworkPacket> pendingSend;
-		std::deque<InboundNetworkPacket> pendingReceive;
+		NetworkPacketQueue<OutboundNetworkPacket> pendingSend;
+		NetworkPacketQueue<InboundNetworkPacket> pendingReceive;
 		std::array<gsl::byte, 2048> sendBuffer;
 		std::string error;
 
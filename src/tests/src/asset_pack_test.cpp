@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include <fstream>
+using namespace Halley;
+
+namespace {
+	Path writeTestPack()
+	{
+		AssetPack pack;
+		const String contents = "hello, packed world";
+		auto& data = pack.getData();
+		data.resize(contents.size());
+		memcpy(data.data(), contents.c_str(), contents.size());
+
+		AssetDatabase::Entry entry;
+		entry.path = "7:6";
+		pack.getAssetDatabase().addAsset("packed", AssetType::TextFile, std::move(entry));
+
+		const auto path = Path("asset_pack_test.dat");
+		const auto bytes = pack.writeOut();
+		std::ofstream out(path.string(), std::ios::binary);
+		out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		return path;
+	}
+}
+
+TEST(HalleyAssetPack, MemoryMapped)
+{
+	const auto path = writeTestPack();
+	{
+		auto file = MemoryMappedFile::open(path);
+		ASSERT_NE(file, nullptr);
+		const auto mapping = file->getSpan();
+
+		AssetPack pack(file);
+		file.reset();
+		EXPECT_TRUE(pack.isMemoryMapped());
+
+		auto data = pack.getData("packed", AssetType::TextFile, false);
+		auto& staticData = dynamic_cast<ResourceDataStatic&>(*data);
+		EXPECT_EQ(staticData.getString(), "packed");
+
+		// No copy, the data points into the mapping
+		const auto* ptr = staticData.getSpan().data();
+		EXPECT_GE(ptr, mapping.data());
+		EXPECT_LT(ptr, mapping.data() + mapping.size());
+
+		auto stream = pack.getData("packed", AssetType::TextFile, true);
+		auto bytes = dynamic_cast<ResourceDataStream&>(*stream).getReader()->readAll();
+		EXPECT_EQ(String(reinterpret_cast<const char*>(bytes.data()), bytes.size()), "packed");
+	}
+	std::remove(path.string().c_str());
+}
+
+TEST(HalleyAssetPack, MappingSurvivesReplacement)
+{
+	HalleyStatics statics;
+	statics.setupGlobals();
+
+	const auto path = writeTestPack();
+	{
+		AssetPack pack(MemoryMappedFile::open(path));
+		ASSERT_TRUE(pack.isMemoryMapped());
+		auto data = pack.getData("packed", AssetType::TextFile, false);
+
+		// Written next to it and renamed over, so the old mapping still sees the old contents
+		Path::writeFile(path, String("replaced"));
+		EXPECT_EQ(dynamic_cast<ResourceDataStatic&>(*data).getString(), "packed");
+		EXPECT_EQ(String(reinterpret_cast<const char*>(Path::readFile(path).data()), 8), "replaced");
+	}
+	std::remove(path.string().c_str());
+}
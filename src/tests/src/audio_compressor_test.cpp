@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "audio_compressor.h"
+#include "halley/core/properties/audio_properties.h"
+using namespace Halley;
+
+namespace {
+	AudioCompressor makeCompressor()
+	{
+		ConfigNode::MapType node;
+		node["threshold"] = -20.0f;
+		node["ratio"] = 10.0f;
+		node["attack"] = 0.0f;
+		node["release"] = 0.0f;
+
+		AudioCompressor compressor;
+		compressor.setParameters(AudioCompressorProperties(ConfigNode(std::move(node))));
+		return compressor;
+	}
+
+	AudioBuffer makeBuffer(size_t n, float value)
+	{
+		AudioBuffer result;
+		result.samples.resize(n, value);
+		return result;
+	}
+}
+
+TEST(HalleyAudioCompressor, CompressesOwnInput)
+{
+	auto compressor = makeCompressor();
+	ASSERT_TRUE(compressor.isEnabled());
+
+	auto loud = makeBuffer(64, 1.0f);
+	auto quiet = makeBuffer(64, 0.05f);
+	AudioBuffer* buffers[] = { &loud, &quiet };
+	compressor.process(buffers, buffers, 64);
+
+	// Linked across channels, so the quiet one is turned down by the loud one's peak
+	EXPECT_LT(loud.samples[63], 0.2f);
+	EXPECT_NEAR(quiet.samples[63] / 0.05f, loud.samples[63], 0.0001f);
+}
+
+TEST(HalleyAudioCompressor, DucksOffSidechain)
+{
+	auto compressor = makeCompressor();
+
+	auto music = makeBuffer(64, 0.05f);
+	auto voice = makeBuffer(64, 1.0f);
+	AudioBuffer* buffers[] = { &music };
+	AudioBuffer* key[] = { &voice };
+
+	// Below the threshold on its own, but pushed down while the sidechain is loud
+	compressor.process(buffers, key, 64);
+	EXPECT_LT(music.samples[63], 0.01f);
+	EXPECT_FLOAT_EQ(1.0f, voice.samples[63]);
+
+	// A silent sidechain lets it through untouched
+	music = makeBuffer(64, 0.05f);
+	compressor.process(buffers, {}, 64);
+	EXPECT_FLOAT_EQ(0.05f, music.samples[63]);
+}
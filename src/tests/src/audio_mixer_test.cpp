@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "audio_mixer.h"
+using namespace Halley;
+
+namespace {
+	// Odd lengths, so that every kernel has to hand a remainder over to the scalar loop
+	constexpr size_t testLengths[] = { 1, 7, 17, 1023 };
+
+	Vector<float> makeSignal(size_t n, float range, uint32_t seed)
+	{
+		Vector<float> result(n);
+		uint32_t state = seed;
+		for (auto& v: result) {
+			state = state * 1664525u + 1013904223u;
+			v = (static_cast<float>(state >> 8) / static_cast<float>(1 << 24) * 2.0f - 1.0f) * range;
+		}
+		return result;
+	}
+
+	void expectSame(const Vector<float>& expected, const Vector<float>& actual, const AudioMixerKernels& kernels, size_t n)
+	{
+		ASSERT_EQ(expected.size(), actual.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			EXPECT_FLOAT_EQ(expected[i], actual[i]) << kernels.name << ", n = " << n << ", i = " << i;
+		}
+	}
+
+	template <typename T>
+	void expectSame(const Vector<T>& expected, const Vector<T>& actual, const AudioMixerKernels& kernels, size_t n)
+	{
+		ASSERT_EQ(expected.size(), actual.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			EXPECT_EQ(expected[i], actual[i]) << kernels.name << ", n = " << n << ", i = " << i;
+		}
+	}
+}
+
+TEST(HalleyAudioMixer, ScalarIsFirst)
+{
+	const auto kernels = AudioMixer::getAvailableKernels();
+	ASSERT_FALSE(kernels.empty());
+	EXPECT_EQ(&getAudioMixerKernelsScalar(), kernels[0]);
+	EXPECT_TRUE(std::find(kernels.begin(), kernels.end(), &AudioMixer::getKernels()) != kernels.end());
+}
+
+TEST(HalleyAudioMixer, MixMatchesScalar)
+{
+	const auto& scalar = getAudioMixerKernelsScalar();
+	for (const auto* kernels: AudioMixer::getAvailableKernels()) {
+		for (const auto n: testLengths) {
+			const auto src = makeSignal(n, 1.0f, 1);
+			const auto dst = makeSignal(n, 1.0f, 2);
+
+			auto expected = dst;
+			auto actual = dst;
+			scalar.mix(src.data(), expected.data(), n, 0.7f);
+			kernels->mix(src.data(), actual.data(), n, 0.7f);
+			expectSame(expected, actual, *kernels, n);
+
+			expected = dst;
+			actual = dst;
+			scalar.mixRamp(src.data(), expected.data(), n, 0.2f, 0.001f);
+			kernels->mixRamp(src.data(), actual.data(), n, 0.2f, 0.001f);
+			expectSame(expected, actual, *kernels, n);
+
+			scalar.copyGain(src.data(), expected.data(), n, -0.3f);
+			kernels->copyGain(src.data(), actual.data(), n, -0.3f);
+			expectSame(expected, actual, *kernels, n);
+
+			scalar.copyRamp(src.data(), expected.data(), n, 1.0f, -0.0005f);
+			kernels->copyRamp(src.data(), actual.data(), n, 1.0f, -0.0005f);
+			expectSame(expected, actual, *kernels, n);
+		}
+	}
+}
+
+TEST(HalleyAudioMixer, InterleaveMatchesScalar)
+{
+	const auto& scalar = getAudioMixerKernelsScalar();
+	for (const auto* kernels: AudioMixer::getAvailableKernels()) {
+		for (const auto n: testLengths) {
+			const auto left = makeSignal(n, 1.0f, 3);
+			const auto right = makeSignal(n, 1.0f, 4);
+
+			Vector<float> expected(2 * n);
+			Vector<float> actual(2 * n);
+			scalar.interleaveStereo(left.data(), right.data(), expected.data(), n);
+			kernels->interleaveStereo(left.data(), right.data(), actual.data(), n);
+			expectSame(expected, actual, *kernels, n);
+
+			for (size_t channel = 0; channel < 2; ++channel) {
+				Vector<float> expectedChannel(n);
+				Vector<float> actualChannel(n);
+				scalar.deinterleaveStereo(expected.data(), expectedChannel.data(), n, channel);
+				kernels->deinterleaveStereo(expected.data(), actualChannel.data(), n, channel);
+				expectSame(expectedChannel, actualChannel, *kernels, n);
+				expectSame(channel == 0 ? left : right, actualChannel, *kernels, n);
+			}
+		}
+	}
+}
+
+TEST(HalleyAudioMixer, ConversionMatchesScalar)
+{
+	const auto& scalar = getAudioMixerKernelsScalar();
+	for (const auto* kernels: AudioMixer::getAvailableKernels()) {
+		for (const auto n: testLengths) {
+			// Well outside of [-1, 1], including values that overflow an int32 once scaled
+			auto src = makeSignal(n, 4.0f, 5);
+			const float extremes[] = { 1.0f, -1.0f, 1e6f, -1e6f, 1e20f, -1e20f, 0.99999f };
+			for (size_t i = 0; i < std::size(extremes) && i < n; ++i) {
+				src[(i * 5) % n] = extremes[i];
+			}
+
+			auto expected = src;
+			auto actual = src;
+			scalar.clamp(expected.data(), n, 0.99f);
+			kernels->clamp(actual.data(), n, 0.99f);
+			expectSame(expected, actual, *kernels, n);
+
+			Vector<short> expected16(n);
+			Vector<short> actual16(n);
+			scalar.toInt16(src.data(), expected16.data(), n);
+			kernels->toInt16(src.data(), actual16.data(), n);
+			expectSame(expected16, actual16, *kernels, n);
+
+			Vector<int> expected32(n);
+			Vector<int> actual32(n);
+			scalar.toInt32(src.data(), expected32.data(), n);
+			kernels->toInt32(src.data(), actual32.data(), n);
+			expectSame(expected32, actual32, *kernels, n);
+		}
+	}
+}
+
+TEST(HalleyAudioMixer, ConversionSaturates)
+{
+	const float src[] = { 2.0f, -2.0f, 1e20f, -1e20f, 1.0f, -1.0f, 0.5f, 0.0f };
+	for (const auto* kernels: AudioMixer::getAvailableKernels()) {
+		short dst16[8];
+		kernels->toInt16(src, dst16, 8);
+		EXPECT_EQ(32767, dst16[0]) << kernels->name;
+		EXPECT_EQ(-32768, dst16[1]) << kernels->name;
+		EXPECT_EQ(32767, dst16[2]) << kernels->name;
+		EXPECT_EQ(-32768, dst16[3]) << kernels->name;
+		EXPECT_EQ(32767, dst16[4]) << kernels->name;
+		EXPECT_EQ(-32768, dst16[5]) << kernels->name;
+		EXPECT_EQ(16384, dst16[6]) << kernels->name;
+
+		int dst32[8];
+		kernels->toInt32(src, dst32, 8);
+		EXPECT_EQ(2147483520, dst32[0]) << kernels->name;
+		EXPECT_EQ(std::numeric_limits<int>::min(), dst32[1]) << kernels->name;
+		EXPECT_EQ(2147483520, dst32[2]) << kernels->name;
+		EXPECT_EQ(std::numeric_limits<int>::min(), dst32[3]) << kernels->name;
+		EXPECT_EQ(1 << 30, dst32[6]) << kernels->name;
+	}
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include <chrono>
+#include <thread>
+#include "vorbis/vorbisenc.h"
+#include "halley/audio/vorbis_dec.h"
+#include "audio_stream_decoder.h"
+using namespace Halley;
+
+namespace {
+	class MemoryReader final : public ResourceDataReader {
+	public:
+		explicit MemoryReader(std::shared_ptr<const Bytes> data)
+			: data(std::move(data))
+		{}
+
+		size_t size() const override { return data->size(); }
+		size_t tell() const override { return pos; }
+		void close() override {}
+
+		int read(gsl::span<gsl::byte> dst) override
+		{
+			const size_t n = std::min(static_cast<size_t>(dst.size()), data->size() - pos);
+			memcpy(dst.data(), data->data() + pos, n);
+			pos += n;
+			return static_cast<int>(n);
+		}
+
+		void seek(int64_t offset, int whence) override
+		{
+			const auto base = whence == SEEK_SET ? 0 : (whence == SEEK_CUR ? static_cast<int64_t>(pos) : static_cast<int64_t>(data->size()));
+			pos = static_cast<size_t>(std::clamp(base + offset, int64_t(0), static_cast<int64_t>(data->size())));
+		}
+
+	private:
+		std::shared_ptr<const Bytes> data;
+		size_t pos = 0;
+	};
+
+	void writePage(Bytes& dst, const ogg_page& page)
+	{
+		dst.insert(dst.end(), page.header, page.header + page.header_len);
+		dst.insert(dst.end(), page.body, page.body + page.body_len);
+	}
+
+	// A stereo clip, with a different tone on each channel so they can't be mixed up
+	Bytes encodeTestClip(size_t numSamples)
+	{
+		Bytes result;
+		ogg_stream_state os;
+		ogg_stream_init(&os, 0);
+		vorbis_info vi;
+		vorbis_info_init(&vi);
+		vorbis_encode_init_vbr(&vi, 2, AudioConfig::sampleRate, 0.5f);
+		vorbis_dsp_state v;
+		vorbis_analysis_init(&v, &vi);
+		vorbis_comment vc;
+		vorbis_comment_init(&vc);
+		vorbis_block vb;
+		vorbis_block_init(&v, &vb);
+
+		ogg_packet header, headerComm, headerCode;
+		vorbis_analysis_headerout(&v, &vc, &header, &headerComm, &headerCode);
+		ogg_stream_packetin(&os, &header);
+		ogg_stream_packetin(&os, &headerComm);
+		ogg_stream_packetin(&os, &headerCode);
+		ogg_page page;
+		while (ogg_stream_flush(&os, &page) != 0) {
+			writePage(result, page);
+		}
+
+		float** buffers = vorbis_analysis_buffer(&v, static_cast<int>(numSamples));
+		for (size_t i = 0; i < numSamples; ++i) {
+			buffers[0][i] = 0.5f * std::sin(static_cast<float>(i) * 0.05f);
+			buffers[1][i] = 0.5f * std::cos(static_cast<float>(i) * 0.13f);
+		}
+		vorbis_analysis_wrote(&v, static_cast<int>(numSamples));
+		vorbis_analysis_wrote(&v, 0);
+
+		ogg_packet packet;
+		while (vorbis_analysis_blockout(&v, &vb) == 1) {
+			vorbis_analysis(&vb, nullptr);
+			vorbis_bitrate_addblock(&vb);
+			while (vorbis_bitrate_flushpacket(&v, &packet)) {
+				ogg_stream_packetin(&os, &packet);
+				while (ogg_stream_pageout(&os, &page) != 0) {
+					writePage(result, page);
+				}
+			}
+		}
+		while (ogg_stream_flush(&os, &page) != 0) {
+			writePage(result, page);
+		}
+
+		ogg_stream_clear(&os);
+		vorbis_block_clear(&vb);
+		vorbis_dsp_clear(&v);
+		vorbis_comment_clear(&vc);
+		vorbis_info_clear(&vi);
+		return result;
+	}
+
+	std::shared_ptr<ResourceDataStream> makeStream(std::shared_ptr<const Bytes> data)
+	{
+		return std::make_shared<ResourceDataStream>("test.ogg", [data] () { return std::make_unique<MemoryReader>(data); });
+	}
+}
+
+TEST(HalleyAudioStreamDecoder, LoopsToStartWithoutGaps)
+{
+	HalleyStatics statics;
+	statics.resume(nullptr, 2);
+
+	{
+		constexpr size_t clipLength = 3000;
+		constexpr size_t blockSize = 512;
+		const auto data = std::make_shared<const Bytes>(encodeTestClip(clipLength));
+
+		// What the clip sounds like when decoded in one go
+		VorbisData reference(makeStream(data), true);
+		ASSERT_EQ(clipLength, reference.getNumSamples());
+		Vector<Vector<float>> expected(2, Vector<float>(clipLength));
+		ASSERT_EQ(clipLength, reference.read(expected));
+
+		auto decoder = std::make_shared<AudioStreamDecoder>(makeStream(data), 0, 0);
+		decoder->start();
+
+		// Plays through the clip several times like a looping AudioSourceClip would, wrapping back to 0 without ever waiting on the decoder
+		Vector<float> dst(blockSize);
+		size_t pos = 0;
+		for (size_t block = 0; block < 60; ++block) {
+			const size_t len = std::min(blockSize, clipLength - pos);
+			for (size_t channel = 0; channel < 2; ++channel) {
+				decoder->read(channel, pos, len, 1.0f, 1.0f, AudioSamples(dst).subspan(0, len));
+				for (size_t i = 0; i < len; ++i) {
+					ASSERT_NEAR(expected[channel][pos + i], dst[i], 0.0001f) << "block " << block << ", channel " << channel << ", sample " << (pos + i);
+				}
+			}
+
+			pos += len;
+			if (pos == clipLength) {
+				pos = 0;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+
+		decoder->abort();
+	}
+
+	statics.suspend();
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	// Laid out the way codegen emits a component with "replicated: true" on position and health only
+	class ReplicatedTestComponent final : public Component {
+	public:
+		static constexpr int componentIndex{ 0 };
+		static constexpr const char* componentName{ "ReplicatedTest" };
+		static constexpr size_t replicatedFieldCount{ 2 };
+
+		Vector2f position;
+		String name;
+		int health = 0;
+
+		ConfigNode serialize(const EntitySerializationContext&) const
+		{
+			return {};
+		}
+
+		void serializeReplicatedField(Serializer& s, size_t field) const
+		{
+			switch (field) {
+			case 0: s << position; break;
+			case 1: s << health; break;
+			}
+		}
+
+		void deserializeReplicatedField(Deserializer& s, size_t field)
+		{
+			switch (field) {
+			case 0: s >> position; break;
+			case 1: s >> health; break;
+			}
+		}
+	};
+
+	Bytes serializeFields(const ComponentReflector& reflector, const Component& component, uint64_t mask)
+	{
+		return Serializer::toBytes([&] (Serializer& s)
+		{
+			for (size_t i = 0; i < reflector.getReplicatedFieldCount(); ++i) {
+				if (mask & (uint64_t(1) << i)) {
+					reflector.serializeReplicatedField(s, component, i);
+				}
+			}
+		});
+	}
+
+	void deserializeFields(const ComponentReflector& reflector, Component& component, uint64_t mask, const Bytes& bytes)
+	{
+		auto s = Deserializer(bytes);
+		for (size_t i = 0; i < reflector.getReplicatedFieldCount(); ++i) {
+			if (mask & (uint64_t(1) << i)) {
+				reflector.deserializeReplicatedField(s, component, i);
+			}
+		}
+	}
+}
+
+TEST(HalleyComponentReflector, ReplicatedFieldsRoundTrip)
+{
+	const ComponentReflectorImpl<ReplicatedTestComponent> reflector;
+	ASSERT_EQ(reflector.getReplicatedFieldCount(), 2);
+
+	ReplicatedTestComponent src;
+	src.position = Vector2f(3.5f, -7.25f);
+	src.name = "only sent through the regular entity delta";
+	src.health = 42;
+
+	const auto bytes = serializeFields(reflector, src, 0b11);
+	EXPECT_EQ(bytes.size(), Serializer::toBytes(src.position).size() + Serializer::toBytes(src.health).size());
+
+	ReplicatedTestComponent dst;
+	dst.name = "untouched";
+	deserializeFields(reflector, dst, 0b11, bytes);
+	EXPECT_EQ(dst.position, src.position);
+	EXPECT_EQ(dst.health, src.health);
+	EXPECT_EQ(dst.name, "untouched");
+}
+
+TEST(HalleyComponentReflector, ReplicatedFieldMaskSkipsUnchangedFields)
+{
+	const ComponentReflectorImpl<ReplicatedTestComponent> reflector;
+
+	ReplicatedTestComponent src;
+	src.position = Vector2f(1, 2);
+	src.health = 10;
+
+	const auto bytes = serializeFields(reflector, src, 0b10);
+	EXPECT_EQ(bytes.size(), Serializer::toBytes(src.health).size());
+
+	ReplicatedTestComponent dst;
+	dst.position = Vector2f(5, 6);
+	deserializeFields(reflector, dst, 0b10, bytes);
+	EXPECT_EQ(dst.position, Vector2f(5, 6));
+	EXPECT_EQ(dst.health, 10);
+}
@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+TEST(HalleyCompression, LZ4DictionaryRoundTrip)
+{
+	SerializationDictionary dict;
+	dict.addEntries(std::array<String, 3>{ "transform", "velocity", "sprite" });
+	const auto dictBytes = dict.makeCompressionDictionary();
+	EXPECT_EQ(String(reinterpret_cast<const char*>(dictBytes.data()), dictBytes.size()), "spritevelocitytransform");
+
+	const String text = "transform velocity sprite transform velocity";
+	const auto src = gsl::as_bytes(gsl::span<const char>(text.c_str(), text.size()));
+	const auto dictSpan = gsl::as_bytes(gsl::span<const Byte>(dictBytes));
+
+	Bytes compressed(Compression::lz4CompressBound(src.size()));
+	Bytes compressedNoDict(Compression::lz4CompressBound(src.size()));
+	const auto compressedSize = Compression::lz4Compress(src, gsl::as_writable_bytes(gsl::span<Byte>(compressed)), dictSpan);
+	ASSERT_GT(compressedSize, 0);
+	EXPECT_LT(compressedSize, Compression::lz4Compress(src, gsl::as_writable_bytes(gsl::span<Byte>(compressedNoDict))));
+
+	Bytes decompressed(src.size());
+	const auto result = Compression::lz4Decompress(gsl::as_bytes(gsl::span<const Byte>(compressed)).subspan(0, compressedSize), gsl::as_writable_bytes(gsl::span<Byte>(decompressed)), dictSpan);
+	ASSERT_EQ(result, src.size());
+	EXPECT_EQ(String(reinterpret_cast<const char*>(decompressed.data()), decompressed.size()), text);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	class TestExecutors {
+	public:
+		TestExecutors(ExecutionQueue& queue, size_t nThreads)
+		{
+			for (size_t i = 0; i < nThreads; ++i) {
+				executors.push_back(std::make_unique<Executor>(queue));
+			}
+			for (auto& e: executors) {
+				threads.emplace_back([&e] () { e->runForever(); });
+			}
+		}
+
+		~TestExecutors()
+		{
+			for (auto& e: executors) {
+				e->stop();
+			}
+			for (auto& t: threads) {
+				t.join();
+			}
+		}
+
+	private:
+		Vector<std::unique_ptr<Executor>> executors;
+		Vector<std::thread> threads;
+	};
+}
+
+TEST(HalleyConcurrent, ParallelForVisitsEveryElementOnce)
+{
+	ExecutionQueue queue;
+	TestExecutors executors(queue, 3);
+
+	constexpr size_t n = 1000;
+	std::vector<std::atomic<int>> visits(n);
+	std::vector<std::atomic<int>> chunks((n + 6) / 7);
+	Concurrent::parallelFor(queue, n, 7, [&] (size_t chunk, size_t start, size_t end)
+	{
+		EXPECT_EQ(start, chunk * 7);
+		++chunks[chunk];
+		for (size_t i = start; i < end; ++i) {
+			++visits[i];
+		}
+	});
+
+	for (auto& v: visits) {
+		EXPECT_EQ(v.load(), 1);
+	}
+	for (auto& c: chunks) {
+		EXPECT_EQ(c.load(), 1);
+	}
+}
+
+TEST(HalleyConcurrent, ParallelForWithoutThreads)
+{
+	ExecutionQueue queue;
+	size_t total = 0;
+	Concurrent::parallelFor(queue, 10, 3, [&] (size_t, size_t start, size_t end)
+	{
+		total += end - start;
+	});
+	EXPECT_EQ(total, 10);
+}
+
+TEST(HalleyConcurrent, ParallelForRethrows)
+{
+	ExecutionQueue queue;
+	TestExecutors executors(queue, 2);
+
+	EXPECT_THROW(Concurrent::parallelFor(queue, 100, 1, [&] (size_t chunk, size_t, size_t)
+	{
+		if (chunk == 50) {
+			throw Exception("Test", HalleyExceptions::Concurrency);
+		}
+	}), Exception);
+}
+
+TEST(HalleyConcurrent, TaskBaseStoresMoveOnlyFunctors)
+{
+	int result = 0;
+	auto value = std::make_unique<int>(42);
+	TaskBase small([&result, value = std::move(value)] () { result = *value; });
+	TaskBase moved = std::move(small);
+	EXPECT_FALSE(small);
+	moved();
+	EXPECT_EQ(result, 42);
+
+	std::array<int, 64> big;
+	big.fill(1);
+	TaskBase large([&result, big] () { result = big[63] + 1; });
+	large();
+	EXPECT_EQ(result, 2);
+}
+
+TEST(HalleyConcurrent, ExecutionQueueRunsNestedTasks)
+{
+	ExecutionQueue queue;
+	TestExecutors executors(queue, 4);
+
+	constexpr int nOuter = 200;
+	constexpr int nInner = 20;
+	std::atomic<int> count = 0;
+
+	Vector<Future<void>> futures;
+	for (int i = 0; i < nOuter; ++i) {
+		futures.push_back(Concurrent::execute(queue, [&] () {
+			// Queued from inside a worker, so these go to its own deque and get stolen by the others
+			Vector<Future<void>> inner;
+			for (int j = 0; j < nInner; ++j) {
+				inner.push_back(Concurrent::execute(queue, [&] () { ++count; }));
+			}
+			++count;
+		}));
+	}
+	Concurrent::whenAll(futures.begin(), futures.end()).wait();
+
+	while (count < nOuter * (nInner + 1)) {
+		std::this_thread::yield();
+	}
+	EXPECT_EQ(count.load(), nOuter * (nInner + 1));
+}
+
+TEST(HalleyConcurrent, SingleThreadQueueKeepsOrder)
+{
+	ExecutionQueue queue;
+	TestExecutors executors(queue, 1);
+
+	// Hold the worker, so that the tasks pile up past the injection ring and spill over
+	std::atomic<bool> release = false;
+	Concurrent::execute(queue, [&] () {
+		while (!release) {
+			std::this_thread::yield();
+		}
+	});
+
+	constexpr static int n = 10000;
+	Vector<int> order;
+	Vector<Future<void>> futures;
+	for (int i = 0; i < n; ++i) {
+		futures.push_back(Concurrent::execute(queue, [&order, &queue, i] () {
+			order.push_back(i);
+			if (i == 0) {
+				// Queued from inside the worker, so it must still go after everything already queued
+				Concurrent::execute(queue, [&order] () { order.push_back(n); });
+			}
+		}));
+	}
+	release = true;
+	Concurrent::whenAll(futures.begin(), futures.end()).wait();
+	Concurrent::execute(queue, [] () {}).wait();
+
+	ASSERT_EQ(order.size(), size_t(n + 1));
+	for (int i = 0; i <= n; ++i) {
+		EXPECT_EQ(order[i], i);
+	}
+}
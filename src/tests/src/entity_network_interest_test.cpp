@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "halley/net/entity/entity_network_interest.h"
+
+using namespace Halley;
+
+namespace {
+	Vector<EntityNetworkInterestGrid::Relevant> query(const EntityNetworkInterestGrid& grid, Rect4i view, gsl::span<const EntityNetworkInterestTier> tiers)
+	{
+		Vector<EntityNetworkInterestGrid::Relevant> result;
+		grid.query(view, tiers, result);
+		return result;
+	}
+}
+
+TEST(HalleyEntityNetworkInterestGrid, FindsEntitiesInView)
+{
+	EntityNetworkInterestGrid grid(4);
+	grid.add(0, Rect4i(Vector2i(5, 5), Vector2i(5, 5)));
+	grid.add(1, Rect4i(Vector2i(500, 500), Vector2i(510, 510)));
+	grid.add(2, Rect4i(Vector2i(-40, 90), Vector2i(20, 110)));
+	grid.add(3, Rect4i(Vector2i(-1000, -1000), Vector2i(-990, -990)));
+
+	const EntityNetworkInterestTier tiers[] = { EntityNetworkInterestTier(0, 0.0) };
+	const auto result = query(grid, Rect4i(0, 0, 100, 100), tiers);
+
+	ASSERT_EQ(result.size(), 2);
+	EXPECT_EQ(result[0].index, 0);
+	EXPECT_EQ(result[1].index, 2);
+}
+
+TEST(HalleyEntityNetworkInterestGrid, AssignsTiersByDistance)
+{
+	EntityNetworkInterestGrid grid(4);
+	for (uint32_t i = 0; i < 10; ++i) {
+		const auto x = static_cast<int>(i) * 50;
+		grid.add(i, Rect4i(Vector2i(x, 0), Vector2i(x + 1, 1)));
+	}
+
+	const EntityNetworkInterestTier tiers[] = { EntityNetworkInterestTier(0, 0.0), EntityNetworkInterestTier(100, 0.2), EntityNetworkInterestTier(200, 0.5) };
+	const auto result = query(grid, Rect4i(0, 0, 100, 100), tiers);
+
+	// 0-100 in view, 150-200 in the second tier, 250-300 in the third
+	ASSERT_EQ(result.size(), 7);
+	for (const auto& r: result) {
+		EXPECT_EQ(r.tier, r.index <= 2 ? 0 : (r.index <= 4 ? 1 : 2));
+	}
+
+	grid.clear();
+	EXPECT_EQ(grid.size(), 0);
+	EXPECT_TRUE(query(grid, Rect4i(0, 0, 100, 100), tiers).empty());
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "halley/bytes/serialization_dictionary.h"
+#include "halley/entity/entity_data_delta.h"
+#include "halley/net/entity/entity_network_message.h"
+#include "halley/net/entity/entity_network_recorder.h"
+
+using namespace Halley;
+
+namespace {
+	EntityNetworkRecording makeRecording(size_t batches, size_t updatesPerBatch)
+	{
+		SerializationDictionary dictionary;
+		dictionary.addEntry("components");
+
+		auto options = SerializerOptions(SerializerOptions::maxVersion);
+		options.dictionary = &dictionary;
+		const auto deltaBytes = Serializer::toBytes(EntityDataDelta(), options);
+
+		EntityNetworkRecorder recorder;
+		recorder.start(dictionary);
+		for (size_t i = 0; i < batches; ++i) {
+			Vector<EntityNetworkMessage> msgs;
+			for (size_t j = 0; j < updatesPerBatch; ++j) {
+				msgs.push_back(EntityNetworkMessageUpdate(static_cast<EntityNetworkId>(j), deltaBytes));
+			}
+			const auto data = Serializer::toBytes(msgs, options);
+			recorder.record(EntityNetworkRecording::Direction::Sent, -1, gsl::as_bytes(gsl::span<const Byte>(data)));
+		}
+		return recorder.takeRecording();
+	}
+}
+
+TEST(HalleyEntityNetworkRecorder, RoundTrip)
+{
+	const auto recording = makeRecording(3, 4);
+	const auto loaded = EntityNetworkRecording::fromBytes(gsl::as_bytes(gsl::span<const Byte>(recording.toBytes())));
+
+	ASSERT_EQ(loaded.entries.size(), 3);
+	EXPECT_EQ(loaded.dictionary, recording.dictionary);
+	EXPECT_EQ(loaded.entries[1].data, recording.entries[1].data);
+	EXPECT_EQ(loaded.entries[1].peerId, -1);
+	EXPECT_EQ(loaded.entries[1].direction, EntityNetworkRecording::Direction::Sent);
+}
+
+TEST(HalleyEntityNetworkRecorder, ReplayBenchmark)
+{
+	const auto recording = makeRecording(5, 10);
+	const auto result = EntityNetworkReplayBenchmark::run(recording, 2);
+
+	EXPECT_EQ(result.batches, 10);
+	EXPECT_EQ(result.messages, 100);
+	EXPECT_EQ(result.entities, 100);
+	EXPECT_GT(result.wireBytes, 0);
+}
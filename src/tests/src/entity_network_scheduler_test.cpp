@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "halley/net/entity/entity_network_scheduler.h"
+
+using namespace Halley;
+
+namespace {
+	Vector<uint32_t> schedule(Vector<EntityNetworkScheduler::Candidate> candidates, size_t bytesSent, std::optional<size_t> budget)
+	{
+		Vector<uint32_t> result;
+		EntityNetworkScheduler::schedule(candidates, bytesSent, budget, result);
+		return result;
+	}
+}
+
+TEST(HalleyEntityNetworkScheduler, SendsEverythingWithoutBudget)
+{
+	const auto result = schedule({ { 0, 1.0f, 500 }, { 1, 3.0f, 500 }, { 2, 2.0f, 500 } }, 0, std::nullopt);
+
+	const Vector<uint32_t> expected = { 1, 2, 0 };
+	EXPECT_EQ(expected, result);
+}
+
+TEST(HalleyEntityNetworkScheduler, SkipsUpdatesThatDontFit)
+{
+	// The 50 byte one doesn't fit after the 60 byte one, but the 30 byte one still does
+	const auto result = schedule({ { 0, 3.0f, 60 }, { 1, 2.0f, 50 }, { 2, 1.0f, 30 } }, 0, 100);
+
+	const Vector<uint32_t> expected = { 0, 2 };
+	EXPECT_EQ(expected, result);
+}
+
+TEST(HalleyEntityNetworkScheduler, OvershootsBudgetForTopUpdateOnly)
+{
+	// Larger than the whole budget on its own
+	auto result = schedule({ { 0, 1.0f, 10 }, { 1, 5.0f, 300 } }, 0, 100);
+	Vector<uint32_t> expected = { 1 };
+	EXPECT_EQ(expected, result);
+
+	// Creations already used up the budget
+	result = schedule({ { 0, 1.0f, 10 }, { 1, 5.0f, 20 } }, 150, 100);
+	expected = { 1 };
+	EXPECT_EQ(expected, result);
+}
+
+TEST(HalleyEntityNetworkScheduler, DistantEntitiesAreEventuallySent)
+{
+	// Every entity changes every tick, but the budget only fits one update per tick
+	constexpr size_t updateSize = 100;
+	constexpr size_t budget = 150;
+	constexpr Time t = 1.0 / 20.0;
+	const uint8_t tiers[] = { 0, 0, 0, 3 };
+	constexpr size_t n = std::size(tiers);
+
+	float priority[n] = {};
+	size_t lastSent[n] = {};
+	size_t maxWait[n] = {};
+	for (size_t tick = 1; tick <= 200; ++tick) {
+		Vector<EntityNetworkScheduler::Candidate> candidates;
+		for (size_t i = 0; i < n; ++i) {
+			priority[i] = EntityNetworkScheduler::accumulatePriority(priority[i], t, tiers[i]);
+			candidates.push_back({ static_cast<uint32_t>(i), EntityNetworkScheduler::getScore(priority[i], 1), updateSize });
+		}
+
+		const auto sent = schedule(std::move(candidates), 0, budget);
+		ASSERT_EQ(1, sent.size());
+		priority[sent[0]] = 0;
+		maxWait[sent[0]] = std::max(maxWait[sent[0]], tick - lastSent[sent[0]]);
+		lastSent[sent[0]] = tick;
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		EXPECT_GT(lastSent[i], 190) << "entity " << i;
+	}
+
+	// The closest entities win most ticks, but the distant one gets through every so often
+	EXPECT_LE(maxWait[0], 4);
+	EXPECT_GT(maxWait[3], maxWait[0]);
+	EXPECT_LE(maxWait[3], 16);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+TEST(HalleyFamilySlotIndex, SetGetErase)
+{
+	FamilySlotIndex index;
+	const auto a = EntityId(3);
+	const auto b = EntityId(5000);
+
+	EXPECT_EQ(index.get(a), FamilySlotIndex::invalidSlot);
+
+	index.set(a, 0);
+	index.set(b, 1);
+	EXPECT_EQ(index.get(a), 0u);
+	EXPECT_EQ(index.get(b), 1u);
+	EXPECT_EQ(index.get(EntityId(4)), FamilySlotIndex::invalidSlot);
+	EXPECT_EQ(index.get(EntityId(100000)), FamilySlotIndex::invalidSlot);
+
+	index.set(b, 0);
+	index.erase(a);
+	EXPECT_EQ(index.get(a), FamilySlotIndex::invalidSlot);
+	EXPECT_EQ(index.get(b), 0u);
+
+	index.clear();
+	EXPECT_EQ(index.get(b), FamilySlotIndex::invalidSlot);
+}
+
+TEST(HalleyFamilySlotIndex, IgnoresRevision)
+{
+	// Only one revision of an entity index can be alive at once, so the index is keyed by the pool index alone
+	FamilySlotIndex index;
+	const auto id = EntityId(7);
+	const auto sameIndexNewRevision = EntityId(7 | (int64_t(1) << 32));
+
+	index.set(id, 42);
+	index.erase(id);
+	index.set(sameIndexNewRevision, 3);
+	EXPECT_EQ(index.get(sameIndexNewRevision), 3u);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	Bytes makeDictionary(const String& word)
+	{
+		String text;
+		for (int i = 0; i < 64; ++i) {
+			text += word + " " + toString(i) + " ";
+		}
+		return Bytes(reinterpret_cast<const Byte*>(text.c_str()), reinterpret_cast<const Byte*>(text.c_str()) + text.size());
+	}
+
+	class QueuePair {
+	public:
+		QueuePair()
+		{
+			auto [a, b] = LoopbackConnection::makePair();
+			queueA = std::make_unique<MessageQueueUDP>(std::make_shared<AckUnreliableConnection>(a));
+			queueB = std::make_unique<MessageQueueUDP>(std::make_shared<AckUnreliableConnection>(b));
+			queueA->setChannel(0, ChannelSettings(true, true));
+			queueB->setChannel(0, ChannelSettings(true, true));
+		}
+
+		// Sends a message from one end, and returns what the other end got
+		Vector<String> send(MessageQueueUDP& from, MessageQueueUDP& to, const String& msg)
+		{
+			from.enqueue(OutboundNetworkPacket(gsl::as_bytes(gsl::span<const char>(msg.c_str(), msg.size()))), 0);
+			from.sendAll();
+			return receive(to);
+		}
+
+		Vector<String> receive(MessageQueueUDP& to)
+		{
+			Vector<String> result;
+			for (auto& packet: to.receivePackets()) {
+				const auto bytes = packet.getBytes();
+				result.push_back(String(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+			}
+			return result;
+		}
+
+		std::unique_ptr<MessageQueueUDP> queueA;
+		std::unique_ptr<MessageQueueUDP> queueB;
+	};
+}
+
+TEST(HalleyMessageQueueUDP, CompressesOnceBothEndsAgree)
+{
+	QueuePair pair;
+	auto& a = *pair.queueA;
+	auto& b = *pair.queueB;
+	const auto dictionary = makeDictionary("hello world");
+	a.setCompression(true, dictionary);
+	b.setCompression(true, dictionary);
+
+	const String msg = "hello world 1 hello world 2 hello world 3 hello world 4";
+	EXPECT_EQ(pair.send(a, b, msg), Vector<String>{ msg });
+	EXPECT_FALSE(a.isCompressionActive());
+
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_TRUE(a.isCompressionActive());
+	EXPECT_EQ(pair.send(a, b, msg), Vector<String>{ msg });
+	EXPECT_EQ(a.getCompressionStats().packetsCompressed, 1);
+}
+
+TEST(HalleyMessageQueueUDP, KeepsDecodingAfterCompressionIsDisabled)
+{
+	QueuePair pair;
+	auto& a = *pair.queueA;
+	auto& b = *pair.queueB;
+	const auto dictionary = makeDictionary("hello world");
+	a.setCompression(true, dictionary);
+	b.setCompression(true, dictionary);
+
+	const String msg = "hello world 1 hello world 2 hello world 3 hello world 4";
+	pair.send(a, b, msg);
+	pair.send(b, a, msg);
+
+	// B hasn't heard about it yet, so it still compresses
+	a.setCompression(false);
+	const auto compressed = b.getCompressionStats().packetsCompressed;
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_EQ(b.getCompressionStats().packetsCompressed, compressed + 1);
+	EXPECT_TRUE(a.isConnected());
+
+	pair.send(a, b, msg);
+	EXPECT_FALSE(b.isCompressionActive());
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_EQ(b.getCompressionStats().packetsCompressed, compressed + 1);
+}
+
+TEST(HalleyMessageQueueUDP, SwitchesDictionaries)
+{
+	QueuePair pair;
+	auto& a = *pair.queueA;
+	auto& b = *pair.queueB;
+	const auto dictionary1 = makeDictionary("hello world");
+	const auto dictionary2 = makeDictionary("goodbye world");
+	a.setCompression(true, dictionary1);
+	b.setCompression(true, dictionary1);
+
+	const String msg = "hello world 1 goodbye world 2 hello world 3 goodbye world 4";
+	pair.send(a, b, msg);
+	pair.send(b, a, msg);
+
+	// B still compresses with the old dictionary until it hears from A
+	a.setCompression(true, dictionary2);
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_EQ(pair.send(a, b, msg), Vector<String>{ msg });
+	EXPECT_FALSE(a.isCompressionActive());
+	EXPECT_FALSE(b.isCompressionActive());
+
+	b.setCompression(true, dictionary2);
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_TRUE(a.isCompressionActive());
+	EXPECT_EQ(pair.send(a, b, msg), Vector<String>{ msg });
+	EXPECT_TRUE(b.isCompressionActive());
+	EXPECT_EQ(pair.send(b, a, msg), Vector<String>{ msg });
+	EXPECT_TRUE(a.isConnected());
+	EXPECT_TRUE(b.isConnected());
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	String toText(gsl::span<const gsl::byte> bytes)
+	{
+		return String(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	}
+
+	gsl::span<const gsl::byte> fromText(const char* text)
+	{
+		return gsl::as_bytes(gsl::span<const char>(text, strlen(text)));
+	}
+}
+
+TEST(HalleyNetworkPacket, SharedBufferCopyOnWrite)
+{
+	auto a = OutboundNetworkPacket(fromText("payload"));
+	auto b = a;
+	EXPECT_EQ(a.getBytes().data(), b.getBytes().data());
+
+	b.addHeader(fromText("h:"));
+	EXPECT_EQ(toText(a.getBytes()), "payload");
+	EXPECT_EQ(toText(b.getBytes()), "h:payload");
+
+	auto c = OutboundNetworkPacket::allocate(16);
+	const auto dst = c.getWritableBytes();
+	memcpy(dst.data(), "abc", 3);
+	c.resize(3);
+	EXPECT_EQ(toText(c.getBytes()), "abc");
+}
+
+TEST(HalleyNetworkPacket, InboundSlice)
+{
+	auto packet = InboundNetworkPacket(fromText("headerbody"));
+	auto body = packet.slice(6, 4);
+	EXPECT_EQ(body.getBytes().data(), packet.getBytes().data() + 6);
+
+	packet = InboundNetworkPacket();
+	EXPECT_EQ(toText(body.getBytes()), "body");
+
+	NetworkPacketQueue<InboundNetworkPacket> queue;
+	for (int i = 0; i < 100; ++i) {
+		queue.push_back(body.slice(i % 4, 1));
+		if (i % 2 == 1) {
+			queue.pop_front();
+		}
+	}
+	EXPECT_EQ(queue.size(), 50);
+	EXPECT_EQ(toText(queue.front().getBytes()), "d");
+}
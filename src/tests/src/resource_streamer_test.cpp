@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+namespace {
+	// No worker threads are attached, so each test decides when the disk and CPU tasks run
+	class HalleyResourceStreamer : public ::testing::Test {
+	protected:
+		void SetUp() override
+		{
+			statics.setupGlobals();
+			resources = std::make_unique<Resources>(nullptr, api, ResourceOptions());
+			resources->init<TextFile>();
+			resources->of<TextFile>().setResourceLoader([this] (std::string_view assetId, ResourceLoadPriority) -> std::shared_ptr<Resource>
+			{
+				loaded.push_back(String(assetId));
+				if (failing.contains(String(assetId))) {
+					throw Exception("Failed to load " + String(assetId), HalleyExceptions::Resources);
+				}
+				return std::make_shared<TextFile>(String(assetId));
+			});
+		}
+
+		void TearDown() override
+		{
+			resources.reset();
+		}
+
+		void runDisk()
+		{
+			Executor(Executors::getDiskIO()).runPending();
+		}
+
+		void runCPU()
+		{
+			Executor(Executors::getCPU()).runPending();
+		}
+
+		void runAll()
+		{
+			runDisk();
+			runCPU();
+			resources->update();
+		}
+
+		HalleyStatics statics;
+		HalleyAPI api{};
+		std::unique_ptr<Resources> resources;
+		Vector<String> loaded;
+		HashSet<String> failing;
+	};
+}
+
+TEST_F(HalleyResourceStreamer, DispatchesByPriority)
+{
+	auto low = resources->getAsync<TextFile>("low", ResourceLoadPriority::Low);
+	auto normal = resources->getAsync<TextFile>("normal", ResourceLoadPriority::Normal);
+	auto high = resources->getAsync<TextFile>("high", ResourceLoadPriority::High);
+	auto normal2 = resources->getAsync<TextFile>("normal2", ResourceLoadPriority::Normal);
+	EXPECT_EQ(4u, resources->getStreamer().getPendingCount());
+	EXPECT_FALSE(high.isReady());
+
+	runAll();
+
+	// Highest first, then in the order they were asked for
+	const Vector<String> expected = { "high", "normal", "normal2", "low" };
+	EXPECT_EQ(expected, loaded);
+	EXPECT_EQ(0u, resources->getStreamer().getPendingCount());
+	for (auto* handle: { &low, &normal, &high, &normal2 }) {
+		ASSERT_TRUE(handle->isReady());
+		EXPECT_EQ(handle->getAssetId(), handle->get()->getData());
+	}
+
+	// Finished requests end up in the cache
+	EXPECT_EQ(high.get(), resources->get<TextFile>("high"));
+}
+
+TEST_F(HalleyResourceStreamer, AskingAgainRaisesPriority)
+{
+	auto a = resources->getAsync<TextFile>("a", ResourceLoadPriority::Low);
+	auto b = resources->getAsync<TextFile>("b", ResourceLoadPriority::Normal);
+	auto a2 = resources->getAsync<TextFile>("a", ResourceLoadPriority::High);
+	EXPECT_EQ(2u, resources->getStreamer().getPendingCount());
+
+	runAll();
+
+	const Vector<String> expected = { "a", "b" };
+	EXPECT_EQ(expected, loaded);
+	ASSERT_TRUE(a.isReady());
+	EXPECT_EQ(a.get(), a2.get());
+}
+
+TEST_F(HalleyResourceStreamer, DroppedRequestsAreCancelled)
+{
+	auto kept = resources->getAsync<TextFile>("kept");
+	{
+		auto dropped = resources->getAsync<TextFile>("dropped");
+	}
+
+	runAll();
+
+	const Vector<String> expected = { "kept" };
+	EXPECT_EQ(expected, loaded);
+	EXPECT_TRUE(kept.isReady());
+	EXPECT_EQ(0u, resources->getStreamer().getPendingCount());
+
+	// The collection forgot about it, so asking again starts over rather than handing back the dead request
+	auto again = resources->getAsync<TextFile>("dropped");
+	EXPECT_FALSE(again.isReady());
+	runAll();
+	EXPECT_TRUE(again.isReady());
+}
+
+TEST_F(HalleyResourceStreamer, FailedRequestsCanBeRetried)
+{
+	failing.insert("broken");
+	auto broken = resources->getAsync<TextFile>("broken");
+	auto fine = resources->getAsync<TextFile>("fine");
+
+	runAll();
+
+	EXPECT_TRUE(broken.hasFailed());
+	EXPECT_EQ(nullptr, broken.get());
+	EXPECT_TRUE(fine.isReady());
+	EXPECT_EQ(0u, resources->getStreamer().getPendingCount());
+
+	// Once it can be loaded, asking again makes a new request instead of returning the failed one
+	failing.clear();
+	auto retry = resources->getAsync<TextFile>("broken");
+	EXPECT_FALSE(retry.hasFailed());
+	runAll();
+	ASSERT_TRUE(retry.isReady());
+	EXPECT_EQ(String("broken"), retry.get()->getData());
+	EXPECT_TRUE(broken.hasFailed());
+}
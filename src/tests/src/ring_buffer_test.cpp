@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+#include "halley/data_structures/ring_buffer.h"
+using namespace Halley;
+
+TEST(HalleyRingBuffer, PeekAndSkip)
+{
+	RingBuffer<int> buffer(6);
+	int values[] = { 1, 2, 3, 4 };
+	buffer.write(gsl::span<const int>(values));
+	buffer.skip(3);
+	int more[] = { 5, 6, 7, 8 };
+	buffer.write(gsl::span<const int>(more));
+	EXPECT_EQ(5u, buffer.availableToRead());
+
+	// Wraps around the end of storage, without consuming anything
+	int peeked[4] = {};
+	buffer.peek(gsl::span<int>(peeked), 1);
+	EXPECT_EQ(5, peeked[0]);
+	EXPECT_EQ(8, peeked[3]);
+	EXPECT_EQ(5u, buffer.availableToRead());
+	EXPECT_EQ(4, buffer.readOne());
+
+	buffer.clear();
+	EXPECT_TRUE(buffer.empty());
+	EXPECT_EQ(6u, buffer.availableToWrite());
+}
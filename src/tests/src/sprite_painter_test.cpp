@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <halley.hpp>
+using namespace Halley;
+
+TEST(HalleySpritePainter, SortKeyMatchesEntryOrder)
+{
+	const std::array<int, 5> layers = { std::numeric_limits<int>::min(), -3, 0, 1, std::numeric_limits<int>::max() };
+	const std::array<float, 8> tieBreakers = { -std::numeric_limits<float>::infinity(), -1000.5f, -1.0f, -0.0f, 0.0f, 0.25f, 1000.5f, std::numeric_limits<float>::infinity() };
+
+	Vector<SpritePainterEntry> entries;
+	for (auto layer: layers) {
+		for (auto tieBreaker: tieBreakers) {
+			entries.push_back(SpritePainterEntry(SpritePainterEntryType::Callback, 0, 1, 1, layer, tieBreaker, entries.size(), {}));
+		}
+	}
+
+	for (const auto& a: entries) {
+		for (const auto& b: entries) {
+			if (a.getSortKey() != b.getSortKey()) {
+				EXPECT_EQ(a.getSortKey() < b.getSortKey(), a < b);
+			}
+		}
+	}
+}
+
+TEST(HalleySpritePainter, SkipsBandsOutsideView)
+{
+	// Two clusters far apart on the same layer, taking turns in draw order every ten sprites
+	Vector<Sprite> sprites(200);
+	for (size_t i = 0; i < sprites.size(); ++i) {
+		const float x = (i < 100 ? 0.0f : 10000.0f) + float(i % 10) * 10.0f;
+		const float y = float(i % 100 / 10) * 10.0f;
+		sprites[i].setSize(Vector2f(8, 8)).setPos(Vector2f(x, y));
+	}
+
+	SpritePainter painter;
+	painter.start();
+	for (const auto& sprite: sprites) {
+		painter.add(sprite, 1, 0, sprite.getPosition().y);
+	}
+
+	EXPECT_EQ(painter.getNumEntriesInView(1, Rect4f(-50, -50, 200, 200)), 100);
+	EXPECT_EQ(painter.getNumEntriesInView(1, Rect4f(9950, -50, 200, 200)), 100);
+	EXPECT_EQ(painter.getNumEntriesInView(1, Rect4f(-50, -50, 20000, 200)), 200);
+	EXPECT_EQ(painter.getNumEntriesInView(1, Rect4f(3000, -50, 200, 200)), 0);
+	EXPECT_EQ(painter.getNumEntriesInView(2, Rect4f(-50, -50, 200, 200)), 0);
+}
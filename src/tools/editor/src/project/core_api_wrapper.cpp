@@ -59,6 +59,11 @@ bool CoreAPIWrapper::isDevMode()
 	return parent.isDevMode();
 }
 
+bool CoreAPIWrapper::isHeadless() const
+{
+	return parent.isHeadless();
+}
+
 void CoreAPIWrapper::addProfilerCallback(IProfileCallback* callback)
 {
 	parent.addProfilerCallback(callback);
@@ -16,6 +16,7 @@ namespace Halley {
 		HalleyStatics& getStatics() override;
 		const Environment& getEnvironment() override;
 		bool isDevMode() override;
+		bool isHeadless() const override;
 		void addProfilerCallback(IProfileCallback* callback) override;
 		void removeProfilerCallback(IProfileCallback* callback) override;
 		Future<std::unique_ptr<RenderSnapshot>> requestRenderSnapshot() override;
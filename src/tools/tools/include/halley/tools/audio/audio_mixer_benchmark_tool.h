@@ -0,0 +1,10 @@
+#pragma once
+#include "halley/tools/cli_tool.h"
+
+namespace Halley {
+	class AudioMixerBenchmarkTool : public CommandLineTool
+	{
+	public:
+		int run(Vector<std::string> args) override;
+	};
+}
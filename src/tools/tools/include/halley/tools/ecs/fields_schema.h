@@ -98,6 +98,7 @@ namespace Halley
 		Vector<EntitySerialization::Type> serializationTypes;
 		bool hideInEditor = false;
 		bool collapse = false;
+		bool replicated = false;
 		std::optional<Range<float>> range;
 
 		ComponentFieldSchema(TypeSchema type, String name, Vector<String> defaultValue, std::optional<MemberAccess> access = {})
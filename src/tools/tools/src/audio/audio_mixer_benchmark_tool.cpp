@@ -0,0 +1,17 @@
+#include "halley/tools/audio/audio_mixer_benchmark_tool.h"
+#include "halley/audio/audio_mixer_benchmark.h"
+#include "halley/support/logger.h"
+#include "halley/text/string_converter.h"
+
+using namespace Halley;
+
+int AudioMixerBenchmarkTool::run(Vector<std::string> args)
+{
+	const size_t samples = args.size() >= 1 ? static_cast<size_t>(std::max(16, String(args[0]).toInteger())) : 1024;
+	const int iterations = args.size() >= 2 ? std::max(1, String(args[1]).toInteger()) : 10000;
+	Logger::logInfo("Benchmarking audio mixer kernels on " + toString(samples) + " sample buffers, " + toString(iterations) + " iteration(s)...");
+
+	const auto result = AudioMixerBenchmark::run(samples, iterations);
+	Logger::logInfo(result.toString());
+	return 0;
+}
@@ -347,10 +347,28 @@ Vector<String> CodegenCPP::generateComponentHeader(ComponentSchema component)
 	}
 	serializeBody += lineBreak + "return node;";
 
+	// Replicated fields are written to and read from the network as raw binary, indexed by their declaration order
+	String serializeReplicatedBody = "switch (field) {";
+	String deserializeReplicatedBody = "switch (field) {";
+	size_t replicatedFieldCount = 0;
+	for (auto& member: component.members) {
+		if (member.replicated) {
+			const auto caseLabel = lineBreak + "case " + toString(replicatedFieldCount++) + ": ";
+			serializeReplicatedBody += caseLabel + "s << " + member.name + "; break;";
+			deserializeReplicatedBody += caseLabel + "s >> " + member.name + "; break;";
+		}
+	}
+	serializeReplicatedBody += lineBreak + "}";
+	deserializeReplicatedBody += lineBreak + "}";
+
 	gen
 		.setAccessLevel(MemberAccess::Public)
 		.addMember(MemberSchema(TypeSchema("int", false, true, true), "componentIndex", toString(component.id)))
-		.addMember(MemberSchema(TypeSchema("char*", true, true, true), "componentName", component.name))
+		.addMember(MemberSchema(TypeSchema("char*", true, true, true), "componentName", component.name));
+	if (replicatedFieldCount > 0) {
+		gen.addMember(MemberSchema(TypeSchema("size_t", false, true, true), "replicatedFieldCount", toString(replicatedFieldCount)));
+	}
+	gen
 		.addBlankLine()
 		.addMembers(component.members)
 		.addBlankLine()
@@ -377,6 +395,17 @@ Vector<String> CodegenCPP::generateComponentHeader(ComponentSchema component)
 		}, "deserialize"), deserializeBody)
 		.addBlankLine();
 
+	if (replicatedFieldCount > 0) {
+		gen.addMethodDefinition(MethodSchema(TypeSchema("void"), {
+				VariableSchema(TypeSchema("Halley::Serializer&"), "s"), VariableSchema(TypeSchema("size_t"), "field")
+			}, "serializeReplicatedField", true), serializeReplicatedBody)
+			.addBlankLine()
+			.addMethodDefinition(MethodSchema(TypeSchema("void"), {
+				VariableSchema(TypeSchema("Halley::Deserializer&"), "s"), VariableSchema(TypeSchema("size_t"), "field")
+			}, "deserializeReplicatedField"), deserializeReplicatedBody)
+			.addBlankLine();
+	}
+
 	gen.finish()
 		.writeTo(contents);
 
@@ -500,7 +529,8 @@ Vector<String> CodegenCPP::generateSystemHeader(SystemSchema& system, const Hash
 				.addBlankLine()
 				.addTypeDefinition("Type", "Halley::FamilyType<" + String::concatList(convert<ComponentReferenceSchema, String>(fam.components, [](auto& comp)
 				{
-					return comp.optional ? "Halley::MaybeRef<" + comp.name + "Component>" : comp.name + "Component";
+					const String type = (comp.write ? "" : "const ") + comp.name + "Component";
+					return comp.optional ? "Halley::MaybeRef<" + type + ">" : type;
 				}), ", ") + ">")
 				.addBlankLine()
 				.setAccessLevel(MemberAccess::Protected)
@@ -734,10 +764,19 @@ Vector<String> CodegenCPP::generateSystemHeader(SystemSchema& system, const Hash
 			}, "canHandleSystemMessage", true, false, true, true), canReceiveBody);
 	}
 
+	// Systems that only touch their own families can be scheduled alongside other systems.
+	// Parallel systems are excluded, as they already occupy the CPU executors while updating.
+	const bool concurrent = system.method == SystemMethod::Update
+		&& system.strategy != SystemStrategy::Parallel
+		&& system.access == SystemAccess::Pure
+		&& system.messages.empty()
+		&& system.systemMessages.empty()
+		&& system.services.empty();
+
 	sysClassGen
 		.setAccessLevel(MemberAccess::Public)
 		.addCustomConstructor({}, {
-			VariableSchema(TypeSchema(""), "System", "{" + String::concatList(convert<FamilySchema, String>(system.families, [](auto& fam) { return "&" + fam.name + "Family"; }), ", ") + "}, {" + String::concatList(entityMsgsReceived, ", ") + "}")
+			VariableSchema(TypeSchema(""), "System", "{" + String::concatList(convert<FamilySchema, String>(system.families, [](auto& fam) { return "&" + fam.name + "Family"; }), ", ") + "}, {" + String::concatList(entityMsgsReceived, ", ") + "}, " + (concurrent ? "true" : "false"))
 		}, { "static_assert(std::is_final_v<T>, \"System must be final.\");" })
 		.finish()
 		.writeTo(contents);
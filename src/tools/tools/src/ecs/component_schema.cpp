@@ -34,6 +34,7 @@ ComponentSchema::ComponentSchema(YAML::Node node, bool generate)
 				const String displayName = memberProperties["displayName"].as<std::string>("");
 				const bool hideInEditor = memberProperties["hideInEditor"].as<bool>(false);
 				const bool collapse = memberProperties["collapse"].as<bool>(false);
+				const bool replicated = memberProperties["replicated"].as<bool>(false);
 
 				const String typeRaw = memberProperties["type"].as<std::string>();
 				const auto parseableRange = std::string_view(typeRaw).substr(0, typeRaw.find('<'));
@@ -49,7 +50,7 @@ ComponentSchema::ComponentSchema(YAML::Node node, bool generate)
 				if (canSave) {
 					serializeTypes.insert(EntitySerialization::Type::SaveData);
 				}
-				if (memberProperties["canNetwork"].as<bool>(canSave)) {
+				if (memberProperties["canNetwork"].as<bool>(canSave) && !replicated) {
 					serializeTypes.insert(EntitySerialization::Type::Network);
 				}
 
@@ -86,10 +87,16 @@ ComponentSchema::ComponentSchema(YAML::Node node, bool generate)
 				field.hideInEditor = hideInEditor;
 				field.displayName = displayName;
 				field.range = range;
+				field.replicated = replicated;
 			}
 		}
 	}
 
+	// Replicated fields bypass ConfigNode serialization and are sent as a bitmask delta, see EntityNetworkRemotePeer
+	if (std::count_if(members.begin(), members.end(), [] (const ComponentFieldSchema& m) { return m.replicated; }) > 64) {
+		throw Exception("Component " + name + " has more than 64 replicated fields.", HalleyExceptions::Entity);
+	}
+
 	if (node["customImplementation"].IsDefined()) {
 		customImplementation = node["customImplementation"].as<std::string>();
 	}
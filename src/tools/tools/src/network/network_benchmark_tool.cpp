@@ -0,0 +1,30 @@
+#include "halley/tools/network/network_benchmark_tool.h"
+#include "halley/net/entity/entity_network_recorder.h"
+#include "halley/support/logger.h"
+#include "halley/text/string_converter.h"
+
+using namespace Halley;
+
+int NetworkBenchmarkTool::run(Vector<std::string> args)
+{
+	if (args.empty()) {
+		Logger::logError("Usage: halley-cmd net-bench path/to/recording.dat [iterations]");
+		return 1;
+	}
+
+	try {
+		const int iterations = args.size() >= 2 ? std::max(1, String(args[1]).toInteger()) : 1;
+		const auto recording = EntityNetworkRecording::load(Path(args[0]));
+		Logger::logInfo("Replaying " + toString(recording.entries.size()) + " recorded batches (" + toString(recording.getDuration(), 2) + "s), " + toString(iterations) + " iteration(s)...");
+
+		const auto result = EntityNetworkReplayBenchmark::run(recording, iterations);
+		Logger::logInfo(result.toString());
+		return 0;
+	} catch (std::exception& e) {
+		Logger::logException(e);
+		return 1;
+	} catch (...) {
+		Logger::logError("Unknown exception running network benchmark.");
+		return 1;
+	}
+}
@@ -219,7 +219,14 @@ void AssetPacker::generatePack(const String& packId, const AssetPackListing& pac
 		pack.encrypt(packListing.getEncryptionKey());
 	}
 
-	// Write pack
-	FileSystem::writeFile(dst, pack.writeOut());
+	// Write pack. A running game might have the old one mapped, so it's replaced rather than overwritten
+	const auto packData = pack.writeOut();
+	const auto tmp = dst.replaceExtension(dst.getExtension() + ".tmp");
+	FileSystem::writeFile(tmp, packData);
+	if (!FileSystem::rename(tmp, dst)) {
+		Logger::logWarning("Unable to replace \"" + dst.getString() + "\", overwriting it instead");
+		FileSystem::remove(tmp);
+		FileSystem::writeFile(dst, packData);
+	}
 	Logger::logInfo("- Packed " + toString(packListing.getEntries().size()) + " entries on \"" + packId + "\" (" + String::prettySize(data.size()) + ").");
 }
@@ -9,6 +9,8 @@
 #include "halley/core/game/halley_statics.h"
 #include "halley/tools/vs_project/vs_project_tool.h"
 #include "halley/tools/packer/asset_pack_inspector.h"
+#include "halley/tools/network/network_benchmark_tool.h"
+#include "halley/tools/audio/audio_mixer_benchmark_tool.h"
 #include "halley/tools/runner/runner_tool.h"
 
 using namespace Halley;
@@ -23,6 +25,8 @@ CommandLineTools::CommandLineTools()
 	factories["pack-inspector"] = []() { return std::make_unique<AssetPackInspectorTool>(); };
 	factories["vs_project"] = []() { return std::make_unique<VSProjectTool>(); };
 	factories["run"] = []() { return std::make_unique<RunnerTool>(); };
+	factories["net-bench"] = []() { return std::make_unique<NetworkBenchmarkTool>(); };
+	factories["audio-bench"] = []() { return std::make_unique<AudioMixerBenchmarkTool>(); };
 }
 
 Vector<std::string> CommandLineTools::getToolNames()